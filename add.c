@@ -10,7 +10,7 @@
  *   before going to the CHECKOUT counter
  * 
  * DATA STRUCTURES USED:
- *   1. Array (char buffer) → To hold file content
+ *   1. Mapped file         → The file content, any size
  *   2. Hash function       → To create unique ID for content
  *   3. Linked List concept → Staging area (saved to file)
  * 
@@ -40,14 +40,15 @@
  *   → We can find any version by its hash instantly!
  * 
  * PARAMETERS:
- *   content → The text to save
- *   hash    → The hash of the text (used as filename)
+ *   data, size → The bytes to save (text or binary — a '\0'
+ *                inside doesn't end it)
+ *   hash       → Their hash (used as filename)
  * 
  * RETURNS:
  *   0  → Success
  *   -1 → Error
  */
-int save_blob(const char* content, unsigned long hash) {
+int save_blob(const char* data, size_t size, unsigned long hash) {
 
     /* 
      * Step 1: Build the file path
@@ -76,9 +77,13 @@ int save_blob(const char* content, unsigned long hash) {
     }
 
     /* 
-     * Step 3: Write the content to the blob file
+     * Step 3: Write the bytes to the blob file
+     *
+     * Into a tmp file first, renamed when complete: a blob that
+     * exists is never written again (Step 2), so a half-written
+     * one must never get the real name.
      */
-    if (write_file(blob_path, content) != 0) {
+    if (write_file_atomic(blob_path, data, size) != 0) {
         printf(RED "  ✗ Failed to save object\n" RESET);
         return -1;
     }
@@ -106,92 +111,38 @@ int save_blob(const char* content, unsigned long hash) {
  */
 int is_already_staged(const char* filename) {
 
-    /* Try to open the staging file */
-    FILE* fp = fopen(STAGING_FILE, "r");
-
-    /* 
-     * If file doesn't exist, nothing is staged 
-     * ! means NOT
-     * !fp means "fp is NULL" means "couldn't open"
+    /*
+     * Map the staging file into memory.
+     * If it doesn't exist, nothing is staged.
      */
-    if (!fp) {
+    MappedFile mf;
+    if (map_file(STAGING_FILE, &mf) != 0) {
         return 0;
     }
 
-    char line[MAX_LINE];
-
     /*
-     * fgets reads ONE line at a time
-     * Returns NULL when there are no more lines
+     * staging_next hands us one entry at a time, already split:
      * 
      * Staging file looks like:
-     *   # MyGit Staging Area
-     *   hello.txt|5864370
+     *   # MyGit Staging Area     ← skipped (comment)
+     *   hello.txt|5864370        ← path "hello.txt", hash 5864370
      *   main.c|9283471
+     * 
+     * The path is a VIEW into the mapped file — nothing is
+     * copied, and no line is too long to read.
      */
-    while (fgets(line, sizeof(line), fp)) {
-
-        /* 
-         * Skip comment lines (lines starting with #)
-         * 
-         * line[0] is the FIRST character of the line
-         * If it's '#', this is a comment → skip it
-         */
-        if (line[0] == '#') {
-            continue;   /* "continue" = skip to next loop iteration */
-        }
-
-        /*
-         * Remove the newline character at the end
-         * 
-         * fgets includes '\n' at the end of each line
-         * "hello.txt|5864370\n"  ← we don't want this \n
-         * "hello.txt|5864370"    ← we want this
-         * 
-         * strcspn finds the POSITION of the first \n or \r
-         * Then we put '\0' there to cut the string short
-         */
-        line[strcspn(line, "\n\r")] = '\0';
-
-        /*
-         * Skip empty lines
-         * strlen returns the length of a string
-         * If length is 0, the line is empty → skip
-         */
-        if (strlen(line) == 0) {
-            continue;
-        }
-
-        /*
-         * Extract the filename from the line
-         * 
-         * Line format: "hello.txt|5864370"
-         * We want just: "hello.txt"
-         * 
-         * strtok SPLITS a string at the given character
-         * 
-         * strtok("hello.txt|5864370", "|")
-         *   First call → returns "hello.txt"
-         * 
-         * Like splitting "hello.txt|5864370" at the '|' sign
-         */
-        char temp_line[MAX_LINE];
-        strcpy(temp_line, line);   /* Make a copy (strtok modifies the original!) */
-        
-        char* stored_filename = strtok(temp_line, "|");
-
-        /* 
-         * Compare the stored filename with the one we're looking for
-         * strcmp returns 0 if they're EQUAL
-         */
-        if (stored_filename && strcmp(stored_filename, filename) == 0) {
-            fclose(fp);
-            return 1;   /* YES, this file is already staged! */
-        }
+    LineCursor cursor;
+    TextView path;
+    unsigned long hash;
+    int found = 0;
+
+    lines_init(&cursor, mf.data, mf.size);
+    while (!found && staging_next(&cursor, &path, &hash)) {
+        found = view_equals(path, filename);
     }
 
-    fclose(fp);
-    return 0;   /* NO, this file is not staged */
+    unmap_file(&mf);
+    return found;   /* 1 = YES, already staged */
 }
 
 /*
@@ -217,69 +168,59 @@ int is_already_staged(const char* filename) {
  */
 void remove_from_staging(const char* filename) {
 
-    FILE* fp = fopen(STAGING_FILE, "r");
-    if (!fp) return;   /* Nothing to remove if file doesn't exist */
+    MappedFile mf;
+    if (map_file(STAGING_FILE, &mf) != 0) return;   /* Nothing to remove if file doesn't exist */
 
     /* 
-     * We'll store all lines EXCEPT the one to remove
+     * We'll copy all lines EXCEPT the one to remove
      * 
      * Think of it as two piles:
      *   Pile 1: Read from (old staging file)
-     *   Pile 2: Write to (new staging file)
+     *   Pile 2: Write to (a new staging file, see atomic_open)
      *   Skip the card we don't want!
+     * 
+     * Streaming into a second file means there is no limit on
+     * how many lines the staging area can hold.
      */
-    char lines[100][MAX_LINE];   /* Can hold up to 100 lines */
-    int count = 0;               /* How many lines we've saved */
+    AtomicFile af;
+    if (atomic_open(&af, STAGING_FILE) != 0) {
+        unmap_file(&mf);
+        return;
+    }
 
-    char line[MAX_LINE];
+    LineCursor cursor;
+    TextView line;
+    lines_init(&cursor, mf.data, mf.size);
 
-    while (fgets(line, sizeof(line), fp)) {
+    while (lines_next(&cursor, &line)) {
 
         /* 
-         * For each line, check if it starts with our filename
-         * 
-         * strstr(haystack, needle)
-         *   Searches for "needle" inside "haystack"
-         *   Returns pointer to where it found it
-         *   Returns NULL if not found
+         * For each line, look at the part before the LAST '|'
          * 
-         * Example:
-         *   strstr("hello.txt|5864370", "hello.txt") → FOUND
-         *   strstr("main.c|9283471", "hello.txt")    → NOT FOUND (NULL)
+         *   "hello.txt|5864370"  → "hello.txt"  → our file? SKIP
+         *   "main.c|9283471"     → "main.c"     → keep
+         *   "# MyGit Staging Area"              → keep (comment)
          */
-        char temp[MAX_LINE];
-        strcpy(temp, line);
-        temp[strcspn(temp, "\n\r")] = '\0';
-
-        char* stored_name = strtok(temp, "|");
+        TextView name, hash_text;
+        int ours = line.len > 0 && line.data[0] != '#'
+                   && view_split_last(line, '|', &name, &hash_text)
+                   && view_equals(name, filename);
 
-        /* 
-         * If this line is NOT about our file → KEEP it
-         * If this line IS about our file → SKIP it (don't copy)
-         */
-        if (!stored_name || strcmp(stored_name, filename) != 0) {
+        if (!ours) {
             /* This line is about a DIFFERENT file → keep it */
-            strcpy(lines[count], line);
-            count++;
+            fwrite(line.data, 1, line.len, af.fp);
+            fputc('\n', af.fp);
         }
         /* If it matches our filename → we simply don't copy it */
         /* That's how we "remove" it! */
     }
 
-    fclose(fp);
+    unmap_file(&mf);
 
     /* 
-     * Now write back all the lines we KEPT
-     * This overwrites the old file with the filtered version
+     * Now swap the filtered pile in place of the old file
      */
-    fp = fopen(STAGING_FILE, "w");   /* "w" = overwrite! */
-    if (!fp) return;
-
-    for (int i = 0; i < count; i++) {
-        fprintf(fp, "%s", lines[i]);
-    }
-
-    fclose(fp);
+    atomic_commit(&af);
 }
 
 /*
@@ -318,22 +259,11 @@ int mygit_add(const char* filename) {
      * STEP 2: Read the file content
      * ──────────────────────────
      * 
-     * We create a BIG empty box (buffer) and fill it 
-     * with the file's content.
-     * 
-     * Think of it like:
-     *   Empty notebook (buffer) → Copy the document into it
+     * The whole file is mapped into memory — no size limit, and
+     * binary files (with '\0' bytes in them) come in complete.
      */
-    char content[MAX_CONTENT];
-
-    /*
-     * read_file returns:
-     *   Positive number = how many bytes it read (success!)
-     *   -1 = something went wrong (error!)
-     */
-    int bytes = read_file(filename, content, MAX_CONTENT);
-
-    if (bytes < 0) {
+    MappedFile content;
+    if (map_file(filename, &content) != 0) {
         printf(RED "✗ Could not read file: '%s'\n" RESET, filename);
         return -1;
     }
@@ -350,7 +280,7 @@ int mygit_add(const char* filename) {
      * If the file changes even by ONE character,
      * the hash will be COMPLETELY different!
      */
-    unsigned long hash = hash_content(content);
+    unsigned long hash = hash_bytes(content.data, content.size);
 
     /* 
      * ──────────────────────────
@@ -360,7 +290,9 @@ int mygit_add(const char* filename) {
      * Store the content in .mygit/objects/193485797.blob
      * This is our "photocopy" — safe backup!
      */
-    if (save_blob(content, hash) != 0) {
+    int saved = save_blob(content.data, content.size, hash);
+    unmap_file(&content);
+    if (saved != 0) {
         printf(RED "✗ Failed to save file object\n" RESET);
         return -1;
     }
@@ -374,7 +306,29 @@ int mygit_add(const char* filename) {
      * 
      * But first, check if this file was already staged.
      * If yes, remove the old entry first (it might have old hash)
+     * 
+     * staging.dat is read, rewritten and appended to below —
+     * LOCK it, so another add (or a commit emptying it) can't
+     * interleave and lose an entry.
+     *
+     * Staging on top of an old commit (see checkout.c) would only
+     * lead to a commit that can't be made. Checked under the
+     * lock, so a checkout running right now is already done.
      */
+    if (lockfile_acquire(STAGING_FILE) != 0) {
+        return -1;
+    }
+
+    int detached = get_detached_commit();
+    if (detached > 0) {
+        char branch[MAX_BRANCH_NAME];
+        lockfile_release(STAGING_FILE);
+        printf(RED "✗ You checked out commit #%d, not a branch\n" RESET, detached);
+        printf("  Go back first with: mygit checkout %s\n",
+               get_current_branch(branch, sizeof(branch)));
+        return -1;
+    }
+
     if (is_already_staged(filename)) {
         remove_from_staging(filename);
     }
@@ -391,6 +345,7 @@ int mygit_add(const char* filename) {
     FILE* fp = fopen(STAGING_FILE, "a");
 
     if (!fp) {
+        lockfile_release(STAGING_FILE);
         printf(RED "✗ Could not open staging area\n" RESET);
         return -1;
     }
@@ -404,6 +359,7 @@ int mygit_add(const char* filename) {
      */
     fprintf(fp, "%s|%lu\n", filename, hash);
     fclose(fp);
+    lockfile_release(STAGING_FILE);
 
     /* 
      * ──────────────────────────
@@ -0,0 +1,237 @@
+/*
+ * ============================================
+ *          MYGIT - Text Search Benchmark
+ *          find_text vs memmem vs strstr
+ * ============================================
+ *
+ * PURPOSE:
+ *   search.c's find_text (AVX2 / SSE2 / plain C, see there) is
+ *   what "mygit grep" and "log --grep" without an index run on.
+ *   This program times it on its own against the C library:
+ *
+ *     memmem      → the usual byte-range search (glibc: two-way)
+ *     strstr      → needs a '\0' at the end, otherwise the same job
+ *     strcasestr  → for the case-insensitive rows
+ *
+ * THE TEXT:
+ *   Made-up commit messages — lowercase words, ticket ids, some
+ *   punctuation — generated from a fixed seed, so every run (and
+ *   every machine) searches the same bytes.
+ *
+ * EACH ROW:
+ *   Counts EVERY occurrence of one needle in the whole buffer,
+ *   and prints MB/s for each method. All methods must find the
+ *   same number of matches, or the row says MISMATCH.
+ *
+ * BUILD + RUN (from the repository root):
+ *   gcc -O2 -o search_bench bench/search_bench.c $(ls *.c | grep -v '^main.c$')
+ *   ./search_bench          64 MB of text
+ *   ./search_bench 512      more
+ */
+
+#define _GNU_SOURCE                  // memmem(), strcasestr()
+#include "../mygit.h"
+
+#ifdef _WIN32
+static double now_seconds(void) {
+    LARGE_INTEGER freq, t;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&t);
+    return (double)t.QuadPart / (double)freq.QuadPart;
+}
+#else
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+#endif
+
+
+/* ─────────── THE TEXT ─────────── */
+
+static uint64_t g_rng = 0x9E3779B97F4A7C15ULL;
+
+static uint32_t next_random(void) {
+    g_rng ^= g_rng << 13;             // xorshift64
+    g_rng ^= g_rng >> 7;
+    g_rng ^= g_rng << 17;
+    return (uint32_t)(g_rng >> 32);
+}
+
+static const char* g_words[] = {
+    "fix", "add", "remove", "parser", "cache", "tree", "commit", "branch",
+    "refactor", "the", "for", "in", "test", "build", "index", "update",
+    "merge", "log", "status", "diff", "memory", "leak", "crash", "when",
+    "empty", "file", "path", "speed", "up", "handle", "error", "config",
+};
+
+/* `size` bytes of "MSG:fix the parser for TICKET-4711\n"-like lines, '\0'-ended */
+static char* make_text(size_t size) {
+    char* text = malloc(size + 1);
+    if (!text) return NULL;
+
+    size_t len = 0;
+    while (len < size) {
+        char line[256];
+        int used = snprintf(line, sizeof(line), "MSG:");
+        int words = 3 + next_random() % 9;
+        for (int w = 0; w < words; w++) {
+            if (next_random() % 16 == 0) {
+                used += snprintf(line + used, sizeof(line) - used, "%sTICKET-%u",
+                                 w ? " " : "", next_random() % 100000);
+            } else {
+                used += snprintf(line + used, sizeof(line) - used, "%s%s", w ? " " : "",
+                                 g_words[next_random() % (sizeof(g_words) / sizeof(g_words[0]))]);
+            }
+        }
+        line[used++] = '\n';
+
+        size_t take = (size_t)used < size - len ? (size_t)used : size - len;
+        memcpy(text + len, line, take);
+        len += take;
+    }
+    text[size] = '\0';
+    return text;
+}
+
+
+/* ─────────── COUNTING MATCHES ─────────── */
+
+typedef const char* (*SearchFn)(const char* hay, size_t len, const char* needle, size_t n);
+
+static const char* by_find_text(const char* hay, size_t len, const char* needle, size_t n) {
+    return find_text(hay, len, needle, n, 0);
+}
+
+static const char* by_find_text_icase(const char* hay, size_t len, const char* needle, size_t n) {
+    return find_text(hay, len, needle, n, 1);
+}
+
+#ifndef _WIN32
+static const char* by_memmem(const char* hay, size_t len, const char* needle, size_t n) {
+    return memmem(hay, len, needle, n);
+}
+
+/* The text ends in '\0', and every search runs to its end */
+static const char* by_strcasestr(const char* hay, size_t len, const char* needle, size_t n) {
+    (void)len; (void)n;
+    return strcasestr(hay, needle);
+}
+#endif
+
+static const char* by_strstr(const char* hay, size_t len, const char* needle, size_t n) {
+    (void)len; (void)n;
+    return strstr(hay, needle);
+}
+
+/* Every occurrence, left to right (the way mygit grep walks a file) */
+static long count_all(SearchFn fn, const char* text, size_t size, const char* needle, double* seconds) {
+    size_t n = strlen(needle);
+    long hits = 0;
+
+    double start = now_seconds();
+    const char* p = text;
+    const char* end = text + size;
+    const char* hit;
+    while (p < end && (hit = fn(p, (size_t)(end - p), needle, n)) != NULL) {
+        hits++;
+        p = hit + 1;
+    }
+    *seconds = now_seconds() - start;
+    return hits;
+}
+
+
+/* ─────────── ONE ROW ─────────── */
+
+typedef struct Method {
+    const char* name;
+    SearchFn fn;
+} Method;
+
+static void run_row(const char* label, const char* needle, const Method* methods, int count,
+                    const char* text, size_t size) {
+    printf("  %-26s", label);
+
+    long expected = -1;
+    int mismatch = 0;
+    for (int m = 0; m < count; m++) {
+        double best = 0;
+        long hits = 0;
+        for (int rep = 0; rep < 3; rep++) {           // best of three
+            double seconds;
+            hits = count_all(methods[m].fn, text, size, needle, &seconds);
+            if (rep == 0 || seconds < best) best = seconds;
+        }
+        if (expected < 0) expected = hits;
+        if (hits != expected) mismatch = 1;
+
+        printf(" %10.0f", best > 0 ? size / best / (1024.0 * 1024.0) : 0.0);
+    }
+    printf("  %8ld%s\n", expected, mismatch ? RED "  MISMATCH" RESET : "");
+}
+
+static void print_header(const Method* methods, int count) {
+    printf("  %-26s", "needle");
+    for (int m = 0; m < count; m++) {
+        printf(" %10s", methods[m].name);
+    }
+    printf("  %8s\n", "matches");
+}
+
+
+int main(int argc, char* argv[]) {
+    size_t mb = argc > 1 ? (size_t)atol(argv[1]) : 64;
+    if (mb == 0) mb = 64;
+    size_t size = mb * 1024 * 1024;
+
+    char* text = make_text(size);
+    if (!text) {
+        printf(RED "✗ Out of memory\n" RESET);
+        return 1;
+    }
+
+    static const char* needles[][2] = {
+        { "3 bytes, common",      "fix"              },
+        { "6 bytes, common",      "parser"           },
+        { "11 bytes, rare",       "TICKET-4711"      },
+        { "16 bytes, absent",     "nothing-matches!" },
+        { "32 bytes, absent",     "this sentence is never generated" },
+    };
+    int needle_count = (int)(sizeof(needles) / sizeof(needles[0]));
+
+    Method exact[] = {
+        { "find_text", by_find_text },
+#ifndef _WIN32
+        { "memmem",    by_memmem    },
+#endif
+        { "strstr",    by_strstr    },
+    };
+    int exact_count = (int)(sizeof(exact) / sizeof(exact[0]));
+
+    printf(CYAN "Searching %zu MB of commit-message text (MB/s, best of 3)\n\n" RESET, mb);
+    print_header(exact, exact_count);
+    for (int i = 0; i < needle_count; i++) {
+        run_row(needles[i][0], needles[i][1], exact, exact_count, text, size);
+    }
+
+#ifndef _WIN32
+    Method folded[] = {
+        { "find_text", by_find_text_icase },
+        { "strcasestr", by_strcasestr     },
+    };
+    int folded_count = (int)(sizeof(folded) / sizeof(folded[0]));
+
+    printf(CYAN "\nIgnoring case\n\n" RESET);
+    print_header(folded, folded_count);
+    for (int i = 0; i < needle_count; i++) {
+        run_row(needles[i][0], needles[i][1], folded, folded_count, text, size);
+    }
+#else
+    (void)by_find_text_icase;
+#endif
+
+    free(text);
+    return 0;
+}
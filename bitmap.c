@@ -0,0 +1,661 @@
+/*
+ * ============================================
+ *          MYGIT - Reachability Bitmaps
+ *          "mygit count-objects [branch]"
+ * ============================================
+ *
+ * QUESTION WE WANT TO ANSWER FAST:
+ *   "Which objects (commits, trees, blobs) can be reached
+ *    from branch X?"  — for size reports, clean-ups, exports.
+ *
+ * THE SLOW WAY:
+ *   Walk every commit back to the root and every tree inside
+ *   each one. That is a huge graph walk every single time.
+ *
+ * THE BITMAP WAY:
+ *   1. Give every object a fixed POSITION (0, 1, 2, ...) in an
+ *      object table — oldest objects first, so the positions
+ *      follow history like objects in a pack would.
+ *   2. For some commits, store a BITMAP: bit i is 1 if object i
+ *      is reachable from that commit.
+ *   3. Reachable-from-X = OR of the bitmaps of the nearest
+ *      bitmapped commits, plus a short walk of whatever is newer.
+ *
+ * WHY EWAH COMPRESSION?
+ *   Bitmaps are mostly long runs of 1s (old history everyone
+ *   shares) and 0s (objects from other branches). EWAH stores
+ *   a run as ONE marker word, and only "mixed" words literally:
+ *
+ *     marker: bit 0      = the run's bit value (0 or 1)
+ *             bits 1-32  = how many 64-bit words the run covers
+ *             bits 33-63 = how many literal words follow
+ *
+ * FILE (.mygit/objects/objects.bitmap — stored next to the objects):
+ *   header  | object table (hash, size, type) | bitmaps
+ */
+
+#include "mygit.h"
+
+#define BITMAP_MAGIC    "MGBM"
+#define BITMAP_VERSION  1
+#define BITMAP_EVERY    64           // also bitmap every 64th commit
+
+#define OBJ_COMMIT 0
+#define OBJ_TREE   1
+#define OBJ_BLOB   2
+
+typedef struct BitmapHeader {
+    char     magic[4];
+    uint32_t version;
+    uint32_t object_count;
+    uint32_t bitmap_count;
+} BitmapHeader;
+
+typedef struct ObjectInfo {
+    uint64_t hash;                   // blob hash / tree id / commit id
+    uint32_t size;                   // bytes on disk (0 for commits)
+    uint32_t type;                   // OBJ_COMMIT / OBJ_TREE / OBJ_BLOB
+} ObjectInfo;
+
+typedef struct BitmapRecord {
+    int32_t  commit_id;
+    uint32_t word_count;             // EWAH words that follow
+} BitmapRecord;
+
+/* One stored bitmap, pointing into the mapped file */
+typedef struct StoredBitmap {
+    int commit_id;
+    const uint64_t* words;
+    uint32_t word_count;
+} StoredBitmap;
+
+
+/*
+ * ─────────── EWAH ENCODE / DECODE ───────────
+ */
+
+#define EWAH_MAX_RUN     0xFFFFFFFFull
+#define EWAH_MAX_LITERAL 0x7FFFFFFFull
+
+typedef struct WordArray {
+    uint64_t* words;
+    size_t count;
+    size_t capacity;
+} WordArray;
+
+static int words_push(WordArray* a, uint64_t w) {
+    if (a->count == a->capacity) {
+        size_t new_capacity = a->capacity ? a->capacity * 2 : 64;
+        uint64_t* grown = realloc(a->words, new_capacity * sizeof(uint64_t));
+        if (!grown) return -1;
+        a->words = grown;
+        a->capacity = new_capacity;
+    }
+    a->words[a->count++] = w;
+    return 0;
+}
+
+
+/*
+ * FUNCTION: ewah_encode
+ * ─────────────────────
+ * Compresses a plain bitset (n 64-bit words) into EWAH words.
+ */
+static int ewah_encode(const uint64_t* bits, size_t n, WordArray* out) {
+    size_t i = 0;
+    out->count = 0;
+
+    while (i < n) {
+        /* 1. A run of all-0 or all-1 words */
+        uint64_t run_bit = 0;
+        uint64_t run_len = 0;
+
+        if (bits[i] == 0 || bits[i] == ~0ull) {
+            uint64_t clean = bits[i];
+            run_bit = clean ? 1 : 0;
+            while (i < n && bits[i] == clean && run_len < EWAH_MAX_RUN) {
+                run_len++;
+                i++;
+            }
+        }
+
+        /* 2. The literal ("mixed") words right after it */
+        size_t literal_start = i;
+        while (i < n && bits[i] != 0 && bits[i] != ~0ull
+               && i - literal_start < EWAH_MAX_LITERAL) {
+            i++;
+        }
+        uint64_t literal_count = i - literal_start;
+
+        uint64_t marker = run_bit | (run_len << 1) | (literal_count << 33);
+        if (words_push(out, marker) != 0) return -1;
+
+        for (size_t k = literal_start; k < i; k++) {
+            if (words_push(out, bits[k]) != 0) return -1;
+        }
+    }
+
+    return 0;
+}
+
+
+/*
+ * FUNCTION: ewah_or_into
+ * ──────────────────────
+ * The whole point of bitmaps: OR a compressed bitmap into a
+ * plain bitset, one 64-bit word at a time.
+ */
+static void ewah_or_into(const uint64_t* ewah, size_t ewah_len, uint64_t* bits, size_t n) {
+    size_t pos = 0;
+    size_t i = 0;
+
+    while (i < ewah_len && pos < n) {
+        uint64_t marker = ewah[i++];
+        uint64_t run_len = (marker >> 1) & EWAH_MAX_RUN;
+        uint64_t literal_count = marker >> 33;
+
+        if (marker & 1) {
+            for (uint64_t k = 0; k < run_len && pos < n; k++) {
+                bits[pos++] = ~0ull;
+            }
+        } else {
+            pos += run_len;
+        }
+
+        for (uint64_t k = 0; k < literal_count && i < ewah_len; k++) {
+            if (pos < n) bits[pos] |= ewah[i];
+            pos++;
+            i++;
+        }
+    }
+}
+
+
+/*
+ * ─────────── OBJECT TABLE (position ↔ object) ───────────
+ *
+ * A hash map from (type, hash) → position, plus the array
+ * of objects in position order. New objects get the next
+ * free position.
+ */
+
+typedef struct ObjectTable {
+    ObjectInfo* objects;             // by position
+    uint32_t count;
+    uint32_t capacity;
+    int32_t* slots;                  // open addressing, -1 = empty
+    uint32_t slot_mask;
+} ObjectTable;
+
+static uint32_t object_slot(uint64_t hash, uint32_t type, uint32_t mask) {
+    uint64_t h = (hash ^ ((uint64_t)type << 61)) * 0x9E3779B97F4A7C15ull;
+    return (uint32_t)(h >> 32) & mask;
+}
+
+static int table_grow_slots(ObjectTable* t) {
+    uint32_t new_size = t->slots ? (t->slot_mask + 1) * 2 : 1024;
+    int32_t* slots = malloc(new_size * sizeof(int32_t));
+    if (!slots) return -1;
+    memset(slots, 0xFF, new_size * sizeof(int32_t));
+
+    for (uint32_t pos = 0; pos < t->count; pos++) {
+        uint32_t s = object_slot(t->objects[pos].hash, t->objects[pos].type, new_size - 1);
+        while (slots[s] >= 0) s = (s + 1) & (new_size - 1);
+        slots[s] = (int32_t)pos;
+    }
+
+    free(t->slots);
+    t->slots = slots;
+    t->slot_mask = new_size - 1;
+    return 0;
+}
+
+static uint32_t object_file_size(uint64_t hash, uint32_t type) {
+    if (type == OBJ_COMMIT) return 0;   /* commits live in commits.dat */
+
+    char path[MAX_PATH];
+    snprintf(path, sizeof(path), "%s/%llu.%s", OBJECTS_DIR,
+             (unsigned long long)hash, type == OBJ_TREE ? "tree" : "blob");
+
+    struct stat st;
+    return stat(path, &st) == 0 ? (uint32_t)st.st_size : 0;
+}
+
+/*
+ * FUNCTION: table_position
+ * ────────────────────────
+ * Position of an object; adds it if it's new.
+ * `size` < 0 means "look it up on disk" (only done for new ones).
+ * RETURNS: position, or -1 on out-of-memory
+ */
+static int32_t table_position(ObjectTable* t, uint64_t hash, uint32_t type, int64_t size) {
+    if (!t->slots || (t->count + 1) * 2 > t->slot_mask + 1) {
+        if (table_grow_slots(t) != 0) return -1;
+    }
+
+    uint32_t s = object_slot(hash, type, t->slot_mask);
+    while (t->slots[s] >= 0) {
+        const ObjectInfo* o = &t->objects[t->slots[s]];
+        if (o->hash == hash && o->type == type) {
+            return t->slots[s];
+        }
+        s = (s + 1) & t->slot_mask;
+    }
+
+    if (t->count == t->capacity) {
+        uint32_t new_capacity = t->capacity ? t->capacity * 2 : 1024;
+        ObjectInfo* grown = realloc(t->objects, new_capacity * sizeof(ObjectInfo));
+        if (!grown) return -1;
+        t->objects = grown;
+        t->capacity = new_capacity;
+    }
+
+    t->objects[t->count].hash = hash;
+    t->objects[t->count].size = size >= 0 ? (uint32_t)size : object_file_size(hash, type);
+    t->objects[t->count].type = type;
+    t->slots[s] = (int32_t)t->count;
+    return (int32_t)t->count++;
+}
+
+static void table_free(ObjectTable* t) {
+    free(t->objects);
+    free(t->slots);
+    memset(t, 0, sizeof(*t));
+}
+
+
+
+/*
+ * ─────────── GROWABLE BITSET ───────────
+ */
+
+typedef struct Bitset {
+    uint64_t* words;
+    size_t count;
+} Bitset;
+
+static int bitset_reserve(Bitset* b, uint32_t bit) {
+    size_t need = bit / 64 + 1;
+    if (need <= b->count) return 0;
+
+    size_t new_count = b->count ? b->count : 16;
+    while (new_count < need) new_count *= 2;
+
+    uint64_t* grown = realloc(b->words, new_count * sizeof(uint64_t));
+    if (!grown) return -1;
+    memset(grown + b->count, 0, (new_count - b->count) * sizeof(uint64_t));
+    b->words = grown;
+    b->count = new_count;
+    return 0;
+}
+
+static int bitset_test(const Bitset* b, uint32_t bit) {
+    return bit / 64 < b->count && (b->words[bit / 64] >> (bit % 64)) & 1;
+}
+
+static int bitset_set(Bitset* b, uint32_t bit) {
+    if (bitset_reserve(b, bit) != 0) return -1;
+    b->words[bit / 64] |= 1ull << (bit % 64);
+    return 0;
+}
+
+
+/*
+ * ─────────── REACHABILITY ───────────
+ */
+
+typedef struct BitmapIndex {
+    MappedFile file;
+    ObjectTable table;
+    StoredBitmap* bitmaps;           // sorted by commit id
+    int bitmap_count;
+    uint32_t stored_objects;         // positions that bitmaps cover
+} BitmapIndex;
+
+
+static int compare_stored(const void* a, const void* b) {
+    return ((const StoredBitmap*)a)->commit_id - ((const StoredBitmap*)b)->commit_id;
+}
+
+static const StoredBitmap* find_bitmap(const BitmapIndex* idx, int commit_id) {
+    if (idx->bitmap_count == 0) {
+        return NULL;                 // idx->bitmaps may be NULL then
+    }
+    StoredBitmap key = { commit_id, NULL, 0 };
+    return bsearch(&key, idx->bitmaps, idx->bitmap_count, sizeof(StoredBitmap), compare_stored);
+}
+
+
+/*
+ * FUNCTION: mark_tree
+ * ───────────────────
+ * Sets the bits for a tree and everything under it.
+ * If the tree's bit is already set, its whole sub-tree is
+ * already in the set — we don't even open it.
+ */
+static int mark_tree(BitmapIndex* idx, Bitset* bits, unsigned long tree_id) {
+    if (tree_id == 0) return 0;
+
+    int32_t pos = table_position(&idx->table, tree_id, OBJ_TREE, -1);
+    if (pos < 0) return -1;
+    if (bitset_test(bits, pos)) return 0;
+    if (bitset_set(bits, pos) != 0) return -1;
+
+    TreeEntry* entries;
+    int count;
+    if (tree_read(tree_id, &entries, &count) != 0) {
+        return 0;   /* missing object: count what we can */
+    }
+
+    int result = 0;
+    for (int i = 0; i < count && result == 0; i++) {
+        if (entries[i].is_tree) {
+            result = mark_tree(idx, bits, entries[i].hash);
+        } else {
+            int32_t blob = table_position(&idx->table, entries[i].hash, OBJ_BLOB, -1);
+            result = blob < 0 ? -1 : bitset_set(bits, blob);
+        }
+    }
+
+    free(entries);
+    return result;
+}
+
+
+/*
+ * FUNCTION: reach_from
+ * ────────────────────
+ * ORs everything reachable from `tip` into `bits`.
+ *
+ *   Walk back from tip through the commit-graph:
+ *   → a commit that HAS a bitmap: OR it in, stop this path
+ *   → any other commit: mark it + its tree, go to parents
+ *
+ * `skip_self` lets the bitmap writer ignore the tip's own
+ * (not yet written) bitmap.
+ */
+static int reach_from(BitmapIndex* idx, Bitset* bits, int tip, int skip_self) {
+    int stack_capacity = 64;
+    int stack_size = 0;
+    int* stack = malloc(stack_capacity * sizeof(int));
+    if (!stack) return -1;
+
+    stack[stack_size++] = tip;
+    int result = 0;
+
+    while (stack_size > 0 && result == 0) {
+        int id = stack[--stack_size];
+        const GraphEntry* e = graph_entry(id);
+        if (!e) continue;
+
+        int32_t pos = table_position(&idx->table, (uint64_t)id, OBJ_COMMIT, 0);
+        if (pos < 0) { result = -1; break; }
+        if (bitset_test(bits, pos)) continue;   /* already covered */
+
+        const StoredBitmap* stored = (id == tip && skip_self) ? NULL : find_bitmap(idx, id);
+        if (stored) {
+            if (bitset_reserve(bits, idx->stored_objects) != 0) { result = -1; break; }
+            ewah_or_into(stored->words, stored->word_count, bits->words, bits->count);
+            continue;
+        }
+
+        if (bitset_set(bits, pos) != 0 || mark_tree(idx, bits, commit_root_tree(id)) != 0) {
+            result = -1;
+            break;
+        }
+
+        for (int p = 0; p < 2; p++) {
+            if (e->parents[p] == GRAPH_NO_PARENT) continue;
+            if (stack_size == stack_capacity) {
+                stack_capacity *= 2;
+                int* grown = realloc(stack, stack_capacity * sizeof(int));
+                if (!grown) { result = -1; break; }
+                stack = grown;
+            }
+            stack[stack_size++] = (int)e->parents[p] + 1;
+        }
+    }
+
+    free(stack);
+    return result;
+}
+
+
+/*
+ * FUNCTION: bitmap_index_load
+ * ───────────────────────────
+ * Maps objects.bitmap and rebuilds the in-memory position map.
+ * A missing file just means "no bitmaps yet" — still usable.
+ */
+static void bitmap_index_load(BitmapIndex* idx) {
+    memset(idx, 0, sizeof(*idx));
+
+    if (map_file(BITMAP_FILE, &idx->file) != 0) {
+        return;
+    }
+
+    const BitmapHeader* header = (const BitmapHeader*)idx->file.data;
+    size_t table_end = sizeof(BitmapHeader);
+
+    if (idx->file.size < sizeof(BitmapHeader)
+        || memcmp(header->magic, BITMAP_MAGIC, 4) != 0
+        || header->version != BITMAP_VERSION
+        || (idx->file.size - table_end) / sizeof(ObjectInfo) < header->object_count) {
+        unmap_file(&idx->file);
+        return;
+    }
+
+    const ObjectInfo* objects = (const ObjectInfo*)(idx->file.data + table_end);
+    for (uint32_t i = 0; i < header->object_count; i++) {
+        table_position(&idx->table, objects[i].hash, objects[i].type, objects[i].size);
+    }
+    idx->stored_objects = header->object_count;
+
+    idx->bitmaps = calloc(header->bitmap_count > 0 ? header->bitmap_count : 1, sizeof(StoredBitmap));
+    if (!idx->bitmaps) return;
+
+    size_t offset = table_end + (size_t)header->object_count * sizeof(ObjectInfo);
+    for (uint32_t i = 0; i < header->bitmap_count; i++) {
+        if (idx->file.size - offset < sizeof(BitmapRecord)) break;
+
+        BitmapRecord rec;
+        memcpy(&rec, idx->file.data + offset, sizeof(rec));
+        offset += sizeof(rec);
+
+        if ((idx->file.size - offset) / sizeof(uint64_t) < rec.word_count) break;
+
+        idx->bitmaps[idx->bitmap_count].commit_id = rec.commit_id;
+        idx->bitmaps[idx->bitmap_count].words = (const uint64_t*)(idx->file.data + offset);
+        idx->bitmaps[idx->bitmap_count].word_count = rec.word_count;
+        idx->bitmap_count++;
+        offset += (size_t)rec.word_count * sizeof(uint64_t);
+    }
+
+    if (idx->bitmap_count > 0) {
+        qsort(idx->bitmaps, idx->bitmap_count, sizeof(StoredBitmap), compare_stored);
+    }
+}
+
+static void bitmap_index_free(BitmapIndex* idx) {
+    table_free(&idx->table);
+    free(idx->bitmaps);
+    unmap_file(&idx->file);
+}
+
+
+/*
+ * FUNCTION: bitmap_write
+ * ──────────────────────
+ * Computes bitmaps from scratch for the selected commits:
+ * the branch tip, plus every BITMAP_EVERY-th commit.
+ *
+ * Commits are processed oldest first, so each new bitmap is
+ * mostly "OR in an older bitmap" plus a short walk — and
+ * object positions come out in history order.
+ *
+ * RETURNS: number of bitmaps written, or -1 on error
+ */
+int bitmap_write(int tip_id) {
+    int count = graph_count();
+    if (count <= 0) {
+        return 0;
+    }
+
+    BitmapIndex idx;
+    memset(&idx, 0, sizeof(idx));
+
+    int capacity = count / BITMAP_EVERY + 2;
+    StoredBitmap* made = calloc(capacity, sizeof(StoredBitmap));
+    WordArray* encoded = calloc(capacity, sizeof(WordArray));
+    int made_count = 0;
+    int result = 0;
+
+    if (!made || !encoded) {
+        free(made);
+        free(encoded);
+        return -1;
+    }
+
+    for (int id = 1; id <= count && result == 0; id++) {
+        if (id % BITMAP_EVERY != 0 && id != tip_id) continue;
+
+        /* Earlier bitmaps from this run are visible to the walk */
+        idx.bitmaps = made;
+        idx.bitmap_count = made_count;
+        idx.stored_objects = idx.table.count;
+
+        Bitset bits = { NULL, 0 };
+        if (reach_from(&idx, &bits, id, 1) != 0
+            || ewah_encode(bits.words, bits.count, &encoded[made_count]) != 0) {
+            result = -1;
+        } else {
+            made[made_count].commit_id = id;
+            made[made_count].words = encoded[made_count].words;
+            made[made_count].word_count = (uint32_t)encoded[made_count].count;
+            made_count++;
+        }
+        free(bits.words);
+    }
+
+    if (result == 0) {
+        AtomicFile af;
+        if (atomic_open(&af, BITMAP_FILE) != 0) {
+            result = -1;
+        } else {
+            BitmapHeader header;
+            memcpy(header.magic, BITMAP_MAGIC, 4);
+            header.version = BITMAP_VERSION;
+            header.object_count = idx.table.count;
+            header.bitmap_count = (uint32_t)made_count;
+
+            int ok = fwrite(&header, sizeof(header), 1, af.fp) == 1
+                  && fwrite(idx.table.objects, sizeof(ObjectInfo), idx.table.count, af.fp) == idx.table.count;
+
+            for (int i = 0; i < made_count && ok; i++) {
+                BitmapRecord rec = { made[i].commit_id, made[i].word_count };
+                ok = fwrite(&rec, sizeof(rec), 1, af.fp) == 1
+                  && fwrite(made[i].words, sizeof(uint64_t), made[i].word_count, af.fp) == made[i].word_count;
+            }
+
+            if (!ok) {
+                atomic_abort(&af);
+                result = -1;
+            } else {
+                result = atomic_commit(&af) == 0 ? made_count : -1;
+            }
+        }
+    }
+
+    for (int i = 0; i < made_count; i++) {
+        free(encoded[i].words);
+    }
+    free(encoded);
+    free(made);
+    table_free(&idx.table);
+    return result;
+}
+
+
+/*
+ * FUNCTION: bitmap_reach
+ * ──────────────────────
+ * Counts everything reachable from the given tips.
+ *
+ * RETURNS: 0 → stats filled, -1 → error
+ */
+int bitmap_reach(const int* tips, int tip_count, ReachStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+
+    BitmapIndex idx;
+    bitmap_index_load(&idx);
+    stats->bitmaps_available = idx.bitmap_count;
+
+    Bitset bits = { NULL, 0 };
+    int result = 0;
+
+    for (int i = 0; i < tip_count && result == 0; i++) {
+        result = reach_from(&idx, &bits, tips[i], 0);
+    }
+
+    /* Tally the set bits by object type */
+    for (uint32_t pos = 0; pos < idx.table.count && result == 0; pos++) {
+        if (!bitset_test(&bits, pos)) continue;
+
+        const ObjectInfo* o = &idx.table.objects[pos];
+        if (o->type == OBJ_COMMIT) stats->commits++;
+        else if (o->type == OBJ_TREE) stats->trees++;
+        else stats->blobs++;
+        stats->bytes += o->size;
+    }
+
+    free(bits.words);
+    bitmap_index_free(&idx);
+    return result;
+}
+
+
+/*
+ * ═══════════════════════════════════════════
+ * MAIN FUNCTION: mygit_count_objects
+ * ═══════════════════════════════════════════
+ *
+ *   mygit count-objects                 → current branch
+ *   mygit count-objects dev             → branch "dev"
+ *   mygit count-objects --write-bitmap  → (re)compute bitmaps first
+ */
+int mygit_count_objects(const char* branch, int write_bitmaps) {
+    char current[MAX_BRANCH_NAME];
+    if (!branch) {
+        branch = get_current_branch(current, sizeof(current));
+    }
+
+    int tip = get_last_commit_id_on_branch(branch);
+    if (tip <= 0) {
+        printf(YELLOW "⚠ Branch '%s' has no commits yet\n" RESET, branch);
+        return 0;
+    }
+
+    if (write_bitmaps) {
+        int written = bitmap_write(tip);
+        if (written < 0) {
+            printf(RED "✗ Failed to write %s\n" RESET, BITMAP_FILE);
+            return -1;
+        }
+        printf(GREEN "✓ Wrote %d bitmap(s) to %s\n" RESET, written, BITMAP_FILE);
+    }
+
+    ReachStats stats;
+    if (bitmap_reach(&tip, 1, &stats) != 0) {
+        printf(RED "✗ Failed to count reachable objects\n" RESET);
+        return -1;
+    }
+
+    printf(CYAN "Reachable from %s (commit #%d):\n" RESET, branch, tip);
+    printf("  commits: %lu\n", stats.commits);
+    printf("  trees:   %lu\n", stats.trees);
+    printf("  blobs:   %lu\n", stats.blobs);
+    printf("  size:    %.1f KB\n", stats.bytes / 1024.0);
+    printf("  bitmaps: %d\n", stats.bitmaps_available);
+
+    return 0;
+}
@@ -1,11 +1,146 @@
+/*
+ * ============================================
+ *          MYGIT - Branch Command
+ *          "mygit branch [name]"
+ * ============================================
+ *
+ * PURPOSE:
+ *   mygit branch          → list every branch
+ *   mygit branch <name>   → new branch at the current commit
+ *
+ *   A branch is just a NAME pointing to a COMMIT ID — where
+ *   that name is stored (loose file or packed-refs) is refs.c's
+ *   business.
+ */
+
 #include "mygit.h"
 
+
+/*
+ * FUNCTION: mygit_branch
+ * ──────────────────────
+ * Creates <name> pointing where the current branch points.
+ */
 int mygit_branch(const char* branch_name) {
-    printf(YELLOW "🌿 [Coming Week 3] Will create branch: %s\n" RESET, branch_name);
+
+    if (!ref_name_valid(branch_name)) {
+        printf(RED "✗ '%s' is not a valid branch name\n" RESET, branch_name);
+        printf("  Use letters, digits and - _ . / (max %d characters).\n", MAX_BRANCH_NAME - 1);
+        return 1;
+    }
+
+    char current[MAX_BRANCH_NAME];
+    get_current_branch(current, sizeof(current));
+    int tip = get_last_commit_id_on_branch(current);
+
+    /*
+     * "Create it only if it doesn't exist" must be ONE step —
+     * checking first and writing after would let two
+     * "mygit branch x" both succeed.
+     */
+    char reason[MAX_BRANCH_NAME + 32];
+    snprintf(reason, sizeof(reason), "branch: created from %s", current);
+
+    RefTxn txn;
+    ref_txn_init(&txn);
+    ref_txn_update(&txn, branch_name, REF_MUST_NOT_EXIST, tip, reason);
+
+    int rc = ref_txn_commit(&txn);
+    ref_txn_free(&txn);
+
+    if (rc == REF_TXN_CONFLICT) {
+        printf(RED "✗ Branch '%s' already exists\n" RESET, branch_name);
+        return 1;
+    }
+    if (rc != 0) {
+        printf(RED "✗ Could not create branch '%s'\n" RESET, branch_name);
+        return 1;
+    }
+
+    printf(GREEN "🌿 Created branch '%s'" RESET, branch_name);
+    if (tip > 0) {
+        printf(" at commit #%d", tip);
+    }
+    printf("\n");
     return 0;
 }
 
+
+/*
+ * FUNCTION: mygit_list_branches
+ * ─────────────────────────────
+ * Prints all branches in name order, marking the current one:
+ *
+ *   * main          #31
+ *     feature/login #9
+ *
+ * For scripts (--format=porcelain / json, see output.c):
+ *
+ *   main<TAB>31<TAB>1                       (id 0 = no commits)
+ *   {"name":"main","id":31,"current":true}
+ */
 int mygit_list_branches(void) {
-    printf(YELLOW "🌿 [Coming Week 3] Will list branches\n" RESET);
+
+    char current[MAX_BRANCH_NAME];
+    get_current_branch(current, sizeof(current));
+
+    int count;
+    RefInfo* refs = refs_list(&count);
+
+    /* Line the commit numbers up in one column */
+    int width = 0;
+    for (int i = 0; i < count; i++) {
+        int len = (int)strlen(refs[i].name);
+        if (len > width) width = len;
+    }
+
+    for (int i = 0; i < count; i++) {
+        int is_current = strcmp(refs[i].name, current) == 0;
+        int id = refs[i].id > 0 ? refs[i].id : 0;
+
+        switch (out_format()) {
+        case OUT_HUMAN:
+            if (is_current) {
+                out_color(GREEN);
+                out_str("* ");
+                out_padded(refs[i].name, width);
+                out_color(RESET);
+            } else {
+                out_str("  ");
+                out_padded(refs[i].name, width);
+            }
+
+            if (id > 0) {
+                out_color(YELLOW);
+                out_str(" #");
+                out_int(id);
+                out_color(RESET);
+                out_char('\n');
+            } else {
+                out_str(" (no commits)\n");
+            }
+            break;
+
+        case OUT_PORCELAIN:
+            out_str(refs[i].name);
+            out_char('\t');
+            out_int(id);
+            out_str(is_current ? "\t1" : "\t0");
+            out_end_record();
+            break;
+
+        case OUT_JSON:
+            out_str("{\"name\":");
+            out_json_string(refs[i].name, strlen(refs[i].name));
+            out_json_key("id");
+            out_int(id);
+            out_json_key("current");
+            out_str(is_current ? "true}" : "false}");
+            out_end_record();
+            break;
+        }
+    }
+
+    free(refs);
     return 0;
-}
\ No newline at end of file
+}
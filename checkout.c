@@ -1,6 +1,378 @@
+/*
+ * ============================================
+ *          MYGIT - Checkout Command
+ *          "mygit checkout <branch | commit-id>"
+ * ============================================
+ *
+ * PURPOSE:
+ *   Move the working folder from the commit it is on to another.
+ *
+ *   mygit checkout 3        → files as they were in commit #3
+ *   mygit checkout main     → switch to branch main (HEAD moves)
+ *   mygit checkout main@{1} → where main was before its last move
+ *
+ *   Only files that DIFFER between the two commits are touched.
+ *   Your own changes to the other files — edits, and deletions
+ *   too — carry over untouched, the way git does it.
+ *
+ * DETACHED:
+ *   Checking out a commit id (or a reflog entry) only shows you
+ *   those files: HEAD stays on its branch, whose tip is NOT this
+ *   commit. Until a branch is checked out again, "mygit add" and
+ *   "mygit commit" refuse to run — a commit would land on the
+ *   branch tip and quietly mix old files into it.
+ *
+ * WHY THIS IS FAST:
+ *   Every commit stores its FULL snapshot as one root tree
+ *   (see tree.c), so we never replay history. We compare the
+ *   snapshot we're on with the one we want:
+ *
+ *     tree_diff(current, target)
+ *
+ *   Sub-directories with the same tree id are skipped whole —
+ *   only files that really differ are written or deleted.
+ *
+ * SAFETY:
+ *   A file that was edited since the last commit is never
+ *   overwritten. Checkout stops and tells you instead.
+ */
+
 #include "mygit.h"
 
-int mygit_checkout(const char* target) {
-    printf(YELLOW "⏪ [Coming Week 2] Will checkout: %s\n" RESET, target);
+
+/* What the tree_diff callbacks need to know */
+typedef struct CheckoutState {
+    int conflicts;                   // locally edited files in the way
+    int written;
+    int removed;
+    int errors;
+} CheckoutState;
+
+
+/*
+ * FUNCTION: working_file_hash
+ * ───────────────────────────
+ * Hash of a file in the working folder, same as "mygit add"
+ * would compute it.
+ *
+ * RETURNS: 1 and *hash set, or 0 if the file doesn't exist
+ */
+static int working_file_hash(const char* path, unsigned long* hash) {
+    MappedFile mf;
+    if (!file_exists(path) || map_file(path, &mf) != 0) {
+        return 0;
+    }
+
+    *hash = hash_bytes(mf.data, mf.size);
+    unmap_file(&mf);
+    return 1;
+}
+
+
+/*
+ * FUNCTION: check_change
+ * ──────────────────────
+ * First pass: would changing this path destroy someone's work?
+ *
+ *   working file == old version   → safe to replace
+ *   working file == new version   → nothing to do anyway
+ *   file missing                  → safe
+ *   anything else                 → CONFLICT
+ */
+static void check_change(const char* path, unsigned long old_hash,
+                         unsigned long new_hash, void* ctx) {
+    CheckoutState* state = ctx;
+
+    unsigned long current;
+    if (!working_file_hash(path, &current)) {
+        return;
+    }
+
+    if (current != old_hash && current != new_hash) {
+        if (state->conflicts == 0) {
+            printf(RED "✗ Your changes to these files would be overwritten:\n" RESET);
+        }
+        printf("    " YELLOW "%s" RESET "\n", path);
+        state->conflicts++;
+    }
+}
+
+
+/*
+ * FUNCTION: make_parent_dirs
+ * ──────────────────────────
+ * "src/util/io.c" → makes sure "src" and "src/util" exist.
+ */
+static void make_parent_dirs(const char* path) {
+    char dir[MAX_PATH];
+    strncpy(dir, path, MAX_PATH - 1);
+    dir[MAX_PATH - 1] = '\0';
+
+    for (char* slash = strchr(dir, '/'); slash; slash = strchr(slash + 1, '/')) {
+        *slash = '\0';
+        if (!directory_exists(dir)) {
+            create_directory(dir);
+        }
+        *slash = '/';
+    }
+}
+
+
+/*
+ * FUNCTION: remove_empty_parents
+ * ──────────────────────────────
+ * After deleting "src/util/io.c", removes "src/util" and then
+ * "src" — but only while they are empty (rmdir refuses otherwise).
+ */
+static void remove_empty_parents(const char* path) {
+    char dir[MAX_PATH];
+    strncpy(dir, path, MAX_PATH - 1);
+    dir[MAX_PATH - 1] = '\0';
+
+    char* slash;
+    while ((slash = strrchr(dir, '/')) != NULL) {
+        *slash = '\0';
+#ifdef _WIN32
+        if (_rmdir(dir) != 0) break;
+#else
+        if (rmdir(dir) != 0) break;
+#endif
+    }
+}
+
+
+/*
+ * FUNCTION: restore_blob
+ * ──────────────────────
+ * Copies .mygit/objects/<hash>.blob to `path`.
+ *
+ * RETURNS: 0 → Success, -1 → Error
+ */
+static int restore_blob(const char* path, unsigned long hash) {
+    char blob_path[MAX_PATH];
+    snprintf(blob_path, sizeof(blob_path), "%s/%lu.blob", OBJECTS_DIR, hash);
+
+    MappedFile mf;
+    if (map_file(blob_path, &mf) != 0) {
+        printf(RED "  ✗ Missing object for %s\n" RESET, path);
+        return -1;
+    }
+
+    make_parent_dirs(path);
+
+    FILE* fp = fopen(path, "wb");
+    if (!fp) {
+        unmap_file(&mf);
+        printf(RED "  ✗ Could not write %s\n" RESET, path);
+        return -1;
+    }
+
+    int ok = fwrite(mf.data, 1, mf.size, fp) == mf.size;
+    unmap_file(&mf);
+
+    return (fclose(fp) == 0 && ok) ? 0 : -1;
+}
+
+
+/*
+ * FUNCTION: apply_change
+ * ──────────────────────
+ * Second pass: make the working folder match the target.
+ */
+static void apply_change(const char* path, unsigned long old_hash,
+                         unsigned long new_hash, void* ctx) {
+    CheckoutState* state = ctx;
+    (void)old_hash;
+
+    if (new_hash == 0) {
+        /* Not in the target snapshot → delete it */
+        if (remove(path) == 0) {
+            state->removed++;
+            remove_empty_parents(path);
+        }
+        return;
+    }
+
+    unsigned long current;
+    if (working_file_hash(path, &current) && current == new_hash) {
+        return;   /* already right */
+    }
+
+    if (restore_blob(path, new_hash) == 0) {
+        state->written++;
+    } else {
+        state->errors++;
+    }
+}
+
+
+/*
+ * FUNCTION: is_number
+ * ───────────────────
+ * "12" → 1, "main" → 0
+ */
+static int is_number(const char* text) {
+    if (*text == '\0') {
+        return 0;
+    }
+    for (; *text; text++) {
+        if (*text < '0' || *text > '9') {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+/*
+ * FUNCTION: switch_to
+ * ───────────────────
+ * Steps 2-5 of a checkout. The caller holds the staging lock
+ * for all of it: an "add" slipping in between the "nothing
+ * staged" check and the reset of staging.dat would be wiped
+ * out without a word.
+ *
+ * RETURNS: 0 → Success, 1 → Error (message already printed)
+ */
+static int switch_to(const char* branch, int commit_id) {
+
+    /*
+     * ──────────────────────────────────
+     * STEP 2: Don't lose staged work
+     * ──────────────────────────────────
+     */
+    if (count_staged_files() > 0) {
+        printf(RED "✗ You have staged changes. Commit them first.\n" RESET);
+        return 1;
+    }
+
+    /*
+     * ──────────────────────────────────
+     * STEP 3: Where are we, where to?
+     * ──────────────────────────────────
+     * The snapshot in the working folder is remembered in
+     * staging.dat's "#root" line. Repositories that don't
+     * have one yet are on their branch's latest commit.
+     */
+    unsigned long current_tree;
+    if (!staging_root(&current_tree)) {
+        char current_branch[MAX_BRANCH_NAME];
+        get_current_branch(current_branch, sizeof(current_branch));
+
+        int head_id = get_last_commit_id_on_branch(current_branch);
+        current_tree = head_id > 0 ? commit_root_tree(head_id) : 0;
+    }
+
+    unsigned long target_tree = commit_id > 0 ? commit_root_tree(commit_id) : 0;
+
+    /*
+     * ──────────────────────────────────
+     * STEP 4: Check, then change
+     * ──────────────────────────────────
+     * Two passes over the SAME diff, so we either change
+     * everything or nothing.
+     */
+    CheckoutState state = { 0, 0, 0, 0 };
+
+    if (tree_diff(current_tree, target_tree, check_change, &state) != 0) {
+        printf(RED "✗ Could not read the snapshot trees\n" RESET);
+        return 1;
+    }
+    if (state.conflicts > 0) {
+        printf("  Commit or undo your changes, then try again.\n");
+        return 1;
+    }
+
+    tree_diff(current_tree, target_tree, apply_change, &state);
+
+    if (state.errors > 0) {
+        printf(RED "✗ Checkout incomplete: %d file%s could not be restored\n" RESET,
+               state.errors, state.errors == 1 ? "" : "s");
+        return 1;
+    }
+
+    /*
+     * ──────────────────────────────────
+     * STEP 5: Remember where we are
+     * ──────────────────────────────────
+     */
+    if (staging_reset(target_tree) != 0) {
+        printf(RED "✗ Files checked out, but the staging area could not be updated\n" RESET);
+        return 1;
+    }
+
+    if (branch) {
+        write_file(HEAD_FILE, branch);
+        remove(DETACHED_FILE);
+        printf(GREEN "✅ Switched to branch '%s'" RESET, branch);
+        if (commit_id > 0) {
+            printf(" (commit #%d)", commit_id);
+        }
+        printf("\n");
+    } else {
+        char current_branch[MAX_BRANCH_NAME];
+        get_current_branch(current_branch, sizeof(current_branch));
+
+        char id_text[32];
+        snprintf(id_text, sizeof(id_text), "%d", commit_id);
+        write_file(DETACHED_FILE, id_text);
+
+        printf(GREEN "✅ Checked out commit #%d\n" RESET, commit_id);
+        printf(YELLOW "  This is a read-only view: add and commit are off until you\n"
+               "  go back with: mygit checkout %s\n" RESET, current_branch);
+    }
+
+    printf("  %d file%s written, %d removed\n",
+           state.written, state.written == 1 ? "" : "s", state.removed);
     return 0;
-}
\ No newline at end of file
+}
+
+
+/*
+ * ═══════════════════════════════════════════════
+ * MAIN FUNCTION: mygit_checkout
+ * ═══════════════════════════════════════════════
+ */
+int mygit_checkout(const char* target) {
+
+    /*
+     * ──────────────────────────────────
+     * STEP 1: Branch name or commit id?
+     * ──────────────────────────────────
+     * A branch wins if both would match.
+     * "main@{2}" means "where main was 2 moves ago" (reflog.c).
+     */
+    const char* branch = NULL;
+    int commit_id;
+
+    int from_reflog = reflog_resolve(target, &commit_id);
+    if (from_reflog < 0) {
+        return 1;
+    }
+
+    if (from_reflog) {
+        if (commit_id <= 0) {
+            printf(RED "✗ %s has no commit\n" RESET, target);
+            return 1;
+        }
+    } else if (ref_read(target, &commit_id)) {
+        branch = target;
+    } else if (is_number(target)) {
+        commit_id = atoi(target);
+        if (commit_id <= 0 || commit_id >= get_next_commit_id()) {
+            printf(RED "✗ Commit #%s doesn't exist\n" RESET, target);
+            return 1;
+        }
+    } else {
+        printf(RED "✗ No branch or commit named '%s'\n" RESET, target);
+        return 1;
+    }
+
+    /* Everything from here on holds the staging lock (see switch_to) */
+    if (lockfile_acquire(STAGING_FILE) != 0) {
+        return 1;
+    }
+    int rc = switch_to(branch, commit_id);
+    lockfile_release(STAGING_FILE);
+    return rc;
+}
@@ -13,22 +13,28 @@
  * 
  * DATA STRUCTURES USED:
  *   1. Linked List → Chain of commits (each points to parent)
- *   2. Array       → Storing filenames and hashes
- *   3. Hash values → Identifying file versions
+ *   2. Linked List → Staged files read from staging.dat
+ *   3. Tree        → Directory snapshot (see tree.c)
+ *   4. Hash values → Identifying file and tree versions
  * 
  * FILE FORMAT (commits.dat):
  *   COMMIT:1
  *   MSG:Initial commit
- *   TIME:2025-01-15 14:30:00
+ *   TIME:1736947800 +0100
  *   BRANCH:main
  *   PARENT:-1
- *   FILES:hello.txt,test.txt
- *   HASHES:193485797,874291053
+ *   TREE:3581723046
  *   END
+ * 
+ *   (Older commits have FILES: / HASHES: lines instead of TREE:
+ *    — tree.c knows how to read those too — and a local
+ *    "2025-01-15 14:30:00" TIME: that parse_commit_time reads.)
  */
 
 #include "mygit.h"
 
+#define COMMIT_ATTEMPTS 5            // tries when racing another committer
+
 
 /*
  * FUNCTION: count_staged_files
@@ -40,45 +46,38 @@
  *   We should warn the user instead of creating an empty commit.
  * 
  * HOW?
- *   Read staging.dat line by line.
- *   Skip comments (lines starting with #).
- *   Skip empty lines.
- *   Count everything else.
+ *   Map staging.dat and let staging_next (parse.c) walk it.
+ *   It skips comments (lines starting with #) and empty lines,
+ *   so we just count what it hands us.
  * 
  * RETURNS:
  *   Number of staged files (0, 1, 2, ...)
  */
 int count_staged_files(void) {
 
-    FILE* fp = fopen(STAGING_FILE, "r");
+    MappedFile mf;
 
     /* If staging file doesn't exist, 0 files staged */
-    if (!fp) {
+    if (map_file(STAGING_FILE, &mf) != 0) {
         return 0;
     }
 
+    LineCursor cursor;
+    TextView path;
+    unsigned long hash;
     int count = 0;
-    char line[MAX_LINE];
-
-    while (fgets(line, sizeof(line), fp)) {
 
-        /* Remove newline at end */
-        line[strcspn(line, "\n\r")] = '\0';
-
-        /* Skip comments and empty lines */
-        if (line[0] == '#' || strlen(line) == 0) {
-            continue;
-        }
+    lines_init(&cursor, mf.data, mf.size);
 
-        /*
-         * If we reach here, this line is a real entry
-         * like "hello.txt|193485797"
-         * So count it!
-         */
+    /*
+     * Every entry like "hello.txt|193485797" is one
+     * staged file — so count it!
+     */
+    while (staging_next(&cursor, &path, &hash)) {
         count++;
     }
 
-    fclose(fp);
+    unmap_file(&mf);
     return count;
 }
 
@@ -86,142 +85,92 @@ int count_staged_files(void) {
 /*
  * FUNCTION: read_staged_files
  * ───────────────────────────
- * Reads the staging area and fills a Commit struct
- * with the filenames and hashes.
+ * Reads the staging area into a LINKED LIST of StagedFile nodes.
  * 
  * ANALOGY:
  *   The shopkeeper reads his waiting notebook
  *   and writes all the info onto the final receipt.
  * 
- * PARAMETERS:
- *   commit → Pointer to a Commit struct that we'll fill in
- *            (We use a POINTER so we can MODIFY the original)
+ * WHY A LINKED LIST?
+ *   We don't know how many files are staged — could be 1,
+ *   could be 10,000. Each line simply becomes one more node,
+ *   so there is no "maximum files per commit" any more.
  * 
- * Remember from class:
- *   void foo(int x)    → gets a COPY, can't change original
- *   void foo(int* x)   → gets ADDRESS, CAN change original
- *   
- *   Same idea here:
- *   void foo(Commit c)  → gets COPY of commit (useless!)
- *   void foo(Commit* c) → gets ADDRESS, we fill in the real one ✓
+ * PARAMETERS:
+ *   count → receives the number of files read
+ *           (We use a POINTER so we can MODIFY the original)
  * 
  * RETURNS:
- *   0  → Success (commit struct is now filled)
- *   -1 → Error
+ *   Head of the list (NULL if nothing staged)
+ *   Free it with free_staged_files()
  */
-int read_staged_files(Commit* commit) {
+StagedFile* read_staged_files(int* count) {
 
-    FILE* fp = fopen(STAGING_FILE, "r");
+    *count = 0;
 
-    if (!fp) {
-        return -1;
+    MappedFile mf;
+    if (map_file(STAGING_FILE, &mf) != 0) {
+        return NULL;
     }
 
-    /*
-     * Start with 0 files.
-     * We'll increment this as we read each entry.
-     */
-    commit->file_count = 0;
+    StagedFile* head = NULL;
+    StagedFile* tail = NULL;
 
-    char line[MAX_LINE];
+    LineCursor cursor;
+    TextView path;
+    unsigned long hash;
 
-    while (fgets(line, sizeof(line), fp)) {
+    lines_init(&cursor, mf.data, mf.size);
 
-        /* Remove newline */
-        line[strcspn(line, "\n\r")] = '\0';
+    /*
+     * staging_next splits "hello.txt|193485797" for us:
+     *   path → "hello.txt"   (a view into the mapped file)
+     *   hash → 193485797     (already a number)
+     */
+    while (staging_next(&cursor, &path, &hash)) {
 
-        /* Skip comments and empty lines */
-        if (line[0] == '#' || strlen(line) == 0) {
-            continue;
+        StagedFile* node = malloc(sizeof(StagedFile));
+        if (!node) {
+            break;
         }
 
-        /*
-         * Safety check: Don't exceed our array size!
-         * 
-         * Our Commit struct has:
-         *   char filenames[10][MAX_FILENAME]
-         *   unsigned long file_hashes[10]
-         * 
-         * So we can store at most 10 files per commit.
-         * If user staged more than 10, we stop.
-         * 
-         * In a real project, you'd use dynamic arrays or
-         * linked lists. But 10 is enough for our demo!
-         */
-        if (commit->file_count >= 10) {
-            printf(YELLOW "⚠ Maximum 10 files per commit. Extra files skipped.\n" RESET);
-            break;   /* "break" exits the while loop immediately */
+        /* The list outlives the mapping, so the name IS copied here */
+        if (view_copy(path, node->filename, MAX_FILENAME) != 0) {
+            printf(YELLOW "⚠ Skipping staged path longer than %d characters\n" RESET,
+                   MAX_FILENAME - 1);
+            free(node);
+            continue;
         }
 
-        /*
-         * Parse the line: "hello.txt|193485797"
-         * 
-         * We need to split it at the '|' character
-         * Left side  → filename  ("hello.txt")
-         * Right side → hash      (193485797)
-         * 
-         * We'll use strtok (learned in Day 2!)
-         */
-
-        /* Make a copy because strtok MODIFIES the string */
-        char temp[MAX_LINE];
-        strcpy(temp, line);
-
-        /* Get the filename (part before '|') */
-        char* filename = strtok(temp, "|");
-
-        /* Get the hash string (part after '|') */
-        char* hash_str = strtok(NULL, "|");
-
-        /*
-         * strtok returns NULL if there's nothing left.
-         * We need BOTH parts to be valid.
-         * 
-         * && means AND → Both conditions must be true
-         */
-        if (filename && hash_str) {
-
-            /*
-             * Store the filename in our commit's array
-             * 
-             * commit->filenames[0] = "hello.txt"
-             * commit->filenames[1] = "test.txt"
-             * ...
-             * 
-             * commit->file_count tells us which SLOT to use
-             * First file → slot 0
-             * Second file → slot 1
-             * etc.
-             */
-            strcpy(commit->filenames[commit->file_count], filename);
-
-            /*
-             * Convert hash from STRING to NUMBER
-             * 
-             * hash_str = "193485797" (this is TEXT, not a number!)
-             * 
-             * strtoul = "string to unsigned long"
-             * Converts "193485797" → 193485797
-             * 
-             * strtoul(STRING, END_POINTER, BASE)
-             *   STRING      → "193485797"
-             *   END_POINTER → NULL (we don't care where it stopped)
-             *   BASE        → 10 (decimal number system)
-             * 
-             * Other bases:
-             *   Base 2  → Binary  (0, 1)
-             *   Base 10 → Decimal (0-9)     ← we use this
-             *   Base 16 → Hex     (0-9, A-F)
-             */
-            commit->file_hashes[commit->file_count] = strtoul(hash_str, NULL, 10);
-
-            /* Move to next slot */
-            commit->file_count++;
+        node->hash = hash;
+        node->next = NULL;
+
+        /* Append at the TAIL so files keep their staging order */
+        if (tail) {
+            tail->next = node;
+        } else {
+            head = node;
         }
+        tail = node;
+        (*count)++;
     }
 
-    fclose(fp);
-    return 0;
+    unmap_file(&mf);
+    return head;
+}
+
+
+/*
+ * FUNCTION: free_staged_files
+ * ───────────────────────────
+ * Frees every node of a staged-file list.
+ */
+void free_staged_files(StagedFile* head) {
+    while (head) {
+        StagedFile* next = head->next;
+        free(head);
+        head = next;
+    }
 }
 
 
@@ -236,7 +185,7 @@ int read_staged_files(Commit* commit) {
  *   That receipt becomes the 'previous' for our new receipt.
  * 
  * HOW:
- *   Read refs/main file → it contains the latest commit ID
+ *   Read refs/main (or packed-refs) → it contains the latest commit ID
  * 
  * RETURNS:
  *   Commit ID (positive number), or 0 if no commits yet
@@ -244,42 +193,23 @@ int read_staged_files(Commit* commit) {
 int get_last_commit_id_on_branch(const char* branch) {
 
     /*
-     * Build path to branch reference file
-     * 
-     * branch = "main"
-     * ref_path = ".mygit/refs/main"
-     * 
-     * This file contains just ONE number:
-     * the ID of the latest commit on this branch
-     */
-    char ref_path[MAX_PATH];
-    snprintf(ref_path, sizeof(ref_path), "%s/%s", REFS_DIR, branch);
-
-    /* Read the file content */
-    char content[64];
-
-    if (read_file(ref_path, content, sizeof(content)) < 0) {
-        return 0;   /* File doesn't exist → no commits yet */
-    }
-
-    /*
-     * atoi = "ASCII to integer"
-     * Converts "5" → 5
-     * Converts "0" → 0
-     * 
-     * Simple but works for our case!
+     * The branch lives either in its own file
+     * (".mygit/refs/main" containing just ONE number:
+     * the ID of the latest commit on this branch)
+     * or as a line in packed-refs. ref_read checks both.
      * 
-     * content = "3"  → atoi returns 3
-     * content = "0"  → atoi returns 0
+     * Unknown branch → 0 (no commits yet).
      */
-    return atoi(content);
+    int id = 0;
+    ref_read(branch, &id);
+    return id;
 }
 
 
 /*
  * FUNCTION: save_commit
  * ─────────────────────
- * Writes the commit to commits.dat file.
+ * Adds the commit record for commits.dat to the transaction.
  * 
  * THIS IS THE KEY MOMENT!
  * We're adding a new NODE to our linked list (on disk).
@@ -287,143 +217,74 @@ int get_last_commit_id_on_branch(const char* branch) {
  * The file format:
  *   COMMIT:2
  *   MSG:Added new feature
- *   TIME:2025-01-15 14:30:00
+ *   TIME:1736947800 +0100
  *   BRANCH:main
  *   PARENT:1
- *   FILES:hello.txt,test.txt
- *   HASHES:193485797,874291053
+ *   TREE:3581723046
  *   END
  * 
  * WHY THIS FORMAT?
- *   → Each field on its own line → easy to read with fgets
- *   → Key:Value format → easy to parse with sscanf
+ *   → Each field on its own line → easy to find with memchr
+ *   → Key:Value format → easy to split without copying
  *   → "END" marker → we know where each commit ends
  *   → Human-readable → you can open the file and understand it!
  * 
+ * NOTHING IS WRITTEN YET:
+ *   The record is only added to the transaction `txn`.
+ *   wal_commit() later APPENDS it to commits.dat — together
+ *   with the branch update and the staging reset, or not at all.
+ * 
+ *   We APPEND because we want to ADD new commits
+ *   without DELETING old ones!
+ * 
  * PARAMETERS:
  *   commit → Pointer to the filled Commit struct
+ *   txn    → The commit's transaction (see wal.c)
  * 
  * RETURNS:
  *   0 → Success
  *   -1 → Error
  */
-int save_commit(Commit* commit) {
+int save_commit(Commit* commit, WalTxn* txn) {
 
     /*
-     * Open commits.dat in APPEND mode ("a")
-     * 
-     * We APPEND because we want to ADD new commits
-     * without DELETING old ones!
-     * 
-     * "w" → Would erase all old commits! BAD!
-     * "a" → Adds to the end. Old commits stay safe! GOOD!
+     * TIME is "<epoch seconds> <+hhmm>": a plain number sorts and
+     * compares without parsing a calendar date, and the offset
+     * remembers the committer's clock for display.
      */
-    FILE* fp = fopen(COMMITS_FILE, "a");
-
-    if (!fp) {
-        printf(RED "✗ Could not open commits file\n" RESET);
-        return -1;
-    }
+    int offset = commit->tz_offset < 0 ? -commit->tz_offset : commit->tz_offset;
+    char time_text[64];
+    snprintf(time_text, sizeof(time_text), "%lld %c%02d%02d",
+             (long long)commit->time, commit->tz_offset < 0 ? '-' : '+',
+             offset / 60, offset % 60);
 
     /*
-     * Write the commit header
-     * Each fprintf writes one line
-     */
-    fprintf(fp, "COMMIT:%d\n", commit->id);
-    fprintf(fp, "MSG:%s\n", commit->message);
-    fprintf(fp, "TIME:%s\n", commit->timestamp);
-    fprintf(fp, "BRANCH:%s\n", commit->branch);
-    fprintf(fp, "PARENT:%d\n", commit->parent_id);
-
-    /*
-     * Write filenames as comma-separated list
-     * 
-     * If we have: filenames[0]="hello.txt", filenames[1]="test.txt"
-     * We write:   FILES:hello.txt,test.txt
-     * 
-     * The tricky part: commas go BETWEEN items, not after the last one!
+     * Build the whole record as one string, one field per line.
      * 
-     *   hello.txt,test.txt     ← CORRECT (comma between)
-     *   hello.txt,test.txt,    ← WRONG (extra comma at end)
+     * The whole snapshot is ONE number: the root tree.
+     * tree.c can expand it back into every file.
      * 
-     * Solution:
-     *   For the FIRST item (i=0): just write the name
-     *   For items after that (i>0): write comma THEN name
+     * The END marker tells our reader: "This commit entry is
+     * complete". Without it, we wouldn't know where one commit
+     * ends and the next begins!
      */
-    fprintf(fp, "FILES:");
-    for (int i = 0; i < commit->file_count; i++) {
-        if (i > 0) {
-            fprintf(fp, ",");   /* Comma before 2nd, 3rd, etc. */
-        }
-        fprintf(fp, "%s", commit->filenames[i]);
-    }
-    fprintf(fp, "\n");   /* End the FILES line */
-
-    /*
-     * Write hashes as comma-separated list (same pattern)
-     */
-    fprintf(fp, "HASHES:");
-    for (int i = 0; i < commit->file_count; i++) {
-        if (i > 0) {
-            fprintf(fp, ",");
-        }
-        fprintf(fp, "%lu", commit->file_hashes[i]);
+    char record[MAX_MESSAGE + MAX_BRANCH_NAME + 256];
+    int len = snprintf(record, sizeof(record),
+                       "COMMIT:%d\n"
+                       "MSG:%s\n"
+                       "TIME:%s\n"
+                       "BRANCH:%s\n"
+                       "PARENT:%d\n"
+                       "TREE:%lu\n"
+                       "END\n",
+                       commit->id, commit->message, time_text,
+                       commit->branch, commit->parent_id, commit->tree);
+
+    if (len < 0 || len >= (int)sizeof(record)) {
+        return -1;
     }
-    fprintf(fp, "\n");
-
-    /*
-     * Write the END marker
-     * 
-     * This tells our reader: "This commit entry is complete"
-     * Without it, we wouldn't know where one commit ends
-     * and the next begins!
-     */
-    fprintf(fp, "END\n");
-
-    fclose(fp);
-    return 0;
-}
-
-
-/*
- * FUNCTION: update_branch_ref
- * ───────────────────────────
- * Updates the branch pointer to the new commit.
- * 
- * BEFORE: refs/main contains "1" (pointing to commit #1)
- * AFTER:  refs/main contains "2" (now pointing to commit #2)
- * 
- * ANALOGY:
- *   The board in the shop says:
- *   "main branch → last receipt was #1"
- *   
- *   After new commit:
- *   "main branch → last receipt was #2"  ← UPDATED!
- * 
- * WHY?
- *   When we make the NEXT commit, we need to know
- *   what the current latest commit is.
- *   That becomes the new commit's PARENT.
- */
-void update_branch_ref(const char* branch, int commit_id) {
-
-    /* Build path: ".mygit/refs/main" */
-    char ref_path[MAX_PATH];
-    snprintf(ref_path, sizeof(ref_path), "%s/%s", REFS_DIR, branch);
-
-    /*
-     * Convert commit_id from NUMBER to STRING
-     * 
-     * commit_id = 2
-     * We need to write "2" to the file (as text)
-     * 
-     * snprintf converts: 2 → "2"
-     */
-    char id_str[20];
-    snprintf(id_str, sizeof(id_str), "%d", commit_id);
 
-    /* Write to file (overwrites old value) */
-    write_file(ref_path, id_str);
+    return wal_txn_append(txn, COMMITS_FILE, record, len);
 }
 
 
@@ -440,13 +301,15 @@ void update_branch_ref(const char* branch, int commit_id) {
  *   the same files again — that's wrong!
  * 
  * HOW?
- *   Simply overwrite staging.dat with just the header comment.
+ *   Overwrite staging.dat with the header comment and the new
+ *   commit's root tree (see tree.c), so checkout knows which
+ *   snapshot the working folder holds.
  */
-void clear_staging_area(void) {
+int clear_staging_area(WalTxn* txn, unsigned long tree) {
 
     /*
-     * "w" mode OVERWRITES the entire file
-     * We write only the comment header
+     * The new file REPLACES the old one entirely
+     * It holds only the comment header
      * All staged file entries are GONE
      * 
      * BEFORE:
@@ -456,14 +319,161 @@ void clear_staging_area(void) {
      * 
      * AFTER:
      *   # MyGit Staging Area
-     *   (that's it! clean!)
+     *   #root 874291053
+     *   (no staged files left — clean!)
      */
-    FILE* fp = fopen(STAGING_FILE, "w");
+    char text[128];
+    size_t len = staging_root_text(tree, text, sizeof(text));
+    if (len == 0) {
+        return -1;
+    }
+
+    return wal_txn_replace(txn, STAGING_FILE, text, len);
+}
+
+
+/*
+ * FUNCTION: sync_objects
+ * ──────────────────────
+ * The WAL record names our blobs and trees. Once it is durable,
+ * recovery will redo the commit — so every object it points at
+ * must be on disk FIRST, or a crash leaves a branch pointing at
+ * a tree whose files are gone.
+ *
+ * Trees are already synced by tree_write (write_file_atomic).
+ * Blobs were written by "mygit add", maybe long ago and maybe by
+ * an older mygit: sync each one (cheap when it is already clean)
+ * and the objects folder that holds their names.
+ *
+ * RETURNS: 0 → Success, -1 → an object could not be synced
+ */
+static int sync_objects(const StagedFile* staged) {
+    for (const StagedFile* f = staged; f; f = f->next) {
+        char blob_path[MAX_PATH];
+        snprintf(blob_path, sizeof(blob_path), "%s/%lu.blob", OBJECTS_DIR, f->hash);
+        if (sync_path(blob_path) != 0) {
+            return -1;
+        }
+    }
+    return sync_path(OBJECTS_DIR);
+}
 
-    if (fp) {
-        fprintf(fp, "# MyGit Staging Area\n");
-        fclose(fp);
+
+/*
+ * FUNCTION: commit_attempt
+ * ────────────────────────
+ * ONE try at putting the commit on top of its branch.
+ *
+ * THE RACE WE GUARD AGAINST:
+ *   Two "mygit commit"s on the same branch at once both read
+ *   "main = 5" and both want to become #6's parent... one of the
+ *   two commits would silently vanish from the branch.
+ *
+ * HOW?
+ *   1. Read the branch tip → our parent, build our tree on it
+ *      and sync the objects (no locks held: this is the slow part)
+ *   2. Lock commits.dat → nobody else can take the next id
+ *   3. Lock refs/<branch> and CHECK it still says <parent>
+ *      (compare-and-swap, see refs.c). If it moved, give up
+ *      this try — the caller simply starts over.
+ *   4. Commit record + new ref + empty staging area go into ONE
+ *      write-ahead-log record (wal.c) — the objects it refers
+ *      to are already on disk by then (sync_objects)
+ *   5. Update the caches, unlock
+ *
+ * Locks are always taken in that order (staging.dat — already
+ * held by mygit_commit — then commits.dat, then the ref), so two
+ * committers can't deadlock.
+ *
+ * WHY IS A RETRY CHEAP?
+ *   Tree objects are content-addressed: rebuilding on the new
+ *   parent re-uses every object already written and only writes
+ *   the few directories that really differ.
+ *
+ * RETURNS:
+ *    0                → committed, commit->id / parent_id filled in
+ *    REF_TXN_CONFLICT → the branch moved under us, try again
+ *   -1                → real error (message already printed)
+ */
+static int commit_attempt(Commit* commit, StagedFile* staged) {
+
+    /* 1. Parent + tree */
+    int last_id = get_last_commit_id_on_branch(commit->branch);
+    commit->parent_id = last_id > 0 ? last_id : -1;
+
+    unsigned long parent_tree = last_id > 0 ? commit_root_tree(last_id) : 0;
+
+    if (tree_build_commit(parent_tree, staged, &commit->tree) != 0) {
+        printf(RED "✗ Failed to write tree objects\n" RESET);
+        return -1;
     }
+    if (sync_objects(staged) != 0) {
+        printf(RED "✗ Could not sync the objects of this commit\n" RESET);
+        return -1;
+    }
+
+    /* 2. Our id — re-read the graph, another process may have
+     *    committed since we started. A commit that crashed after
+     *    logging itself is finished first (wal.c): its id is taken. */
+    if (lockfile_acquire(COMMITS_FILE) != 0) {
+        return -1;
+    }
+    if (wal_recover() != 0) {
+        printf(RED "✗ Could not finish an interrupted commit\n" RESET);
+        lockfile_release(COMMITS_FILE);
+        return -1;
+    }
+    graph_load();
+    commit->id = get_next_commit_id();
+
+    /* 3. Compare-and-swap the branch */
+    char reason[MAX_MESSAGE + 20];
+    snprintf(reason, sizeof(reason), "commit%s: %s",
+             last_id > 0 ? "" : " (initial)", commit->message);
+
+    RefTxn refs;
+    ref_txn_init(&refs);
+    ref_txn_update(&refs, commit->branch, last_id, commit->id, reason);
+
+    int rc = ref_txn_lock(&refs);
+    if (rc != 0) {
+        ref_txn_free(&refs);
+        lockfile_release(COMMITS_FILE);
+        return rc;
+    }
+
+    /* 4. All three changes, all or nothing */
+    WalTxn txn;
+    wal_txn_init(&txn);
+
+    if (save_commit(commit, &txn) != 0
+        || ref_txn_queue(&refs, &txn) != 0
+        || clear_staging_area(&txn, commit->tree) != 0) {
+        printf(RED "✗ Failed to save commit\n" RESET);
+        rc = -1;
+    } else {
+        rc = wal_commit(&txn);
+    }
+
+    /*
+     * 5. Record "commit #id lives at byte <offset>" in commits.idx,
+     *    and keep the binary commit-graph, time index and message
+     *    index in step with commits.dat. All are only caches, so a
+     *    failure here is not fatal — the next run rebuilds them.
+     */
+    if (rc == 0) {
+        if (txn.append_offset >= 0) {
+            commit_index_append(commit->id, (uint64_t)txn.append_offset);
+        }
+        graph_append(commit);
+        time_index_append(commit->id, commit->time);
+        msgindex_add(commit->id, commit->message);
+    }
+
+    wal_txn_free(&txn);
+    ref_txn_free(&refs);
+    lockfile_release(COMMITS_FILE);
+    return rc;
 }
 
 
@@ -496,10 +506,32 @@ int mygit_commit(const char* message) {
      * 
      * Like going to checkout with an empty cart.
      * The cashier says: "You have nothing to buy!"
+     * 
+     * The staging area stays LOCKED from here until the commit
+     * has emptied it: a "mygit add" slipping in between would be
+     * wiped out along with the files we actually committed.
+     *
+     * Not after "mygit checkout <commit-id>": the working folder
+     * shows that old commit, but ours would go on the branch tip.
      */
+    if (lockfile_acquire(STAGING_FILE) != 0) {
+        return -1;
+    }
+
+    int detached = get_detached_commit();
+    if (detached > 0) {
+        char branch[MAX_BRANCH_NAME];
+        lockfile_release(STAGING_FILE);
+        printf(RED "✗ You checked out commit #%d, not a branch\n" RESET, detached);
+        printf("  Go back first with: mygit checkout %s\n",
+               get_current_branch(branch, sizeof(branch)));
+        return -1;
+    }
+
     int staged_count = count_staged_files();
 
     if (staged_count == 0) {
+        lockfile_release(STAGING_FILE);
         printf(YELLOW "⚠ Nothing to commit!\n" RESET);
         printf("  Stage files first with: mygit add <filename>\n");
         return -1;
@@ -519,20 +551,7 @@ int mygit_commit(const char* message) {
 
     /*
      * ──────────────────────────────────
-     * STEP 3: Fill in the commit ID
-     * ──────────────────────────────────
-     * 
-     * Each commit gets a unique number.
-     * First commit = 1, second = 2, etc.
-     * 
-     * get_next_commit_id reads existing commits
-     * and returns max_id + 1
-     */
-    new_commit.id = get_next_commit_id();
-
-    /*
-     * ──────────────────────────────────
-     * STEP 4: Fill in the message
+     * STEP 3: Fill in the message
      * ──────────────────────────────────
      * 
      * Copy the user's message into our struct.
@@ -546,8 +565,12 @@ int mygit_commit(const char* message) {
      * Like filling a glass:
      *   strcpy  → keeps pouring even if glass is full (overflows!)
      *   strncpy → stops pouring when glass is full (safe!)
+     * 
+     * The struct only holds a POINTER to the text, so the
+     * glass itself is this local buffer.
      */
-    strncpy(new_commit.message, message, MAX_MESSAGE - 1);
+    char message_text[MAX_MESSAGE];
+    strncpy(message_text, message, MAX_MESSAGE - 1);
 
     /*
      * strncpy has a quirk: it might NOT add '\0' at the end
@@ -556,67 +579,53 @@ int mygit_commit(const char* message) {
      * So we MANUALLY add '\0' at the last position.
      * Better safe than sorry!
      */
-    new_commit.message[MAX_MESSAGE - 1] = '\0';
+    message_text[MAX_MESSAGE - 1] = '\0';
+    new_commit.message = message_text;
 
     /*
      * ──────────────────────────────────
-     * STEP 5: Fill in the timestamp
+     * STEP 4: Fill in the timestamp
      * ──────────────────────────────────
      * 
-     * Record WHEN this commit was made.
-     * get_timestamp fills the buffer with current date/time.
+     * Record WHEN this commit was made, as seconds since
+     * 1970 — a plain number is easy to compare and sort —
+     * plus our UTC offset, so "14:30" still reads 14:30 for
+     * someone in another timezone.
+     * format_timestamp turns it into text when we print it.
      */
-    get_timestamp(new_commit.timestamp, sizeof(new_commit.timestamp));
+    new_commit.time = time(NULL);
+    new_commit.tz_offset = local_tz_offset(new_commit.time);
 
     /*
      * ──────────────────────────────────
-     * STEP 6: Fill in the branch name
+     * STEP 5: Fill in the branch name
      * ──────────────────────────────────
      * 
      * Read the HEAD file to know which branch we're on.
      * Usually "main" unless user created other branches.
      */
-    get_current_branch(new_commit.branch, sizeof(new_commit.branch));
+    char branch_name[MAX_BRANCH_NAME];
+    get_current_branch(branch_name, sizeof(branch_name));
+    new_commit.branch = branch_name;
 
     /*
      * ──────────────────────────────────
-     * STEP 7: Fill in the parent ID
+     * STEP 6: Read the staged files
      * ──────────────────────────────────
      * 
-     * THIS IS THE LINKED LIST POINTER!
+     * Read staging.dat into a linked list. They get laid over
+     * the PARENT's snapshot:
      * 
-     * "Who was the last commit on this branch?"
-     * That commit becomes our PARENT.
-     * 
-     * If this is the FIRST commit, parent = -1
-     * (like NULL in a linked list)
+     *   parent tree + staged files = new root tree
      * 
-     * If last commit was #3, parent = 3
-     * (our new commit points BACK to #3)
+     * Files we didn't touch keep pointing at the parent's
+     * objects, so every commit describes the WHOLE project.
      */
-    int last_id = get_last_commit_id_on_branch(new_commit.branch);
+    int file_count;
+    StagedFile* staged = read_staged_files(&file_count);
 
-    if (last_id == 0) {
-        new_commit.parent_id = -1;   /* First commit ever! No parent. */
-    } else {
-        new_commit.parent_id = last_id;   /* Point to previous commit */
-    }
-
-    /*
-     * ──────────────────────────────────
-     * STEP 8: Fill in the file list
-     * ──────────────────────────────────
-     * 
-     * Read staged files from staging.dat
-     * and put them into our commit struct.
-     * 
-     * Remember: we pass a POINTER (&new_commit)
-     * so the function can MODIFY our struct!
-     * 
-     * Without &: function gets a COPY → changes are lost
-     * With &:    function gets the ADDRESS → changes stick!
-     */
-    if (read_staged_files(&new_commit) != 0) {
+    if (!staged) {
+        lockfile_release(STAGING_FILE);
         printf(RED "✗ Failed to read staging area\n" RESET);
         return -1;
     }
@@ -634,40 +643,44 @@ int mygit_commit(const char* message) {
 
     /*
      * ──────────────────────────────────
-     * STEP 9: Save the commit!
+     * STEP 7: Link it in — and save it
      * ──────────────────────────────────
      * 
-     * Write everything to commits.dat
-     * This is like inserting a node into our linked list file!
-     */
-    if (save_commit(&new_commit) != 0) {
-        printf(RED "✗ Failed to save commit\n" RESET);
-        return -1;
-    }
-
-    /*
-     * ──────────────────────────────────
-     * STEP 10: Update the branch pointer
-     * ──────────────────────────────────
+     * THIS IS THE LINKED LIST POINTER!
      * 
-     * Tell the branch: "Your latest commit is now #X"
+     * "Who was the last commit on this branch?"
+     * That commit becomes our PARENT.
      * 
-     * refs/main: "1" → refs/main: "2"
-     */
-    update_branch_ref(new_commit.branch, new_commit.id);
-
-    /*
-     * ──────────────────────────────────
-     * STEP 11: Clear the staging area
-     * ──────────────────────────────────
+     * If this is the FIRST commit, parent = -1
+     * (like NULL in a linked list)
+     * 
+     * If last commit was #3, parent = 3
+     * (our new commit points BACK to #3)
      * 
-     * Shopping cart is now EMPTY after checkout!
+     * commit_attempt reads the parent, gives us our id and
+     * saves everything in one go. If someone else committed on
+     * this branch at the same moment, our parent is stale:
+     * nothing was written, so we just try again on top of
+     * their commit.
      */
-    clear_staging_area();
+    int rc = REF_TXN_CONFLICT;
+    for (int attempt = 0; attempt < COMMIT_ATTEMPTS && rc == REF_TXN_CONFLICT; attempt++) {
+        rc = commit_attempt(&new_commit, staged);
+    }
+    lockfile_release(STAGING_FILE);
+
+    if (rc != 0) {
+        if (rc == REF_TXN_CONFLICT) {
+            printf(RED "✗ Branch '%s' kept changing, commit not saved\n" RESET, new_commit.branch);
+            printf("  Try again in a moment.\n");
+        }
+        free_staged_files(staged);
+        return -1;
+    }
 
     /*
      * ──────────────────────────────────
-     * STEP 12: Tell the user!
+     * STEP 8: Tell the user!
      * ──────────────────────────────────
      * 
      * Show a nice summary of what was committed.
@@ -709,18 +722,23 @@ int mygit_commit(const char* message) {
 
     printf(CYAN "  │" RESET " Message: %-30s" CYAN "│\n" RESET, new_commit.message);
     printf(CYAN "  │" RESET " Branch:  %-30s" CYAN "│\n" RESET, new_commit.branch);
-    printf(CYAN "  │" RESET " Time:    %-30s" CYAN "│\n" RESET, new_commit.timestamp);
+    char time_text[64];
+    format_timestamp(new_commit.time, time_text, sizeof(time_text));
+
+    printf(CYAN "  │" RESET " Time:    %-30s" CYAN "│\n" RESET, time_text);
     printf(CYAN "  │" RESET " Parent:  %-30d" CYAN "│\n" RESET, new_commit.parent_id);
 
-    printf(CYAN "  │" RESET " Files:   %-30d" CYAN "│\n" RESET, new_commit.file_count);
+    printf(CYAN "  │" RESET " Files:   %-30d" CYAN "│\n" RESET, file_count);
 
-    /* List each file */
-    for (int i = 0; i < new_commit.file_count; i++) {
-        printf(CYAN "  │" RESET "   → %-35s" CYAN "│\n" RESET, new_commit.filenames[i]);
+    /* List each file (walk the linked list) */
+    for (StagedFile* f = staged; f; f = f->next) {
+        printf(CYAN "  │" RESET "   → %-35s" CYAN "│\n" RESET, f->filename);
     }
 
     printf(CYAN "  └─────────────────────────────────────────┘\n" RESET);
     printf("\n");
 
+    free_staged_files(staged);
+
     return 0;   /* Success! */
 }
\ No newline at end of file
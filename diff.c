@@ -1,6 +1,1592 @@
+/*
+ * ============================================
+ *          MYGIT - Diff
+ *          "mygit diff", "log --stat"
+ * ============================================
+ *
+ * PURPOSE:
+ *   Show what changed in the files since they were last added
+ *   (or between staging and HEAD, or two commits):
+ *
+ *     --- a/parser.c
+ *     +++ b/parser.c
+ *     @@ -10,7 +10,8 @@
+ *      int parse(void) {
+ *     -    return 0;
+ *     +    check();
+ *     +    return 1;
+ *      }
+ *
+ * THE PROBLEM:
+ *   Find the LONGEST COMMON SUBSEQUENCE of the two files' lines
+ *   — the lines we keep. Everything else was removed (-) or
+ *   added (+). Lines are never truncated and files can have any
+ *   number of them: both sides are mapped and cut into views.
+ *
+ * MYERS' ALGORITHM, O(N·D):
+ *   Picture a grid: moving right deletes a line of the old
+ *   file, moving down inserts a line of the new one, and where
+ *   lines are equal we slide diagonally for free. The fewest
+ *   edits D is the shortest path to the bottom-right corner.
+ *   Myers searches it by number of edits, so a small change in
+ *   a huge file is found quickly.
+ *
+ * LINEAR SPACE:
+ *   Remembering every step of that search costs O(D²) memory.
+ *   Instead we search from BOTH corners at once until the two
+ *   searches meet in the "middle snake". That snake is on some
+ *   shortest path, so we split the grid there and solve the two
+ *   halves the same way. Only two vectors of diagonals are kept.
+ *
+ * LINES ARE NUMBERS:
+ *   Both files are split and interned by text.c first: every
+ *   distinct line gets an id, the same in both files. All the
+ *   algorithms below only ever compare ints.
+ *
+ * THREE SHORTCUTS:
+ *   1. Lines the same at the start and end are skipped.
+ *   2. A line that doesn't occur in the other file at all can't
+ *      be kept, so it is marked changed right away and the
+ *      search never sees it. Two unrelated files cost O(N).
+ *   3. If a search needs more than DIFF_COST_LIMIT edits, we
+ *      stop looking for THE best split and take the furthest
+ *      point reached. The diff is still correct — just not
+ *      always the smallest — and pathological inputs can't eat
+ *      O(N²) time: 1M random lines made of 4 different ones
+ *      take ~3 s and come out 2% bigger than the minimum.
+ *
+ * BINARY FILES:
+ *   If either side looks binary (text.c), lines mean nothing.
+ *   The two files are compared byte for byte instead, and the
+ *   changed byte RANGES are listed — see diff_bytes.
+ *
+ * --diff-algorithm=patience|histogram:
+ *   The SMALLEST diff isn't always the most readable one: Myers
+ *   happily matches up blank lines and lone braces from two
+ *   unrelated functions. Patience and histogram first match
+ *   lines that are rare in the file, then diff the pieces in
+ *   between — see patience_diff and histogram_diff below.
+ */
+
 #include "mygit.h"
+#include <limits.h>          // LONG_MAX
+
+#define DIFF_CONTEXT     3           // unchanged lines around a change
+#define DIFF_COST_LIMIT  256         // see shortcut 3
+#define BINARY_MAX_RANGES 16         // byte ranges listed per binary file
+#define BINARY_GAP       32          // this many equal bytes end a range
+
+/* One file being compared */
+typedef struct DiffSide {
+    MappedFile file;
+    TextLine* lines;                 // see text.c
+    long count;
+    char* changed;                   // changed[i] → line i removed / added
+    int no_eol;                      // last line has no '\n'
+} DiffSide;
+
+/* Binary files: old bytes [a, a + del) became new bytes [b, b + ins) */
+typedef struct ByteRange {
+    size_t a, del;
+    size_t b, ins;
+} ByteRange;
+
+typedef struct DiffResult {
+    DiffSide side[2];                // [0] = old, [1] = new
+    LineInterner interner;           // line ids, shared by both sides
+    int binary;                      // compared as bytes, not lines
+    ByteRange ranges[BINARY_MAX_RANGES];
+    long range_count;                // all found (only the first are kept)
+} DiffResult;
+
+
+/* Both sides are interned together: same text ↔ same id */
+static int same_line(const TextLine* a, const TextLine* b) {
+    return a->id == b->id;
+}
+
+/* Where id goes in a power-of-two table (Fibonacci hashing) */
+static size_t id_slot(int id, size_t mask) {
+    return ((size_t)(unsigned)id * 2654435761u) & mask;
+}
+
+
+/* ─────────── the Myers search ─────────── */
+
+/*
+ * The search runs over the lines that survived shortcut 2:
+ * ida / idb are their ids, packed tight for the inner loop,
+ * and ia / ib map positions back to real line numbers.
+ */
+typedef struct MyersSearch {
+    const int* ida;
+    const int* idb;
+    const long* ia;
+    const long* ib;
+    char* del;                       // = side[0].changed
+    char* ins;                       // = side[1].changed
+    long* fd;                        // furthest x per diagonal, forward
+    long* bd;                        // ... and backward
+    long half;                       // fd/bd cover diagonals mid ± half
+    long cost_limit;
+} MyersSearch;
+
+#define SAME(s, x, y) ((s)->ida[x] == (s)->idb[y])
+
+/* Diagonal k of the forward / backward vector (k = x - y) */
+#define FD(k) s->fd[(k) - fmid + s->half]
+#define BD(k) s->bd[(k) - bmid + s->half]
+
+
+/*
+ * FUNCTION: middle_snake
+ * ──────────────────────
+ * Searches forward from (xoff, yoff) and backward from
+ * (xlim, ylim), one edit at a time each, until the two meet.
+ * The meeting point splits the box into two smaller ones.
+ *
+ * The box has already lost its common first and last lines,
+ * so it needs at least one edit and the split is never a corner.
+ */
+static void middle_snake(const MyersSearch* s, long xoff, long xlim, long yoff, long ylim,
+                         long* split_x, long* split_y) {
+    long dmin = xoff - ylim;         // lowest / highest diagonal in the box
+    long dmax = xlim - yoff;
+    long fmid = xoff - yoff;         // where each search starts
+    long bmid = xlim - ylim;
+    long fmin = fmid, fmax = fmid;
+    long bmin = bmid, bmax = bmid;
+    int odd = (fmid - bmid) & 1;     // which search can see the meeting
+
+    FD(fmid) = xoff;
+    BD(bmid) = xlim;
+
+    for (long d = 1;; d++) {
+
+        /* One more edit forward: widen the range by a diagonal */
+        if (fmin > dmin) FD(--fmin - 1) = -1; else fmin++;
+        if (fmax < dmax) FD(++fmax + 1) = -1; else fmax--;
+
+        for (long k = fmax; k >= fmin; k -= 2) {
+            long from_left = FD(k - 1);
+            long from_above = FD(k + 1);
+            long x = from_left >= from_above ? from_left + 1 : from_above;
+            long y = x - k;
+
+            while (x < xlim && y < ylim && SAME(s, x, y)) {
+                x++;
+                y++;
+            }
+            FD(k) = x;
+
+            if (odd && bmin <= k && k <= bmax && BD(k) <= x) {
+                *split_x = x;
+                *split_y = y;
+                return;
+            }
+        }
+
+        /* ... and one more backward */
+        if (bmin > dmin) BD(--bmin - 1) = LONG_MAX; else bmin++;
+        if (bmax < dmax) BD(++bmax + 1) = LONG_MAX; else bmax--;
+
+        for (long k = bmax; k >= bmin; k -= 2) {
+            long from_left = BD(k - 1);
+            long from_above = BD(k + 1);
+            long x = from_left < from_above ? from_left : from_above - 1;
+            long y = x - k;
+
+            while (x > xoff && y > yoff && SAME(s, x - 1, y - 1)) {
+                x--;
+                y--;
+            }
+            BD(k) = x;
+
+            if (!odd && fmin <= k && k <= fmax && x <= FD(k)) {
+                *split_x = x;
+                *split_y = y;
+                return;
+            }
+        }
+
+        /*
+         * Too expensive (shortcut 3): split at whichever search
+         * got furthest — forward maximises x + y, backward
+         * minimises it.
+         */
+        if (d >= s->cost_limit) {
+            long fxy = -1, fx = xoff;
+            for (long k = fmax; k >= fmin; k -= 2) {
+                long x = FD(k) < xlim ? FD(k) : xlim;
+                long y = x - k;
+                if (y > ylim) { x = ylim + k; y = ylim; }
+                if (x + y > fxy) { fxy = x + y; fx = x; }
+            }
+
+            long bxy = LONG_MAX, bx = xlim;
+            for (long k = bmax; k >= bmin; k -= 2) {
+                long x = BD(k) > xoff ? BD(k) : xoff;
+                long y = x - k;
+                if (y < yoff) { x = yoff + k; y = yoff; }
+                if (x + y < bxy) { bxy = x + y; bx = x; }
+            }
+
+            if ((xlim + ylim) - bxy < fxy - (xoff + yoff)) {
+                *split_x = fx;
+                *split_y = fxy - fx;
+            } else {
+                *split_x = bx;
+                *split_y = bxy - bx;
+            }
+            return;
+        }
+    }
+}
+
+#undef FD
+#undef BD
+
+
+/*
+ * FUNCTION: myers_compare
+ * ───────────────────────
+ * Marks the changed lines inside the box [xoff, xlim) × [yoff, ylim).
+ * The smaller half of each split is solved by recursion and the
+ * larger one by the loop, so the stack stays O(log N) deep.
+ */
+static void myers_compare(const MyersSearch* s, long xoff, long xlim, long yoff, long ylim) {
+    for (;;) {
+        while (xoff < xlim && yoff < ylim && SAME(s, xoff, yoff)) {
+            xoff++;
+            yoff++;
+        }
+        while (xlim > xoff && ylim > yoff && SAME(s, xlim - 1, ylim - 1)) {
+            xlim--;
+            ylim--;
+        }
+
+        if (xoff == xlim || yoff == ylim) {
+            for (long x = xoff; x < xlim; x++) s->del[s->ia[x]] = 1;
+            for (long y = yoff; y < ylim; y++) s->ins[s->ib[y]] = 1;
+            return;
+        }
+
+        long x, y;
+        middle_snake(s, xoff, xlim, yoff, ylim, &x, &y);
+
+        if ((x - xoff) + (y - yoff) < (xlim - x) + (ylim - y)) {
+            myers_compare(s, xoff, x, yoff, y);
+            xoff = x;
+            yoff = y;
+        } else {
+            myers_compare(s, x, xlim, y, ylim);
+            xlim = x;
+            ylim = y;
+        }
+    }
+}
+
+
+/*
+ * FUNCTION: keep_matched
+ * ──────────────────────
+ * Shortcut 2. Marks the lines of `side` whose id never occurs
+ * in `other` as changed, and lists the rest: their positions
+ * in `kept`, their ids in `ids`.
+ *
+ * RETURNS: number of kept lines, -1 if out of memory
+ */
+static long keep_matched(DiffSide* side, const DiffSide* other, long* kept, int* ids) {
+    size_t size = 16;
+    while (size < (size_t)other->count * 2) size *= 2;
+
+    /* An open-addressing set of the other side's ids
+     * (stored + 1, so that 0 can mean an empty slot) */
+    int* seen = calloc(size, sizeof(int));
+    if (!seen) {
+        return -1;
+    }
+    for (long i = 0; i < other->count; i++) {
+        int key = other->lines[i].id + 1;
+        size_t slot = id_slot(key, size - 1);
+        while (seen[slot] != 0 && seen[slot] != key) slot = (slot + 1) & (size - 1);
+        seen[slot] = key;
+    }
+
+    long n = 0;
+    for (long i = 0; i < side->count; i++) {
+        int key = side->lines[i].id + 1;
+        size_t slot = id_slot(key, size - 1);
+        while (seen[slot] != 0 && seen[slot] != key) slot = (slot + 1) & (size - 1);
+
+        if (seen[slot] == key) {
+            kept[n] = i;
+            ids[n] = key - 1;
+            n++;
+        } else {
+            side->changed[i] = 1;
+        }
+    }
+
+    free(seen);
+    return n;
+}
+
+
+/* ─────────── running an algorithm ─────────── */
+
+/* Lines [from, to) of a side, as a side of its own (a view) */
+static DiffSide side_slice(const DiffSide* side, long from, long to) {
+    DiffSide slice = *side;
+    slice.lines += from;
+    slice.changed += from;
+    slice.count = to - from;
+    return slice;
+}
+
+/* Shortcut 1: drops the lines both sides start and end with */
+static void trim_common(DiffSide* a, DiffSide* b) {
+    long lo = 0;
+    while (lo < a->count && lo < b->count && same_line(&a->lines[lo], &b->lines[lo])) {
+        lo++;
+    }
+    long a_end = a->count, b_end = b->count;
+    while (a_end > lo && b_end > lo && same_line(&a->lines[a_end - 1], &b->lines[b_end - 1])) {
+        a_end--;
+        b_end--;
+    }
+    *a = side_slice(a, lo, a_end);
+    *b = side_slice(b, lo, b_end);
+}
+
+/* If one side is empty, everything on the other one changed */
+static int all_changed(DiffSide* a, DiffSide* b) {
+    if (a->count > 0 && b->count > 0) {
+        return 0;
+    }
+    memset(a->changed, 1, a->count);
+    memset(b->changed, 1, b->count);
+    return 1;
+}
+
+
+/*
+ * FUNCTION: myers_diff
+ * ────────────────────
+ * Marks the changed lines of two sides (or slices of them).
+ * RETURNS: 0 → Success, -1 → out of memory
+ */
+static int myers_diff(DiffSide* a, DiffSide* b) {
+    trim_common(a, b);
+    if (all_changed(a, b)) {
+        return 0;
+    }
+
+    /* Shortcut 2 */
+    long* ia = malloc((a->count + 1) * sizeof(long));
+    long* ib = malloc((b->count + 1) * sizeof(long));
+    int* ida = malloc((a->count + 1) * sizeof(int));
+    int* idb = malloc((b->count + 1) * sizeof(int));
+    long n = ia && ida ? keep_matched(a, b, ia, ida) : -1;
+    long m = ib && idb && n >= 0 ? keep_matched(b, a, ib, idb) : -1;
+
+    MyersSearch s;
+    s.ida = ida;
+    s.idb = idb;
+    s.ia = ia;
+    s.ib = ib;
+    s.del = a->changed;
+    s.ins = b->changed;
+    s.cost_limit = DIFF_COST_LIMIT;
+
+    /* A search never needs more than (n + m + 1) / 2 edits */
+    s.half = ((n + m + 1) / 2 < s.cost_limit ? (n + m + 1) / 2 : s.cost_limit) + 2;
+    s.fd = m >= 0 ? malloc((2 * s.half + 1) * sizeof(long)) : NULL;
+    s.bd = m >= 0 ? malloc((2 * s.half + 1) * sizeof(long)) : NULL;
+
+    int rc = -1;
+    if (s.fd && s.bd) {
+        myers_compare(&s, 0, n, 0, m);
+        rc = 0;
+    }
+
+    free(s.fd);
+    free(s.bd);
+    free(ia);
+    free(ib);
+    free(ida);
+    free(idb);
+    return rc;
+}
+
+
+/*
+ * LINE TABLE
+ * ──────────
+ * Patience and histogram ask "how often does this line occur,
+ * and where?". Lines are found by their id in an
+ * open-addressing table sized for the part being diffed.
+ */
+typedef struct LineSlot {
+    int key;                         // line id + 1, 0 → empty slot
+    long count_a;                    // occurrences in the old side
+    long count_b;                    // ... and in the new one
+    long last_a;                     // index of the latest occurrence
+    long last_b;
+} LineSlot;
+
+typedef struct LineTable {
+    LineSlot* slots;
+    size_t mask;
+} LineTable;
+
+static int table_init(LineTable* t, long lines) {
+    size_t size = 16;
+    while (size < (size_t)lines * 2) size *= 2;
+    t->slots = calloc(size, sizeof(LineSlot));
+    t->mask = size - 1;
+    return t->slots ? 0 : -1;
+}
+
+/* The slot of `line` — a new, zeroed one if it isn't there yet */
+static LineSlot* table_slot(LineTable* t, const TextLine* line) {
+    int key = line->id + 1;
+    size_t i = id_slot(key, t->mask);
+    while (t->slots[i].key != 0 && t->slots[i].key != key) {
+        i = (i + 1) & t->mask;
+    }
+    t->slots[i].key = key;
+    return &t->slots[i];
+}
+
+/* The slot of `line`, or NULL if it isn't there */
+static LineSlot* table_find(const LineTable* t, const TextLine* line) {
+    int key = line->id + 1;
+    size_t i = id_slot(key, t->mask);
+    while (t->slots[i].key != 0) {
+        if (t->slots[i].key == key) {
+            return &t->slots[i];
+        }
+        i = (i + 1) & t->mask;
+    }
+    return NULL;
+}
+
+
+/*
+ * FUNCTION: patience_diff
+ * ───────────────────────
+ * Lines that occur EXACTLY ONCE in both files — a function's
+ * signature, a distinctive comment — are almost surely the
+ * "same" line. Patience diff:
+ *
+ *   1. pairs up those unique lines,
+ *   2. keeps the longest run of pairs that is in order in both
+ *      files (the patience-sorting card game finds it in
+ *      O(k log k)) — these are the anchors,
+ *   3. diffs the gaps between anchors the same way.
+ *
+ * A gap without unique lines goes to Myers. Blocks of braces
+ * and blank lines can't glue unrelated code together, so moved
+ * functions read much better.
+ *
+ * RETURNS: 0 → Success, -1 → out of memory
+ */
+static int patience_diff(DiffSide* a, DiffSide* b) {
+    trim_common(a, b);
+    if (all_changed(a, b)) {
+        return 0;
+    }
+
+    LineTable t;
+    if (table_init(&t, a->count + b->count) != 0) {
+        return -1;
+    }
+    for (long i = 0; i < a->count; i++) {
+        LineSlot* s = table_slot(&t, &a->lines[i]);
+        s->count_a++;
+        s->last_a = i;
+    }
+    for (long j = 0; j < b->count; j++) {
+        LineSlot* s = table_slot(&t, &b->lines[j]);
+        s->count_b++;
+        s->last_b = j;
+    }
+
+    /* STEP 1: the unique pairs, in the old file's order */
+    long* ua = malloc(a->count * sizeof(long));
+    long* ub = malloc(a->count * sizeof(long));
+    long* tops = malloc(a->count * sizeof(long));
+    long* prev = malloc(a->count * sizeof(long));
+    if (!ua || !ub || !tops || !prev) {
+        free(t.slots);
+        free(ua); free(ub); free(tops); free(prev);
+        return -1;
+    }
+
+    long k = 0;
+    for (long i = 0; i < a->count; i++) {
+        const LineSlot* s = table_find(&t, &a->lines[i]);
+        if (s->count_a == 1 && s->count_b == 1) {
+            ua[k] = i;
+            ub[k] = s->last_b;
+            k++;
+        }
+    }
+    free(t.slots);
+
+    int rc;
+    if (k == 0) {
+        rc = myers_diff(a, b);
+    } else {
+        /*
+         * STEP 2: deal the pairs onto piles by their position in
+         * the new file: each goes on the leftmost pile whose top
+         * is higher, remembering the top of the pile to its left.
+         * The number of piles is the longest in-order run.
+         */
+        long piles = 0;
+        for (long p = 0; p < k; p++) {
+            long lo = 0, hi = piles;
+            while (lo < hi) {
+                long mid = (lo + hi) / 2;
+                if (ub[tops[mid]] < ub[p]) lo = mid + 1; else hi = mid;
+            }
+            prev[p] = lo > 0 ? tops[lo - 1] : -1;
+            tops[lo] = p;
+            if (lo == piles) piles++;
+        }
+
+        /* Follow the links back from the last pile → the anchors */
+        long n = piles;
+        for (long p = tops[piles - 1]; p >= 0; p = prev[p]) {
+            tops[--n] = p;
+        }
+
+        /* STEP 3: the gaps between anchors (and after the last) */
+        long pa = 0, pb = 0;
+        rc = 0;
+        for (n = 0; n <= piles && rc == 0; n++) {
+            long ea = n < piles ? ua[tops[n]] : a->count;
+            long eb = n < piles ? ub[tops[n]] : b->count;
+            DiffSide gap_a = side_slice(a, pa, ea);
+            DiffSide gap_b = side_slice(b, pb, eb);
+            rc = patience_diff(&gap_a, &gap_b);
+            pa = ea + 1;
+            pb = eb + 1;
+        }
+    }
+
+    free(ua);
+    free(ub);
+    free(tops);
+    free(prev);
+    return rc;
+}
+
+
+/*
+ * FUNCTION: histogram_diff
+ * ────────────────────────
+ * Patience for files where few lines are unique (JGit's
+ * algorithm, also in git). Instead of "occurs once", it prefers
+ * the RAREST line:
+ *
+ *   1. count every line of the old file (a histogram),
+ *   2. for each line of the new file, try every old occurrence
+ *      (lines rarer than the best so far only) and grow the
+ *      match up and down as far as both files agree,
+ *   3. keep the longest match made of the rarest lines, and
+ *      diff what is above and below it the same way.
+ *
+ * Lines seen more than HISTOGRAM_MAX_CHAIN times are never tried;
+ * if nothing is left, that part goes to Myers.
+ *
+ * RETURNS: 0 → Success, -1 → out of memory
+ */
+#define HISTOGRAM_MAX_CHAIN 64
+
+static int histogram_diff(DiffSide* a, DiffSide* b) {
+    for (;;) {
+        trim_common(a, b);
+        if (all_changed(a, b)) {
+            return 0;
+        }
+
+        /* STEP 1: counts, and a chain of earlier occurrences */
+        LineTable t;
+        long* chain = malloc(a->count * sizeof(long));
+        long* count_at = malloc(a->count * sizeof(long));
+        if (!chain || !count_at || table_init(&t, a->count) != 0) {
+            free(chain);
+            free(count_at);
+            return -1;
+        }
+        for (long i = 0; i < a->count; i++) {
+            LineSlot* s = table_slot(&t, &a->lines[i]);
+            chain[i] = s->count_a > 0 ? s->last_a : -1;
+            s->count_a++;
+            s->last_a = i;
+        }
+        for (long i = 0; i < a->count; i++) {
+            count_at[i] = table_find(&t, &a->lines[i])->count_a;
+        }
+
+        /* STEP 2: the best match */
+        long best_a = 0, best_a_end = 0, best_b = 0, best_b_end = 0;
+        long best_count = HISTOGRAM_MAX_CHAIN + 1;
+        int found = 0;
+
+        for (long j = 0; j < b->count;) {
+            const LineSlot* s = table_find(&t, &b->lines[j]);
+            long next_j = j + 1;
+
+            if (s && s->count_a <= best_count) {
+                for (long i = s->last_a; i >= 0; i = chain[i]) {
+                    long as = i, ae = i + 1, bs = j, be = j + 1;
+                    long rarest = count_at[i];
+
+                    while (as > 0 && bs > 0 && same_line(&a->lines[as - 1], &b->lines[bs - 1])) {
+                        as--;
+                        bs--;
+                        if (count_at[as] < rarest) rarest = count_at[as];
+                    }
+                    while (ae < a->count && be < b->count && same_line(&a->lines[ae], &b->lines[be])) {
+                        if (count_at[ae] < rarest) rarest = count_at[ae];
+                        ae++;
+                        be++;
+                    }
+
+                    if (ae - as > best_a_end - best_a || rarest < best_count) {
+                        best_a = as;
+                        best_a_end = ae;
+                        best_b = bs;
+                        best_b_end = be;
+                        best_count = rarest;
+                        found = 1;
+                    }
+                    if (be > next_j) {
+                        next_j = be;         // lines inside a match: done
+                    }
+                }
+            }
+            j = next_j;
+        }
+
+        free(t.slots);
+        free(chain);
+        free(count_at);
+
+        if (!found) {
+            return myers_diff(a, b);
+        }
+
+        /*
+         * STEP 3: above and below the match. The smaller part is
+         * solved by recursion, the larger by the loop.
+         */
+        DiffSide above_a = side_slice(a, 0, best_a);
+        DiffSide above_b = side_slice(b, 0, best_b);
+        DiffSide below_a = side_slice(a, best_a_end, a->count);
+        DiffSide below_b = side_slice(b, best_b_end, b->count);
+
+        int rc;
+        if (above_a.count + above_b.count < below_a.count + below_b.count) {
+            rc = histogram_diff(&above_a, &above_b);
+            *a = below_a;
+            *b = below_b;
+        } else {
+            rc = histogram_diff(&below_a, &below_b);
+            *a = above_a;
+            *b = above_b;
+        }
+        if (rc != 0) {
+            return -1;
+        }
+    }
+}
+
+
+/*
+ * FUNCTION: diff_compute
+ * ──────────────────────
+ * Fills side[0].changed and side[1].changed. Lines not marked
+ * on either side are the common subsequence, in order.
+ *
+ * RETURNS: 0 → Success, -1 → out of memory
+ */
+static int diff_compute(DiffResult* r, DiffAlgorithm algorithm) {
+    DiffSide a = r->side[0];
+    DiffSide b = r->side[1];
+
+    switch (algorithm) {
+        case DIFF_PATIENCE:  return patience_diff(&a, &b);
+        case DIFF_HISTOGRAM: return histogram_diff(&a, &b);
+        default:             return myers_diff(&a, &b);
+    }
+}
+
+
+/* ─────────── loading both sides ─────────── */
+
+/* Cuts a mapped side into lines and numbers them (text.c) */
+static int side_split(DiffSide* side, LineInterner* interner) {
+    const char* data = side->file.data;
+    size_t size = side->file.size;
+
+    side->count = text_split_lines(data, size, &side->lines);
+    if (side->count < 0) {
+        side->count = 0;
+        return -1;
+    }
+    side->no_eol = size > 0 && data[size - 1] != '\n';
+
+    side->changed = calloc(side->count > 0 ? side->count : 1, 1);
+    if (!side->changed) {
+        return -1;
+    }
+    return interner_add(interner, side->lines, side->count);
+}
+
+/* Side `which` from a blob (hash 0 = no file → empty) */
+static int side_load_blob(DiffResult* r, int which, unsigned long hash) {
+    if (hash == 0) {
+        return 0;
+    }
+    char blob_path[MAX_PATH];
+    snprintf(blob_path, sizeof(blob_path), "%s/%lu.blob", OBJECTS_DIR, hash);
+    return map_file(blob_path, &r->side[which].file);
+}
+
+/* Side `which` from the working tree (missing → empty) */
+static int side_load_file(DiffResult* r, int which, const char* path) {
+    if (!file_exists(path)) {
+        return 0;
+    }
+    return map_file(path, &r->side[which].file);
+}
+
+/*
+ * FUNCTION: diff_split
+ * ────────────────────
+ * Cuts both loaded sides into lines. They go through the same
+ * interner, so equal lines get equal ids across the two files.
+ *
+ * RETURNS: 0 → Success, -1 → out of memory
+ */
+static int diff_split(DiffResult* r) {
+    if (side_split(&r->side[0], &r->interner) != 0) {
+        return -1;
+    }
+    return side_split(&r->side[1], &r->interner);
+}
 
-int mygit_diff(const char* filename) {
-    printf(YELLOW "🔍 [Coming Week 2] Will show diff for: %s\n" RESET, filename);
+/* Byte for byte the same? Then there is nothing to split */
+static int diff_same_bytes(const DiffResult* r) {
+    const MappedFile* a = &r->side[0].file;
+    const MappedFile* b = &r->side[1].file;
+    return a->size == b->size && memcmp(a->data, b->data, a->size) == 0;
+}
+
+static void diff_init(DiffResult* r) {
+    memset(r, 0, sizeof(*r));
+    for (int i = 0; i < 2; i++) {
+        r->side[i].file.data = "";
+    }
+    interner_init(&r->interner);
+}
+
+static void diff_free(DiffResult* r) {
+    for (int i = 0; i < 2; i++) {
+        free(r->side[i].lines);
+        free(r->side[i].changed);
+        unmap_file(&r->side[i].file);
+    }
+    interner_free(&r->interner);
+}
+
+
+/* ─────────── binary files ─────────── */
+
+static void add_range(DiffResult* r, size_t a, size_t del, size_t b, size_t ins) {
+    if (r->range_count < BINARY_MAX_RANGES) {
+        ByteRange* range = &r->ranges[r->range_count];
+        range->a = a;
+        range->del = del;
+        range->b = b;
+        range->ins = ins;
+    }
+    r->range_count++;
+}
+
+/*
+ * FUNCTION: diff_bytes
+ * ────────────────────
+ * The changed byte ranges of two binary files.
+ *
+ *   1. Skip the bytes equal at the start and at the end.
+ *   2. Same size in between (a patched firmware, retrained
+ *      weights): walk it and report each run of different
+ *      bytes. Runs less than BINARY_GAP equal bytes apart are
+ *      one range, so scattered edits don't make a huge list.
+ *   3. Different size in between: bytes were inserted or cut
+ *      somewhere, everything after is shifted, and byte-by-byte
+ *      comparing would find "all different" — the middle is
+ *      reported as ONE replaced range.
+ *
+ * Finding the next different byte is text_mismatch, 32 bytes
+ * per compare, so long equal stretches cost almost nothing.
+ */
+static void diff_bytes(DiffResult* r) {
+    const char* a = r->side[0].file.data;
+    const char* b = r->side[1].file.data;
+    size_t a_size = r->side[0].file.size;
+    size_t b_size = r->side[1].file.size;
+    size_t shorter = a_size < b_size ? a_size : b_size;
+
+    /* STEP 1: equal start and end */
+    size_t prefix = text_mismatch(a, b, shorter);
+    size_t suffix = 0;
+    size_t limit = shorter - prefix;
+    while (suffix + 8 <= limit
+           && memcmp(a + a_size - suffix - 8, b + b_size - suffix - 8, 8) == 0) {
+        suffix += 8;
+    }
+    while (suffix < limit && a[a_size - suffix - 1] == b[b_size - suffix - 1]) {
+        suffix++;
+    }
+
+    /* STEP 3: bytes inserted or removed */
+    if (a_size != b_size) {
+        add_range(r, prefix, a_size - suffix - prefix, prefix, b_size - suffix - prefix);
+        return;
+    }
+
+    /* STEP 2: same size — the runs of different bytes */
+    size_t end = a_size - suffix;
+    for (size_t pos = prefix; pos < end;) {
+        size_t start = pos + text_mismatch(a + pos, b + pos, end - pos);
+        if (start >= end) {
+            break;
+        }
+
+        size_t last = start;
+        for (size_t i = start + 1; i < end && i - last <= BINARY_GAP; i++) {
+            if (a[i] != b[i]) last = i;
+        }
+        add_range(r, start, last + 1 - start, start, last + 1 - start);
+        pos = last + 1;
+    }
+}
+
+
+/*
+ * FUNCTION: diff_run
+ * ──────────────────
+ * Compares two loaded sides the cheapest way that works:
+ *
+ *   byte-for-byte equal   → nothing to do (nothing is split)
+ *   either side binary    → byte ranges (diff_bytes)
+ *   text                  → lines, with `algorithm`
+ *
+ * RETURNS: 0 → Success, -1 → out of memory
+ */
+static int diff_run(DiffResult* r, DiffAlgorithm algorithm) {
+    if (diff_same_bytes(r)) {
+        return 0;
+    }
+
+    const MappedFile* a = &r->side[0].file;
+    const MappedFile* b = &r->side[1].file;
+    if (text_is_binary(a->data, a->size) || text_is_binary(b->data, b->size)) {
+        r->binary = 1;
+        diff_bytes(r);
+        return 0;
+    }
+
+    if (diff_split(r) != 0) {
+        return -1;
+    }
+    return diff_compute(r, algorithm);
+}
+
+
+/*
+ * FUNCTION: diffstat_blobs
+ * ────────────────────────
+ * Lines added / removed between two blobs (0 = no file, i.e.
+ * the file was created or deleted) — or, for binary files,
+ * just the two sizes. Safe to call from worker threads: it
+ * only reads files and uses its own memory.
+ *
+ * RETURNS: 0 → Success, -1 → a blob couldn't be read
+ */
+int diffstat_blobs(unsigned long old_hash, unsigned long new_hash, DiffStat* stat) {
+    memset(stat, 0, sizeof(*stat));
+
+    DiffResult r;
+    diff_init(&r);
+
+    int rc = -1;
+    if (side_load_blob(&r, 0, old_hash) == 0
+        && side_load_blob(&r, 1, new_hash) == 0
+        && diff_run(&r, DIFF_MYERS) == 0) {
+        for (long i = 0; i < r.side[0].count; i++) stat->removed += r.side[0].changed[i];
+        for (long i = 0; i < r.side[1].count; i++) stat->added += r.side[1].changed[i];
+        stat->binary = r.binary;
+        stat->old_size = (long long)r.side[0].file.size;
+        stat->new_size = (long long)r.side[1].file.size;
+        rc = 0;
+    }
+
+    diff_free(&r);
+    return rc;
+}
+
+
+/* ─────────── printing ─────────── */
+
+/*
+ * One run of changes: old lines [a, a + del) became new lines
+ * [b, b + ins). Between two runs the files agree line for line.
+ */
+typedef struct DiffChange {
+    long a, del;
+    long b, ins;
+} DiffChange;
+
+/* RETURNS: number of runs (*out is malloc'd), -1 if out of memory */
+static long diff_changes(const DiffResult* r, DiffChange** out) {
+    const DiffSide* a = &r->side[0];
+    const DiffSide* b = &r->side[1];
+    long count = 0, capacity = 16;
+    DiffChange* changes = malloc(capacity * sizeof(DiffChange));
+    if (!changes) {
+        return -1;
+    }
+
+    long i = 0, j = 0;
+    while (i < a->count || j < b->count) {
+        if ((i < a->count && a->changed[i]) || (j < b->count && b->changed[j])) {
+            if (count == capacity) {
+                capacity *= 2;
+                DiffChange* grown = realloc(changes, capacity * sizeof(DiffChange));
+                if (!grown) {
+                    free(changes);
+                    return -1;
+                }
+                changes = grown;
+            }
+
+            DiffChange* c = &changes[count++];
+            c->a = i;
+            c->b = j;
+            while (i < a->count && a->changed[i]) i++;
+            while (j < b->count && b->changed[j]) j++;
+            c->del = i - c->a;
+            c->ins = j - c->b;
+        } else {
+            i++;
+            j++;
+        }
+    }
+
+    *out = changes;
+    return count;
+}
+
+
+/* One line of a hunk: ' ', '-' or '+' and the text */
+static void print_line(const DiffSide* side, long i, char mark) {
+    const TextLine* line = &side->lines[i];
+    int no_eol = i == side->count - 1 && side->no_eol;
+    size_t len = no_eol ? line->len : line->len - 1;     // without the '\n'
+
+    if (out_format() == OUT_JSON) {
+        out_str(mark == ' ' ? "\" " : mark == '-' ? "\"-" : "\"+");
+        out_json_chars(line->data, len);
+        out_char('"');
+        return;
+    }
+
+    if (mark != ' ') {
+        out_color(mark == '-' ? RED : GREEN);
+    }
+    out_char(mark);
+    out_write(line->data, len);
+    if (mark != ' ') {
+        out_color(RESET);
+    }
+    out_char('\n');
+    if (no_eol) {
+        out_str("\\ No newline at end of file\n");
+    }
+}
+
+/* "@@ -10,7 +10,8 @@" — an empty range starts one line earlier */
+static void print_range(long start, long count) {
+    out_int(count > 0 ? start + 1 : start);
+    if (count != 1) {
+        out_char(',');
+        out_int(count);
+    }
+}
+
+
+/* "at 0x0001f400" — where a range starts in the old file */
+static void print_offset(size_t offset) {
+    char text[32];
+    snprintf(text, sizeof(text), "0x%08llx", (unsigned long long)offset);
+    out_str(text);
+}
+
+/*
+ * FUNCTION: print_binary
+ * ──────────────────────
+ * A binary file's changes as byte ranges:
+ *
+ *   human / porcelain
+ *     Binary files a/fw.bin and b/fw.bin differ (65536 → 65540 bytes)
+ *       @ 0x00000400  16 bytes changed
+ *       @ 0x0000f000  200 bytes replaced by 204
+ *       ... and 3 more ranges
+ *
+ *   json
+ *     {"path":"fw.bin","binary":true,"old_size":65536,
+ *      "new_size":65540,"ranges":[{"old_offset":1024,
+ *      "old_length":16,"new_offset":1024,"new_length":16}],"more":0}
+ */
+static void print_binary(const char* path, const DiffResult* r) {
+    long shown = r->range_count < BINARY_MAX_RANGES ? r->range_count : BINARY_MAX_RANGES;
+    long more = r->range_count - shown;
+
+    if (out_format() == OUT_JSON) {
+        out_str("{\"path\":");
+        out_json_string(path, strlen(path));
+        out_str(",\"binary\":true");
+        out_json_key("old_size");
+        out_int((long long)r->side[0].file.size);
+        out_json_key("new_size");
+        out_int((long long)r->side[1].file.size);
+        out_str(",\"ranges\":[");
+        for (long i = 0; i < shown; i++) {
+            const ByteRange* range = &r->ranges[i];
+            out_str(i ? ",{\"old_offset\":" : "{\"old_offset\":");
+            out_int((long long)range->a);
+            out_json_key("old_length");
+            out_int((long long)range->del);
+            out_json_key("new_offset");
+            out_int((long long)range->b);
+            out_json_key("new_length");
+            out_int((long long)range->ins);
+            out_char('}');
+        }
+        out_char(']');
+        out_json_key("more");
+        out_int(more);
+        out_char('}');
+        out_end_record();
+        return;
+    }
+
+    out_str("Binary files a/");
+    out_str(path);
+    out_str(" and b/");
+    out_str(path);
+    out_str(" differ (");
+    out_int((long long)r->side[0].file.size);
+    out_str(" → ");
+    out_int((long long)r->side[1].file.size);
+    out_str(" bytes)\n");
+
+    for (long i = 0; i < shown; i++) {
+        const ByteRange* range = &r->ranges[i];
+        out_str("  ");
+        out_color(CYAN);
+        out_str("@ ");
+        print_offset(range->a);
+        out_color(RESET);
+        out_str("  ");
+
+        if (range->del == range->ins) {
+            out_int((long long)range->del);
+            out_str(range->del == 1 ? " byte changed\n" : " bytes changed\n");
+        } else if (range->del == 0) {
+            out_color(GREEN);
+            out_int((long long)range->ins);
+            out_str(" bytes inserted");
+            out_color(RESET);
+            out_char('\n');
+        } else if (range->ins == 0) {
+            out_color(RED);
+            out_int((long long)range->del);
+            out_str(" bytes removed");
+            out_color(RESET);
+            out_char('\n');
+        } else {
+            out_int((long long)range->del);
+            out_str(" bytes replaced by ");
+            out_int((long long)range->ins);
+            out_char('\n');
+        }
+    }
+    if (more > 0) {
+        out_str("  ... and ");
+        out_int(more);
+        out_str(more == 1 ? " more range\n" : " more ranges\n");
+    }
+}
+
+
+/*
+ * FUNCTION: diff_print
+ * ────────────────────
+ * Writes the result as a unified diff, DIFF_CONTEXT lines of
+ * context around each change. Changes closer than two contexts
+ * share one hunk.
+ *
+ *   human / porcelain   the patch text (coloured for humans)
+ *   json                {"path":"a.c","hunks":[{"old_start":10,
+ *                        "old_lines":7,"new_start":10,"new_lines":8,
+ *                        "lines":[" int parse(void) {","-  ..."]}]}
+ *
+ * Binary files are listed as byte ranges (print_binary).
+ * Nothing is written if the two sides are the same.
+ * RETURNS: 0 → Success, -1 → out of memory
+ */
+static int diff_print(const char* path, const DiffResult* r) {
+    const DiffSide* a = &r->side[0];
+    const DiffSide* b = &r->side[1];
+    int json = out_format() == OUT_JSON;
+
+    if (r->binary) {
+        print_binary(path, r);
+        return 0;
+    }
+
+    DiffChange* changes;
+    long count = diff_changes(r, &changes);
+    if (count < 0) {
+        return -1;
+    }
+    if (count == 0) {
+        free(changes);
+        return 0;
+    }
+
+    if (json) {
+        out_str("{\"path\":");
+        out_json_string(path, strlen(path));
+        out_str(",\"hunks\":[");
+    } else {
+        out_str("--- a/");
+        out_str(path);
+        out_str("\n+++ b/");
+        out_str(path);
+        out_char('\n');
+    }
+
+    for (long first = 0; first < count;) {
+
+        /* Which runs go into this hunk? */
+        long last = first;
+        while (last + 1 < count
+               && changes[last + 1].a - (changes[last].a + changes[last].del) <= 2 * DIFF_CONTEXT) {
+            last++;
+        }
+
+        long old_start = changes[first].a > DIFF_CONTEXT ? changes[first].a - DIFF_CONTEXT : 0;
+        long new_start = changes[first].b - (changes[first].a - old_start);
+        long old_end = changes[last].a + changes[last].del + DIFF_CONTEXT;
+        if (old_end > a->count) old_end = a->count;
+        long new_end = changes[last].b + changes[last].ins + (old_end - changes[last].a - changes[last].del);
+
+        if (json) {
+            out_str(first ? ",{\"old_start\":" : "{\"old_start\":");
+            out_int(old_end > old_start ? old_start + 1 : old_start);
+            out_json_key("old_lines");
+            out_int(old_end - old_start);
+            out_json_key("new_start");
+            out_int(new_end > new_start ? new_start + 1 : new_start);
+            out_json_key("new_lines");
+            out_int(new_end - new_start);
+            out_str(",\"lines\":[");
+        } else {
+            out_color(CYAN);
+            out_str("@@ -");
+            print_range(old_start, old_end - old_start);
+            out_str(" +");
+            print_range(new_start, new_end - new_start);
+            out_str(" @@");
+            out_color(RESET);
+            out_char('\n');
+        }
+
+        long x = old_start;
+        int lines = 0;
+        for (long c = first; c <= last + 1; c++) {
+            long context_end = c <= last ? changes[c].a : old_end;
+            for (; x < context_end; x++) {
+                if (json && lines++) out_char(',');
+                print_line(a, x, ' ');
+            }
+            if (c > last) {
+                break;
+            }
+            for (long i = 0; i < changes[c].del; i++) {
+                if (json && lines++) out_char(',');
+                print_line(a, changes[c].a + i, '-');
+            }
+            for (long i = 0; i < changes[c].ins; i++) {
+                if (json && lines++) out_char(',');
+                print_line(b, changes[c].b + i, '+');
+            }
+            x = changes[c].a + changes[c].del;
+        }
+
+        if (json) {
+            out_str("]}");
+        }
+        first = last + 1;
+    }
+
+    if (json) {
+        out_str("]}");
+        out_end_record();
+    }
+
+    free(changes);
     return 0;
-}
\ No newline at end of file
+}
+
+
+/* ─────────── many files ─────────── */
+
+/*
+ * One file to compare — and the worker's job for it: the pool
+ * fills in `result`, the main thread prints it.
+ */
+typedef struct DiffFile {
+    PoolTask task;                   // first member (see pool.c)
+    char* path;
+    unsigned long old_hash;          // 0 → no old file
+    unsigned long new_hash;          // 0 → no new file
+    int worktree;                    // new side is the working file
+    int order;                       // while collecting: later wins
+    DiffAlgorithm algorithm;
+    DiffResult result;
+    const char* error;               // set by the worker, NULL = fine
+} DiffFile;
+
+typedef struct DiffList {
+    DiffFile* files;
+    int count;
+    int capacity;
+    int failed;
+    const char* path;                // only this file / directory
+} DiffList;
+
+/* "src" selects src itself and everything under src/ */
+static int path_selected(const char* path, const char* wanted) {
+    if (!wanted) {
+        return 1;
+    }
+    size_t len = strlen(wanted);
+    while (len > 1 && wanted[len - 1] == '/') len--;
+    return strncmp(path, wanted, len) == 0 && (path[len] == '\0' || path[len] == '/');
+}
+
+static void diff_list_add(DiffList* list, const char* path,
+                          unsigned long old_hash, unsigned long new_hash) {
+    if (list->failed || !path_selected(path, list->path)) {
+        return;
+    }
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 64;
+        DiffFile* grown = realloc(list->files, capacity * sizeof(DiffFile));
+        if (!grown) {
+            list->failed = 1;
+            return;
+        }
+        list->files = grown;
+        list->capacity = capacity;
+    }
+
+    DiffFile* f = &list->files[list->count];
+    memset(f, 0, sizeof(*f));
+    f->path = strdup(path);
+    if (!f->path) {
+        list->failed = 1;
+        return;
+    }
+    f->old_hash = old_hash;
+    f->new_hash = new_hash;
+    f->order = list->count++;
+}
+
+static void diff_list_free(DiffList* list) {
+    for (int i = 0; i < list->count; i++) {
+        free(list->files[i].path);
+    }
+    free(list->files);
+}
+
+static int compare_files(const void* a, const void* b) {
+    const DiffFile* fa = a;
+    const DiffFile* fb = b;
+    int cmp = strcmp(fa->path, fb->path);
+    return cmp != 0 ? cmp : (fa->order > fb->order) - (fa->order < fb->order);
+}
+
+/* tree_diff callback: a file that differs between two snapshots */
+static void collect_tree_file(const char* path, unsigned long old_hash,
+                              unsigned long new_hash, void* ctx) {
+    diff_list_add(ctx, path, old_hash, new_hash);
+}
+
+/* tree_diff(0, head) callback: every HEAD file, its hash kept as "old" */
+static void collect_head_file(const char* path, unsigned long old_hash,
+                              unsigned long new_hash, void* ctx) {
+    (void)old_hash;
+    diff_list_add(ctx, path, new_hash, 0);
+}
+
+
+/*
+ * FUNCTION: collect_index
+ * ───────────────────────
+ * The files to compare for "mygit diff" (worktree = 1) and
+ * "mygit diff --cached" (worktree = 0), sorted by path.
+ *
+ * Every tracked file has a HEAD hash and/or a staged hash.
+ * Both are put in one list — HEAD files first, then staging in
+ * file order — and sorted, so each path's entries end up next
+ * to each other and are folded into one.
+ *
+ *   worktree   staged (or HEAD) blob ↔ the working file
+ *   --cached   HEAD blob ↔ staged blob, only where they differ;
+ *              files that aren't staged are never looked at
+ *
+ * RETURNS: 0 → Success, -1 → out of memory / unreadable tree
+ */
+static int collect_index(DiffList* list, int worktree) {
+
+    /* STEP 1: HEAD's files (hash in old_hash) */
+    char branch[MAX_BRANCH_NAME];
+    get_current_branch(branch, sizeof(branch));
+    int head = get_last_commit_id_on_branch(branch);
+    if (head > 0 && tree_diff(0, commit_root_tree(head), collect_head_file, list) != 0) {
+        return -1;
+    }
+
+    /* STEP 2: staging (hash in new_hash) */
+    int staged_count;
+    StagedFile* staged = read_staged_files(&staged_count);
+    for (StagedFile* s = staged; s; s = s->next) {
+        diff_list_add(list, s->filename, 0, s->hash);
+    }
+    free_staged_files(staged);
+    if (list->failed) {
+        return -1;
+    }
+    if (list->count == 0) {
+        return 0;                    // nothing committed or staged: files is still NULL
+    }
+
+    /* STEP 3: fold each path into one entry and pick the sides */
+    qsort(list->files, list->count, sizeof(DiffFile), compare_files);
+
+    int kept = 0;
+    for (int i = 0; i < list->count;) {
+        DiffFile f = list->files[i];
+        int j = i + 1;
+        for (; j < list->count && strcmp(list->files[j].path, f.path) == 0; j++) {
+            if (list->files[j].old_hash) f.old_hash = list->files[j].old_hash;
+            if (list->files[j].new_hash) f.new_hash = list->files[j].new_hash;   // later add wins
+            free(list->files[j].path);
+        }
+        i = j;
+
+        unsigned long head_hash = f.old_hash;
+        unsigned long staged_hash = f.new_hash;
+        if (worktree) {
+            f.old_hash = staged_hash ? staged_hash : head_hash;
+            f.new_hash = 0;
+            f.worktree = 1;
+        } else if (staged_hash == 0 || staged_hash == head_hash) {
+            free(f.path);
+            continue;
+        }
+        list->files[kept++] = f;
+    }
+    list->count = kept;
+    return 0;
+}
+
+
+/*
+ * FUNCTION: resolve_commit
+ * ────────────────────────
+ * "main", "main@{2}" or "7" → commit id, the way checkout
+ * reads its target (a branch wins over a number).
+ *
+ * RETURNS: 0 → *id set, -1 → no such commit (message printed)
+ */
+static int resolve_commit(const char* spec, int* id) {
+    int from_reflog = reflog_resolve(spec, id);
+    if (from_reflog < 0) {
+        return -1;
+    }
+
+    if (from_reflog || ref_read(spec, id)) {
+        if (*id <= 0) {
+            printf(RED "✗ %s has no commit\n" RESET, spec);
+            return -1;
+        }
+        return 0;
+    }
+
+    TextView number = { spec, strlen(spec) };
+    unsigned long n;
+    if (!view_to_ul(number, &n)) {
+        printf(RED "✗ No branch or commit named '%s'\n" RESET, spec);
+        return -1;
+    }
+    if (n == 0 || n >= (unsigned long)get_next_commit_id()) {
+        printf(RED "✗ Commit #%s doesn't exist\n" RESET, spec);
+        return -1;
+    }
+    *id = (int)n;
+    return 0;
+}
+
+
+/*
+ * FUNCTION: diff_file_run
+ * ───────────────────────
+ * Runs on a worker thread: loads both sides and diffs them
+ * (see diff_run — a working file touched but not changed stops
+ * before any line is split).
+ */
+static void diff_file_run(PoolTask* task) {
+    DiffFile* f = (DiffFile*)task;
+    DiffResult* r = &f->result;
+    diff_init(r);
+
+    if (side_load_blob(r, 0, f->old_hash) != 0) {
+        f->error = "Could not read the saved copy of";
+        return;
+    }
+    int loaded = f->worktree ? side_load_file(r, 1, f->path)
+                             : side_load_blob(r, 1, f->new_hash);
+    if (loaded != 0) {
+        f->error = f->worktree ? "Could not read" : "Could not read the saved copy of";
+        return;
+    }
+
+    if (diff_run(r, f->algorithm) != 0) {
+        f->error = "Out of memory comparing";
+    }
+}
+
+
+/*
+ * ═══════════════════════════════════════════════
+ * MAIN FUNCTION: mygit_diff
+ * ═══════════════════════════════════════════════
+ *
+ *   mygit diff [path]             working files ↔ last added
+ *   mygit diff --cached [path]    staged ↔ HEAD
+ *   mygit diff <commit> <commit>  snapshot ↔ snapshot
+ *
+ * HOW IT SCALES:
+ *   Files whose hashes already say "same" never reach a worker:
+ *   tree_diff skips equal blobs and whole equal directories,
+ *   and --cached only looks at staged files. The rest are
+ *   diffed on the worker pool, a window of a few jobs per CPU
+ *   ahead of the printer, which prints them in path order —
+ *   like log --stat prints commits.
+ */
+int mygit_diff(const DiffOptions* options) {
+
+    /*
+     * ──────────────────────────────────
+     * STEP 1: Which files, which sides?
+     * ──────────────────────────────────
+     */
+    DiffList list;
+    memset(&list, 0, sizeof(list));
+    list.path = options->path;
+
+    int collected;
+    if (options->from) {
+        int from, to;
+        if (resolve_commit(options->from, &from) != 0 || resolve_commit(options->to, &to) != 0) {
+            return 1;
+        }
+        collected = tree_diff(commit_root_tree(from), commit_root_tree(to), collect_tree_file, &list);
+        if (collected == 0 && !list.failed && list.count > 0) {
+            qsort(list.files, list.count, sizeof(DiffFile), compare_files);
+        }
+    } else {
+        collected = collect_index(&list, !options->cached);
+    }
+
+    if (collected != 0 || list.failed) {
+        printf(RED "✗ Could not list the files to compare\n" RESET);
+        diff_list_free(&list);
+        return 1;
+    }
+    if (options->path && list.count == 0 && !options->from && !options->cached) {
+        printf(RED "✗ '%s' is not tracked — run mygit add first\n" RESET, options->path);
+        diff_list_free(&list);
+        return 1;
+    }
+
+    /*
+     * ──────────────────────────────────
+     * STEP 2: Diff on the pool, print in order
+     * ──────────────────────────────────
+     * At most `window` files are loaded at once, however many
+     * there are. If the reader goes away, nothing new is
+     * started; the ones running are waited for and freed.
+     */
+    int threads = pool_cpu_count();
+    if (threads > list.count) threads = list.count;
+    int window = threads > 1 ? threads * 4 : 1;
+    WorkPool* pool = pool_start(threads);
+
+    int rc = 0;
+    int submitted = 0;
+    int stopped = 0;
+
+    for (int i = 0; i < submitted || (!stopped && i < list.count); i++) {
+        for (; !stopped && submitted < list.count && submitted < i + window; submitted++) {
+            DiffFile* next = &list.files[submitted];
+            next->task.run = diff_file_run;
+            next->algorithm = options->algorithm;
+            pool_submit(pool, &next->task);
+        }
+
+        DiffFile* f = &list.files[i];
+        pool_wait(pool, &f->task);
+
+        if (!stopped) {
+            if (f->error) {
+                out_flush();
+                printf(RED "✗ %s '%s'\n" RESET, f->error, f->path);
+                rc = 1;
+            } else if (diff_print(f->path, &f->result) != 0) {
+                out_flush();
+                printf(RED "✗ Out of memory comparing '%s'\n" RESET, f->path);
+                rc = 1;
+            }
+            stopped = out_failed();
+        }
+        diff_free(&f->result);
+    }
+
+    pool_stop(pool);
+    diff_list_free(&list);
+    return rc;
+}
@@ -0,0 +1,326 @@
+/*
+ * ============================================
+ *          MYGIT - Parser Fuzz Harness
+ *          Throws garbage at parse.c / store.c
+ * ============================================
+ *
+ * PURPOSE:
+ *   Every .mygit file is read through the TextView tokenizer
+ *   (parse.c) and the commit-record scanner (store.c). Their
+ *   promise: never read past view.data + view.len — not even by
+ *   one byte — whatever a crash, a disk error or a hand edit left
+ *   in the file. This harness feeds them arbitrary bytes to check
+ *   that promise.
+ *
+ * HOW IT CATCHES A BUG:
+ *   Each input is copied into a heap block of EXACTLY its size,
+ *   so AddressSanitizer reports the first byte read beyond it.
+ *   On top of that, every view handed back is checked to lie
+ *   inside the input (check_view) — a view pointing elsewhere
+ *   aborts at once.
+ *
+ * TWO WAYS TO RUN IT (from the repository root):
+ *
+ *   libFuzzer (clang), coverage-guided:
+ *     clang -g -O1 -fsanitize=fuzzer,address,undefined -fno-sanitize-recover=all -DMYGIT_LIBFUZZER \
+ *           -o parse_fuzz fuzz/parse_fuzz.c $(ls *.c | grep -v '^main.c$')
+ *     ./parse_fuzz -max_len=4096
+ *
+ *   Standalone (any compiler), random mutations of a few seed
+ *   files — good enough for a quick run or CI:
+ *     gcc -g -O1 -fsanitize=address,undefined -fno-sanitize-recover=all \
+ *         -o parse_fuzz fuzz/parse_fuzz.c $(ls *.c | grep -v '^main.c$')
+ *     ./parse_fuzz              200000 random inputs
+ *     ./parse_fuzz -n 5000000   more
+ *     ./parse_fuzz crash-1234   replay saved inputs
+ *
+ *   When a standalone run dies, the input that killed it is
+ *   written to fuzz-crash.bin, ready to be replayed.
+ */
+
+#include "../mygit.h"
+#include <signal.h>
+
+
+/* ─────────── ONE INPUT ─────────── */
+
+static const char* g_begin;
+static const char* g_end;
+
+/* A view must point inside the input (an empty one may sit at its end) */
+static void check_view(TextView view) {
+    if (view.len == 0) return;
+    if (view.data < g_begin || view.data > g_end || view.len > (size_t)(g_end - view.data)) {
+        fprintf(stderr, "parse_fuzz: view escaped the input\n");
+        abort();
+    }
+}
+
+/* Every split, number and copy helper on one line */
+static void fuzz_line(TextView line) {
+    check_view(line);
+    check_view(view_trim(line));
+
+    TextView left, right;
+    if (view_split(line, ' ', &left, &right)) {
+        check_view(left);
+        check_view(right);
+    }
+    if (view_split_last(line, '|', &left, &right)) {
+        check_view(left);
+        check_view(right);
+    }
+
+    TextView list = line;
+    TextView item;
+    int items = 0;
+    while (items < 4096 && view_next_item(&list, ',', &item)) {
+        check_view(item);
+        items++;
+    }
+
+    TextView rest = line;
+    long long number;
+    while (view_take_number(&rest, &number) || view_take_char(&rest, '-')
+           || view_take_char(&rest, ':') || view_take_char(&rest, ' ')) {
+        check_view(rest);
+    }
+
+    unsigned long hash;
+    (void)view_to_ll(line, 0);
+    (void)view_to_ul(line, &hash);
+    (void)view_starts_with(line, "#root ");
+    (void)view_equals(line, "END");
+
+    char small[16];
+    (void)view_copy(line, small, sizeof(small));
+
+    int tz;
+    (void)parse_timestamp(line);
+    (void)parse_commit_time(line, &tz);
+}
+
+static void fuzz_one(const char* data, size_t size) {
+    /* Exactly `size` bytes: one byte too far is an ASan report */
+    char* copy = malloc(size > 0 ? size : 1);
+    if (!copy) return;
+    if (size > 0) memcpy(copy, data, size);
+
+    g_begin = copy;
+    g_end = copy + size;
+
+    /* 1. Line by line — the way staging.dat, refs and trees are read */
+    LineCursor cursor;
+    TextView line;
+    lines_init(&cursor, copy, size);
+    while (lines_next(&cursor, &line)) {
+        fuzz_line(line);
+    }
+
+    /* 2. As a staging area */
+    TextView path;
+    unsigned long hash;
+    lines_init(&cursor, copy, size);
+    while (staging_next(&cursor, &path, &hash)) {
+        check_view(path);
+    }
+
+    /* 3. As commits.dat */
+    static const char* keys[] = { "COMMIT", "PARENT", "BRANCH", "TIME", "TREE", "MSG", "FILE" };
+    CommitStore store;
+    store.file.data = copy;
+    store.file.size = size;
+    store.file.is_mapped = 0;
+
+    size_t at = 0;
+    CommitRecord rec;
+    while (store_next(&store, &at, &rec)) {
+        TextView whole = { rec.data, rec.len };
+        check_view(whole);
+
+        for (size_t k = 0; k < sizeof(keys) / sizeof(keys[0]); k++) {
+            TextView value;
+            if (record_field(&rec, keys[k], &value)) {
+                check_view(value);
+                fuzz_line(value);
+            }
+            (void)record_int_field(&rec, keys[k], 0);
+        }
+    }
+
+    free(copy);
+}
+
+
+#ifdef MYGIT_LIBFUZZER
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    fuzz_one((const char*)data, size);
+    return 0;
+}
+
+#else
+
+/* ─────────── STANDALONE DRIVER ─────────── */
+
+#define FUZZ_MAX_LEN 4096
+
+/* Seeds: one of each format, so mutations start out "almost valid" */
+static const char* g_seeds[] = {
+    "# MyGit Staging Area\n#root 8069698787644\n#tree 2 8069698787644 .\n"
+    "src/a.c|5863879\nREADME|193485797\n",
+    "COMMIT:1\nPARENT:-1\nBRANCH:main\nTIME:1736951445 +0100\nTREE:8069698787644\n"
+    "MSG:first commit\nEND\n"
+    "COMMIT:2\nPARENT:1\nBRANCH:main\nTIME:2025-01-15 14:30:45\nFILE:a.c|5863879\n"
+    "MSG:second\nEND\r\n",
+    "blob 5863879 a.c\ntree 8069698787644 src\n",
+    "31\n",
+    "-9223372036854775808 18446744073709551616 2025-01-15 14:30:45 +0530\n",
+    "# mygit packed-refs\n12 ci/build-1041\n9 feature/login\n31 main\n",
+};
+
+/* Bytes the parsers care about, so mutations hit them often */
+static const char g_special[] = "\n\r|:# -+0123456789COMITEND";
+
+static uint64_t g_rng = 88172645463325252ULL;
+
+static uint32_t next_random(void) {
+    g_rng ^= g_rng << 13;             // xorshift64
+    g_rng ^= g_rng >> 7;
+    g_rng ^= g_rng << 17;
+    return (uint32_t)(g_rng >> 32);
+}
+
+/* A few random edits: flip, overwrite, insert, delete, splice */
+static size_t mutate(char* buf, size_t len) {
+    int edits = 1 + next_random() % 8;
+    for (int e = 0; e < edits; e++) {
+        size_t pos = len ? next_random() % len : 0;
+        switch (next_random() % 6) {
+        case 0:
+            if (len) buf[pos] ^= (char)(1 << (next_random() % 8));
+            break;
+        case 1:
+            if (len) buf[pos] = g_special[next_random() % (sizeof(g_special) - 1)];
+            break;
+        case 2:
+            if (len < FUZZ_MAX_LEN) {
+                memmove(buf + pos + 1, buf + pos, len - pos);
+                buf[pos] = g_special[next_random() % (sizeof(g_special) - 1)];
+                len++;
+            }
+            break;
+        case 3:
+            if (len) {
+                size_t n = 1 + next_random() % (len - pos);
+                memmove(buf + pos, buf + pos + n, len - pos - n);
+                len -= n;
+            }
+            break;
+        case 4:
+            len = pos;                  // cut off, like a torn write
+            break;
+        default: {
+            /* copy a chunk of a seed in: builds long, nested records */
+            const char* seed = g_seeds[next_random() % (sizeof(g_seeds) / sizeof(g_seeds[0]))];
+            size_t n = strlen(seed);
+            size_t from = next_random() % n;
+            size_t take = 1 + next_random() % (n - from);
+            if (len + take <= FUZZ_MAX_LEN) {
+                memmove(buf + pos + take, buf + pos, len - pos);
+                memcpy(buf + pos, seed + from, take);
+                len += take;
+            }
+            break;
+        }
+        }
+    }
+    return len;
+}
+
+/*
+ * The input being tried, saved when we die: from the sanitizer's
+ * death callback (ASan/UBSan reports) or a signal handler (plain
+ * crashes, check_view's abort).
+ */
+static const char* g_current;
+static size_t g_current_len;
+
+static void save_current(void) {
+    FILE* fp = fopen("fuzz-crash.bin", "wb");
+    if (fp) {
+        fwrite(g_current, 1, g_current_len, fp);
+        fclose(fp);
+        fprintf(stderr, "parse_fuzz: input saved to fuzz-crash.bin\n");
+    }
+}
+
+static void on_signal(int sig) {
+    save_current();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+#if defined(__GNUC__) && !defined(_WIN32)
+extern void __sanitizer_set_death_callback(void (*callback)(void)) __attribute__((weak));
+
+/* UBSan exits on its own without the callback: make it abort instead */
+const char* __ubsan_default_options(void) {
+    return "abort_on_error=1:print_stacktrace=1";
+}
+#endif
+
+static int replay(const char* path) {
+    MappedFile mf;
+    if (map_file(path, &mf) != 0) {
+        fprintf(stderr, "parse_fuzz: cannot read %s\n", path);
+        return -1;
+    }
+    fuzz_one(mf.data, mf.size);
+    unmap_file(&mf);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    long runs = 200000;
+    int replayed = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            runs = atol(argv[++i]);
+        } else if (replay(argv[i]) == 0) {
+            replayed++;
+        } else {
+            return 1;
+        }
+    }
+    if (replayed > 0) {
+        printf("parse_fuzz: %d input%s replayed, no problems\n", replayed, replayed == 1 ? "" : "s");
+        return 0;
+    }
+
+#if defined(__GNUC__) && !defined(_WIN32)
+    if (__sanitizer_set_death_callback) {
+        __sanitizer_set_death_callback(save_current);
+    }
+#endif
+    signal(SIGSEGV, on_signal);
+    signal(SIGABRT, on_signal);
+
+    static char buf[FUZZ_MAX_LEN];
+    g_current = buf;
+    for (long run = 0; run < runs; run++) {
+        const char* seed = g_seeds[run % (sizeof(g_seeds) / sizeof(g_seeds[0]))];
+        size_t len = strlen(seed);
+        memcpy(buf, seed, len);
+
+        len = mutate(buf, len);
+        g_current_len = len;
+        fuzz_one(buf, len);
+    }
+
+    printf("parse_fuzz: %ld inputs, no problems\n", runs);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,702 @@
+/*
+ * ============================================
+ *          MYGIT - Commit Graph
+ *          .mygit/commit-graph
+ * ============================================
+ *
+ * PURPOSE:
+ *   commits.dat is TEXT. To find commit #500's parent we would
+ *   have to read (and sscanf) every line before it.
+ *
+ *   The commit-graph is a BINARY copy of just the shape of the
+ *   history: for every commit, its parents, its tree, its time,
+ *   its generation number and a Bloom filter of the paths it
+ *   changed — all in fixed-size records.
+ *
+ * FILE LAYOUT:
+ *   ┌────────────────────┐
+ *   │ GraphHeader        │  magic "MGCG", version, sizes
+ *   ├────────────────────┤
+ *   │ GraphEntry  #1     │  position 0
+ *   │ GraphEntry  #2     │  position 1
+ *   │ ...                │
+ *   └────────────────────┘
+ *
+ *   Commit #N is at position N-1, so lookup is O(1):
+ *     entry = entries[id - 1]
+ *
+ * WHY mmap?
+ *   We never parse this file — we map it into memory once at
+ *   startup and read the structs in place. Walking 1000 parents
+ *   is 1000 array reads, no fopen / fgets / sscanf at all.
+ *
+ * The graph is a CACHE: commits.dat is still the source of truth.
+ * If the graph is missing, has the wrong version, or describes a
+ * different commits.dat size, we simply rebuild it.
+ */
+
+#include "mygit.h"
+
+#define GRAPH_MAGIC   "MGCG"
+#define GRAPH_VERSION 3
+#define BLOOM_BITS    (BLOOM_WORDS * 64)
+#define BLOOM_HASHES  7              // bits set per path
+#define BLOOM_MAX_PATHS 24           // more changes than this → "maybe" for all
+
+typedef struct GraphHeader {
+    char     magic[4];               // "MGCG"
+    uint32_t version;                // GRAPH_VERSION
+    uint32_t record_size;            // sizeof(GraphEntry)
+    uint32_t reserved;
+    uint64_t store_size;             // size of commits.dat when last synced
+} GraphHeader;
+
+static MappedFile g_graph;           // the mapped file
+static const GraphEntry* g_entries;  // points just past the header
+static int g_count = -1;             // -1 → graph not loaded
+
+
+/*
+ * FUNCTION: graph_map
+ * ───────────────────
+ * Maps the graph file and checks its header.
+ *
+ * RETURNS:
+ *   0  → Mapped and matches commits.dat
+ *   -1 → Missing, damaged or stale (caller should rebuild)
+ */
+static int graph_map(void) {
+    if (map_file(GRAPH_FILE, &g_graph) != 0) {
+        return -1;
+    }
+
+    const GraphHeader* header = (const GraphHeader*)g_graph.data;
+
+    if (g_graph.size < sizeof(GraphHeader)
+        || memcmp(header->magic, GRAPH_MAGIC, 4) != 0
+        || header->version != GRAPH_VERSION
+        || header->record_size != sizeof(GraphEntry)
+        || (g_graph.size - sizeof(GraphHeader)) % sizeof(GraphEntry) != 0
+        || header->store_size != store_size()) {
+        unmap_file(&g_graph);
+        return -1;
+    }
+
+    g_entries = (const GraphEntry*)(g_graph.data + sizeof(GraphHeader));
+    g_count = (int)((g_graph.size - sizeof(GraphHeader)) / sizeof(GraphEntry));
+    return 0;
+}
+
+
+/*
+ * FUNCTION: graph_load
+ * ────────────────────
+ * Called once at startup (from main). Maps the graph,
+ * rebuilding it first if it is missing or out of date.
+ *
+ * RETURNS:
+ *   0  → Graph ready (graph_count() >= 0)
+ *   -1 → Could not build it; callers fall back to commits.dat
+ */
+int graph_load(void) {
+    graph_close();
+
+    if (graph_map() == 0) {
+        return 0;
+    }
+
+    if (graph_rebuild() != 0) {
+        return -1;
+    }
+
+    return graph_map();
+}
+
+
+/*
+ * FUNCTION: graph_close
+ * ─────────────────────
+ * Unmaps the graph. graph_count() returns -1 afterwards.
+ */
+void graph_close(void) {
+    if (g_count >= 0) {
+        unmap_file(&g_graph);
+    }
+    g_entries = NULL;
+    g_count = -1;
+}
+
+
+/*
+ * FUNCTION: graph_write
+ * ─────────────────────
+ * Writes a complete graph file from an array of entries.
+ *
+ * atomic_open() gives us a tmp file of our own; it is RENAMED
+ * over the old graph only when complete, so a reader never sees
+ * a half-written graph.
+ */
+static int graph_write(const GraphEntry* entries, int count) {
+    AtomicFile af;
+    if (atomic_open(&af, GRAPH_FILE) != 0) {
+        return -1;
+    }
+
+    GraphHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, GRAPH_MAGIC, 4);
+    header.version = GRAPH_VERSION;
+    header.record_size = sizeof(GraphEntry);
+    header.store_size = store_size();
+
+    int ok = fwrite(&header, sizeof(header), 1, af.fp) == 1;
+    if (ok && count > 0) {
+        ok = fwrite(entries, sizeof(GraphEntry), count, af.fp) == (size_t)count;
+    }
+
+    if (!ok) {
+        atomic_abort(&af);
+        return -1;
+    }
+    return atomic_commit(&af);
+}
+
+
+/*
+ * ─────────── CHANGED-PATH BLOOM FILTERS ───────────
+ *
+ * A Bloom filter is a small bit array. To ADD a path we hash it
+ * 7 different ways and set those 7 bits. To TEST a path we check
+ * the same 7 bits:
+ *
+ *   any bit 0  → the path was DEFINITELY not changed
+ *   all bits 1 → MAYBE changed (could be other paths' bits)
+ *
+ * Each changed file also adds its directories ("src/util/io.c"
+ * adds "src" and "src/util"), so "log -- src" works too.
+ * A commit that changed too many paths gets every bit set.
+ */
+
+typedef struct BloomBuilder {
+    uint64_t* bits;
+    int paths;
+} BloomBuilder;
+
+static void bloom_positions(const char* path, size_t len, uint32_t out[BLOOM_HASHES]) {
+    /* FNV-1a 64 → two 32-bit halves → "double hashing" */
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)path[i];
+        h *= 1099511628211ull;
+    }
+
+    uint32_t h1 = (uint32_t)h;
+    uint32_t h2 = (uint32_t)(h >> 32) | 1;
+    for (int i = 0; i < BLOOM_HASHES; i++) {
+        out[i] = (h1 + (uint32_t)i * h2) % BLOOM_BITS;
+    }
+}
+
+static void bloom_add(uint64_t* bits, const char* path, size_t len) {
+    uint32_t pos[BLOOM_HASHES];
+    bloom_positions(path, len, pos);
+    for (int i = 0; i < BLOOM_HASHES; i++) {
+        bits[pos[i] / 64] |= 1ull << (pos[i] % 64);
+    }
+}
+
+static void bloom_saturate(uint64_t* bits) {
+    for (int i = 0; i < BLOOM_WORDS; i++) {
+        bits[i] = ~0ull;
+    }
+}
+
+/* tree_diff callback: add the file and every directory above it */
+static void bloom_add_change(const char* path, unsigned long old_hash,
+                             unsigned long new_hash, void* ctx) {
+    BloomBuilder* b = ctx;
+    (void)old_hash;
+    (void)new_hash;
+
+    if (++b->paths > BLOOM_MAX_PATHS) {
+        return;
+    }
+
+    bloom_add(b->bits, path, strlen(path));
+    for (const char* p = path; (p = strchr(p, '/')) != NULL; p++) {
+        bloom_add(b->bits, path, p - path);
+    }
+}
+
+
+/*
+ * FUNCTION: bloom_compute
+ * ───────────────────────
+ * Fills `bits` with the paths that differ between the commit's
+ * tree and its first parent's tree. A commit whose snapshot
+ * couldn't be rebuilt (tree 0) gets a full filter — always
+ * "maybe", never wrong.
+ */
+static void bloom_compute(uint64_t tree, uint64_t parent_tree, uint64_t* bits) {
+    memset(bits, 0, BLOOM_WORDS * sizeof(uint64_t));
+
+    if (tree == 0) {
+        bloom_saturate(bits);
+        return;
+    }
+
+    BloomBuilder builder = { bits, 0 };
+    if (tree_diff((unsigned long)parent_tree, (unsigned long)tree, bloom_add_change, &builder) != 0
+        || builder.paths > BLOOM_MAX_PATHS) {
+        bloom_saturate(bits);
+    }
+}
+
+
+/*
+ * FUNCTION: graph_rebuild
+ * ───────────────────────
+ * Reads commits.dat ONE time and writes a fresh graph.
+ *
+ * HOW:
+ *   1. Collect PARENT / TIME / TREE for each COMMIT:<id>
+ *      (old commits get their full snapshot tree built here)
+ *   2. Parents always have SMALLER ids than their children,
+ *      so one pass in id order fills in generation numbers.
+ *
+ * RETURNS:
+ *   0 → Success, -1 → Error
+ */
+int graph_rebuild(void) {
+    int capacity = 64;
+    int count = 0;
+    GraphEntry* entries = calloc(capacity, sizeof(GraphEntry));
+    if (!entries) {
+        return -1;
+    }
+
+    CommitStore store;
+    store_open(&store);
+
+    size_t cursor = 0;
+    CommitRecord rec;
+
+    while (store_next(&store, &cursor, &rec)) {
+        int id = (int)record_int_field(&rec, "COMMIT", 0);
+        if (id <= 0) continue;
+
+        /* Grow the array (doubling) until position id-1 fits */
+        if (id > capacity) {
+            int new_capacity = capacity;
+            while (new_capacity < id) new_capacity *= 2;
+
+            GraphEntry* grown = realloc(entries, new_capacity * sizeof(GraphEntry));
+            if (!grown) {
+                store_close(&store);
+                free(entries);
+                return -1;
+            }
+            memset(grown + capacity, 0, (new_capacity - capacity) * sizeof(GraphEntry));
+            entries = grown;
+            capacity = new_capacity;
+        }
+
+        GraphEntry* e = &entries[id - 1];
+        e->commit_id = id;
+        e->parents[0] = GRAPH_NO_PARENT;
+        e->parents[1] = GRAPH_NO_PARENT;
+        if (id > count) count = id;
+
+        /* Only the fields the graph needs are ever parsed */
+        int parent = (int)record_int_field(&rec, "PARENT", -1);
+        if (parent > 0) {
+            e->parents[0] = (uint32_t)(parent - 1);
+        }
+
+        /*
+         * Old commits have no TREE: line and list only the files
+         * they changed. Fold them onto the parent's snapshot —
+         * commits.dat is in id order, so the parent is done.
+         */
+        TextView tree_text;
+        if (record_field(&rec, "TREE", &tree_text)) {
+            e->tree = (uint64_t)view_to_ll(tree_text, 0);
+        } else {
+            uint64_t parent_tree = parent > 0 && parent < id ? entries[parent - 1].tree : 0;
+            e->tree = legacy_commit_tree(&rec, (unsigned long)parent_tree);
+        }
+
+        TextView time_text;
+        if (record_field(&rec, "TIME", &time_text)) {
+            e->time = (int64_t)parse_commit_time(time_text, NULL);
+        }
+    }
+
+    store_close(&store);
+
+    /*
+     * Fill generation numbers in id order.
+     * Gaps (ids that never appeared) become parentless roots
+     * so positions stay equal to id-1.
+     */
+    for (int pos = 0; pos < count; pos++) {
+        GraphEntry* e = &entries[pos];
+
+        if (e->commit_id == 0) {
+            e->commit_id = pos + 1;
+            e->parents[0] = GRAPH_NO_PARENT;
+            e->parents[1] = GRAPH_NO_PARENT;
+        }
+
+        uint32_t generation = 0;
+        for (int p = 0; p < 2; p++) {
+            uint32_t parent = e->parents[p];
+            if (parent == GRAPH_NO_PARENT) continue;
+
+            if (parent >= (uint32_t)pos) {
+                e->parents[p] = GRAPH_NO_PARENT;   /* corrupt: parent must be older */
+                continue;
+            }
+            if (entries[parent].generation > generation) {
+                generation = entries[parent].generation;
+            }
+        }
+        e->generation = generation + 1;
+
+        uint64_t parent_tree = e->parents[0] != GRAPH_NO_PARENT ? entries[e->parents[0]].tree : 0;
+        bloom_compute(e->tree, parent_tree, e->bloom);
+    }
+
+    int result = graph_write(entries, count);
+    free(entries);
+    return result;
+}
+
+
+/*
+ * FUNCTION: graph_count
+ * ─────────────────────
+ * Number of commits in the graph, or -1 if it isn't loaded.
+ */
+int graph_count(void) {
+    return g_count;
+}
+
+
+/*
+ * FUNCTION: graph_entry
+ * ─────────────────────
+ * Direct O(1) lookup of a commit's record.
+ * RETURNS: pointer into the mapped file, or NULL if unknown
+ */
+const GraphEntry* graph_entry(int commit_id) {
+    if (commit_id < 1 || commit_id > g_count) {
+        return NULL;
+    }
+    return &g_entries[commit_id - 1];
+}
+
+
+/*
+ * FUNCTION: graph_parent_id
+ * ─────────────────────────
+ * First parent of a commit, as a commit ID.
+ * RETURNS: parent id, or -1 for a root / unknown commit
+ *          (same convention as Commit.parent_id)
+ */
+int graph_parent_id(int commit_id) {
+    const GraphEntry* e = graph_entry(commit_id);
+    if (!e || e->parents[0] == GRAPH_NO_PARENT) {
+        return -1;
+    }
+    return (int)e->parents[0] + 1;
+}
+
+
+/*
+ * FUNCTION: graph_append
+ * ──────────────────────
+ * Adds a just-saved commit to the graph.
+ *
+ * Normal case: the new commit is #count+1, so we append ONE
+ * fixed-size record and refresh the header — O(1).
+ * Anything unexpected (graph not loaded, ids out of step) →
+ * rebuild from commits.dat instead.
+ */
+int graph_append(const Commit* commit) {
+    if (g_count < 0 || commit->id != g_count + 1) {
+        return graph_load();
+    }
+
+    GraphEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.commit_id = commit->id;
+    entry.parents[0] = GRAPH_NO_PARENT;
+    entry.parents[1] = GRAPH_NO_PARENT;
+    entry.tree = commit->tree;
+    entry.time = (int64_t)commit->time;
+    entry.generation = 1;
+
+    const GraphEntry* parent = graph_entry(commit->parent_id);
+    if (parent) {
+        entry.parents[0] = (uint32_t)(commit->parent_id - 1);
+        entry.generation = parent->generation + 1;
+    }
+
+    bloom_compute(entry.tree, parent ? parent->tree : 0, entry.bloom);
+
+    /* Done reading the old mapping — we'll map the new size below */
+    graph_close();
+
+    FILE* fp = fopen(GRAPH_FILE, "r+b");
+    if (!fp) {
+        return graph_load();
+    }
+
+    GraphHeader header;
+    int ok = fread(&header, sizeof(header), 1, fp) == 1;
+
+    /*
+     * Another mygit may have rebuilt the file since we mapped it
+     * (and already included this commit). Only append when the
+     * file holds exactly the commits before ours.
+     */
+    long expected = (long)sizeof(GraphHeader) + (long)(commit->id - 1) * (long)sizeof(GraphEntry);
+    ok = ok && fseek(fp, 0, SEEK_END) == 0 && ftell(fp) == expected;
+
+    if (ok) {
+        header.store_size = store_size();
+        ok = fseek(fp, 0, SEEK_END) == 0
+          && fwrite(&entry, sizeof(entry), 1, fp) == 1
+          && fseek(fp, 0, SEEK_SET) == 0
+          && fwrite(&header, sizeof(header), 1, fp) == 1;
+    }
+
+    if (fclose(fp) != 0 || !ok) {
+        graph_rebuild();
+    }
+
+    return graph_load();
+}
+
+
+/*
+ * ─────────── GENERATION-ORDER WALKS ───────────
+ *
+ * The walk below goes through the graph newest → oldest using a
+ * small MAX-HEAP ordered by generation number (a priority queue).
+ * Popping the highest generation first means every child is
+ * handled before any of its parents.
+ */
+
+/* Pops first: higher generation, then (same level) the newer commit */
+static int heap_above(uint32_t a, uint32_t b) {
+    if (g_entries[a].generation != g_entries[b].generation) {
+        return g_entries[a].generation > g_entries[b].generation;
+    }
+    return a > b;
+}
+
+static int heap_push(GenHeap* h, uint32_t pos) {
+    if (h->size == h->capacity) {
+        int new_capacity = h->capacity ? h->capacity * 2 : 32;
+        uint32_t* grown = realloc(h->items, new_capacity * sizeof(uint32_t));
+        if (!grown) return -1;
+        h->items = grown;
+        h->capacity = new_capacity;
+    }
+
+    /* Sift up: swap with parent while we have a higher generation */
+    int i = h->size++;
+    while (i > 0) {
+        int up = (i - 1) / 2;
+        if (!heap_above(pos, h->items[up])) break;
+        h->items[i] = h->items[up];
+        i = up;
+    }
+    h->items[i] = pos;
+    return 0;
+}
+
+static uint32_t heap_pop(GenHeap* h) {
+    uint32_t top = h->items[0];
+    uint32_t last = h->items[--h->size];
+
+    /* Sift down: move the last item into place from the root */
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= h->size) break;
+        if (child + 1 < h->size && heap_above(h->items[child + 1], h->items[child])) {
+            child++;
+        }
+        if (!heap_above(h->items[child], last)) break;
+        h->items[i] = h->items[child];
+        i = child;
+    }
+    if (h->size > 0) h->items[i] = last;
+    return top;
+}
+
+
+/*
+ * FUNCTION: graph_walk_start / graph_walk_next / graph_walk_end
+ * ─────────────────────────────────────────────────────────────
+ * Hands out every commit reachable from some tips, one at a
+ * time, children before parents ("log --graph --all"):
+ *
+ *   GraphWalk walk;
+ *   graph_walk_start(&walk, tips, tip_count);
+ *   while ((id = graph_walk_next(&walk)) > 0) { ... }
+ *   graph_walk_end(&walk);
+ *
+ * Only the FRONTIER (commits whose children were handed out but
+ * which weren't themselves yet) sits in the heap, so the first
+ * commits come out right away, however big the history.
+ *
+ * RETURNS (start): 0 → Success, -1 → no graph / out of memory
+ */
+int graph_walk_start(GraphWalk* walk, const int* tips, int count) {
+    walk->heap.items = NULL;
+    walk->heap.size = 0;
+    walk->heap.capacity = 0;
+    walk->seen = NULL;
+
+    if (g_count < 0 && graph_load() != 0) {
+        return -1;
+    }
+    if (g_count == 0) {
+        return 0;
+    }
+
+    walk->seen = calloc(g_count, 1);
+    if (!walk->seen) {
+        return -1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (graph_entry(tips[i]) && !walk->seen[tips[i] - 1]) {
+            walk->seen[tips[i] - 1] = 1;
+            if (heap_push(&walk->heap, (uint32_t)(tips[i] - 1)) != 0) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int graph_walk_next(GraphWalk* walk) {
+    if (walk->heap.size == 0) {
+        return 0;
+    }
+
+    uint32_t pos = heap_pop(&walk->heap);
+
+    for (int p = 0; p < 2; p++) {
+        uint32_t parent = g_entries[pos].parents[p];
+        if (parent != GRAPH_NO_PARENT && !walk->seen[parent]) {
+            walk->seen[parent] = 1;
+            heap_push(&walk->heap, parent);
+        }
+    }
+    return (int)pos + 1;
+}
+
+void graph_walk_end(GraphWalk* walk) {
+    free(walk->heap.items);
+    free(walk->seen);
+    walk->heap.items = NULL;
+    walk->seen = NULL;
+}
+
+
+/*
+ * FUNCTION: commit_root_tree
+ * ──────────────────────────
+ * The FULL snapshot of any commit, as one root tree id.
+ *
+ * Normally one array lookup in the graph. Only if the graph
+ * couldn't be loaded do we go to commits.dat — and for old
+ * FILES:-style commits fold every ancestor along the way.
+ */
+unsigned long commit_root_tree(int commit_id) {
+    const GraphEntry* e = graph_entry(commit_id);
+    if (e) {
+        return (unsigned long)e->tree;
+    }
+
+    CommitStore store;
+    store_open(&store);
+
+    CommitRecord rec;
+    unsigned long tree = 0;
+    TextView tree_text;
+
+    if (store_find_commit(&store, commit_id, &rec)) {
+        if (record_field(&rec, "TREE", &tree_text)) {
+            tree = (unsigned long)view_to_ll(tree_text, 0);
+        } else {
+            int parent = (int)record_int_field(&rec, "PARENT", -1);
+            unsigned long parent_tree = parent > 0 && parent < commit_id ? commit_root_tree(parent) : 0;
+            tree = legacy_commit_tree(&rec, parent_tree);
+        }
+    }
+
+    store_close(&store);
+    return tree;
+}
+
+
+/*
+ * FUNCTION: graph_may_touch
+ * ─────────────────────────
+ * Asks the commit's Bloom filter about a path.
+ * RETURNS: 0 → definitely NOT changed, 1 → maybe changed
+ */
+int graph_may_touch(int commit_id, const char* path) {
+    const GraphEntry* e = graph_entry(commit_id);
+    if (!e) {
+        return 1;
+    }
+
+    /* "./src/" and "src" are the same path */
+    while (strncmp(path, "./", 2) == 0) path += 2;
+    size_t len = strlen(path);
+    while (len > 0 && path[len - 1] == '/') len--;
+
+    uint32_t pos[BLOOM_HASHES];
+    bloom_positions(path, len, pos);
+
+    for (int i = 0; i < BLOOM_HASHES; i++) {
+        if (!((e->bloom[pos[i] / 64] >> (pos[i] % 64)) & 1)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+/*
+ * FUNCTION: commit_touches_path
+ * ─────────────────────────────
+ * Exact answer to "did this commit change <path>?"
+ *
+ *   1. Bloom filter says no → done, nothing opened
+ *   2. Otherwise compare what <path> points to in the
+ *      commit's tree vs. its parent's tree
+ *
+ * RETURNS: 1 → changed, 0 → not changed
+ */
+int commit_touches_path(int commit_id, const char* path) {
+    if (!graph_may_touch(commit_id, path)) {
+        return 0;
+    }
+
+    while (strncmp(path, "./", 2) == 0) path += 2;
+
+    unsigned long mine = tree_lookup_path(commit_root_tree(commit_id), path);
+    int parent_id = graph_parent_id(commit_id);
+    unsigned long theirs = parent_id > 0 ? tree_lookup_path(commit_root_tree(parent_id), path) : 0;
+
+    return mine != theirs;
+}
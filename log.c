@@ -1,6 +1,944 @@
+/*
+ * ============================================
+ *          MYGIT - Log Command
+ *          "mygit log [branch] [options]"
+ * ============================================
+ *
+ * PURPOSE:
+ *   Show the history of a branch, newest first:
+ *
+ *     commit #12
+ *     Date:   2026-10-16 14:30:00 +0200
+ *
+ *         Fix the parser
+ *
+ * OPTIONS:
+ *   -n <N>           only the N newest commits
+ *   --since <date>   stop at commits older than <date>
+ *   --until <date>   skip commits newer than <date>
+ *   --grep <words>   only commits whose message has every word
+ *                    ("inc-47*" = any word starting with inc-47)
+ *   --stat           lines added/removed per file, per commit
+ *   --graph          one line per commit, with branch lanes
+ *   --all            (with --graph) every branch, not just one
+ *   -- <path>        only commits that changed <path>
+ *
+ *   <date> is "YYYY-MM-DD" or "YYYY-MM-DD HH:MM:SS".
+ *
+ *   "What was on main at 03:00?" is
+ *     mygit log main --until "2026-10-15 03:00:00" -n 1
+ *
+ * HOW IT WALKS:
+ *   This is the linked list again — start at the branch tip and
+ *   follow parent pointers:
+ *
+ *     tip (#12) → #11 → #10 → ... → #1 → (none)
+ *
+ *   Every step is O(1): the parent comes from the commit-graph
+ *   (an array lookup) and the commit text from commits.dat via
+ *   the mapped commit index. Nothing is collected into a
+ *   list first, so:
+ *
+ *     - memory stays the same for 10 or 10 million commits
+ *     - "log -n 10" reads 10 commits, not the whole history
+ *     - output starts immediately, commit by commit
+ *
+ * EARLY EXIT:
+ *   "mygit log | head -5": once head has its 5 lines it closes
+ *   the pipe. Our next write fails, and we stop right there
+ *   instead of walking the rest of history into the void.
+ *
+ * --stat IN PARALLEL:
+ *   Diffing a commit against its parent is the slow part, and
+ *   every commit's diff is independent. So the walk hands them
+ *   to a worker pool (pool.c) and keeps printing in order:
+ *
+ *     window:  [#12 ✓] [#11 …] [#10 ✓] [#9 …]   ← at most W queued
+ *                 ↑ printed next, as soon as it is done
+ *
+ *   Only W commits are ever in flight, so memory stays flat no
+ *   matter how long the history is, and output still streams.
+ */
+
 #include "mygit.h"
 
-int mygit_log(void) {
-    printf(YELLOW "📜 [Coming Day 4] Will show commit history\n" RESET);
+/*
+ * FUNCTION: commit_time
+ * ─────────────────────
+ * When was commit #id made? The graph has it as a number, so
+ * filtering by date never touches commits.dat. Without a graph
+ * we read the record's TIME line.
+ */
+static time_t commit_time(const CommitStore* store, int id) {
+    const GraphEntry* e = graph_entry(id);
+    if (e) {
+        return (time_t)e->time;
+    }
+
+    CommitRecord rec;
+    TextView time_text;
+    if (store_find_commit(store, id, &rec) && record_field(&rec, "TIME", &time_text)) {
+        return parse_commit_time(time_text, NULL);
+    }
+    return 0;
+}
+
+
+/*
+ * FUNCTION: commit_parent
+ * ───────────────────────
+ * Parent of commit #id, -1 for the first commit.
+ */
+static int commit_parent(const CommitStore* store, int id) {
+    if (graph_entry(id)) {
+        return graph_parent_id(id);
+    }
+
+    CommitRecord rec;
+    if (store_find_commit(store, id, &rec)) {
+        return (int)record_int_field(&rec, "PARENT", -1);
+    }
+    return -1;
+}
+
+
+/* ─────────── one commit, in each format ─────────── */
+
+typedef struct FileStat {
+    char* path;
+    DiffStat stat;                   // lines, or sizes if binary
+} FileStat;
+
+typedef struct StatJob {
+    PoolTask task;                   // first member (see pool.c)
+    int id;
+    unsigned long old_tree;          // parent's snapshot
+    unsigned long new_tree;          // this commit's snapshot
+    FileStat* files;
+    int count;
+    int capacity;
+    int failed;
+} StatJob;
+
+
+/* A note for people ("No matching commits.") — scripts get nothing */
+static void log_note(const char* text) {
+    if (out_format() == OUT_HUMAN) {
+        out_color(YELLOW);
+        out_str(text);
+        out_color(RESET);
+        out_char('\n');
+    }
+}
+
+
+/*
+ * FUNCTION: print_stat_human
+ * ──────────────────────────
+ *    src/parser.c | 12 ++++++++----
+ *    fw.bin       | Bin 65536 -> 65540 bytes
+ *    2 files changed, 8 insertions(+), 4 deletions(-)
+ */
+static void print_stat_human(const StatJob* job) {
+    if (job->failed) {
+        out_color(RED);
+        out_str("    (could not read the objects of commit #");
+        out_int(job->id);
+        out_str(")\n\n");
+        out_color(RESET);
+        return;
+    }
+    if (job->count == 0) {
+        return;
+    }
+
+    int width = 0;
+    long most = 0;
+    long added = 0, removed = 0;
+    for (int i = 0; i < job->count; i++) {
+        const DiffStat* s = &job->files[i].stat;
+        int len = (int)strlen(job->files[i].path);
+        if (len > width) width = len;
+        if (s->added + s->removed > most) {
+            most = s->added + s->removed;
+        }
+        added += s->added;
+        removed += s->removed;
+    }
+    if (width > 50) width = 50;
+
+    int digits = 1;
+    for (long n = most; n >= 10; n /= 10) digits++;
+
+    const int bar_max = 40;
+    for (int i = 0; i < job->count; i++) {
+        const FileStat* f = &job->files[i];
+        const DiffStat* s = &f->stat;
+        long total = s->added + s->removed;
+
+        out_char(' ');
+        out_padded(f->path, width);
+        out_str(" | ");
+
+        if (s->binary) {
+            out_str("Bin ");
+            out_int(s->old_size);
+            out_str(" -> ");
+            out_int(s->new_size);
+            out_str(" bytes\n");
+            continue;
+        }
+
+        /* Scale the bar down when a file changed a lot */
+        long plus = s->added, minus = s->removed;
+        if (most > bar_max) {
+            plus = (s->added * bar_max + most - 1) / most;
+            minus = (s->removed * bar_max + most - 1) / most;
+        }
+
+        int total_digits = 1;
+        for (long n = total; n >= 10; n /= 10) total_digits++;
+        for (int d = total_digits; d < digits; d++) out_char(' ');
+        out_int(total);
+        out_char(' ');
+
+        out_color(GREEN);
+        for (long k = 0; k < plus; k++) out_char('+');
+        out_color(RED);
+        for (long k = 0; k < minus; k++) out_char('-');
+        out_color(RESET);
+        out_char('\n');
+    }
+
+    out_char(' ');
+    out_int(job->count);
+    out_str(job->count == 1 ? " file changed, " : " files changed, ");
+    out_int(added);
+    out_str(added == 1 ? " insertion(+), " : " insertions(+), ");
+    out_int(removed);
+    out_str(removed == 1 ? " deletion(-)\n\n" : " deletions(-)\n\n");
+}
+
+
+/*
+ * FUNCTION: print_commit
+ * ──────────────────────
+ * Writes one commit — plus its --stat, if `stat` isn't NULL —
+ * in the chosen format (see output.c):
+ *
+ *   human      commit #12
+ *              Date:   2026-10-16 14:30:00 +0200
+ *              ...
+ *   porcelain  commit<TAB>12<TAB>11<TAB>1736947845<TAB>+0200<TAB>Fix parser
+ *              file<TAB>8<TAB>4<TAB>src/parser.c         (--stat)
+ *              file<TAB>-<TAB>-<TAB>fw.bin               (binary)
+ *              (parent 0 = none, time = seconds since 1970)
+ *   json       {"id":12,"parent":11,"time":1736947845,"tz":"+0200",
+ *               "message":"Fix parser",
+ *               "files":[{"path":"src/parser.c","added":8,"removed":4}]}
+ *              a binary file has "added":null,"removed":null,
+ *              "binary":true,"old_size":65536,"new_size":65540
+ *
+ * The message is copied straight out of the mapped commits.dat.
+ * The date is the committer's own clock.
+ *
+ * RETURNS: 0 → printed, -1 → the record is missing
+ */
+static int print_commit(const CommitStore* store, int id, const StatJob* stat) {
+    CommitRecord rec;
+    if (!store_find_commit(store, id, &rec)) {
+        out_flush();
+        printf(RED "✗ Commit #%d is missing from %s\n" RESET, id, COMMITS_FILE);
+        return -1;
+    }
+
+    /* "2026-10-16 14:30:00 +0200" — the offset starts at [20] */
+    char time_text[64] = "";
+    time_t when = 0;
+    TextView field;
+    if (record_field(&rec, "TIME", &field)) {
+        int tz_minutes;
+        when = parse_commit_time(field, &tz_minutes);
+        format_timestamp_tz(when, tz_minutes, time_text, sizeof(time_text));
+    }
+    const char* tz = strlen(time_text) > 20 ? time_text + 20 : "+0000";
+
+    TextView message = { "", 0 };
+    record_field(&rec, "MSG", &message);
+
+    int parent = commit_parent(store, id);
+
+    switch (out_format()) {
+    case OUT_HUMAN:
+        out_color(YELLOW);
+        out_str("commit #");
+        out_int(id);
+        out_color(RESET);
+        out_str("\nDate:   ");
+        out_str(time_text);
+        out_str("\n\n    ");
+        out_view(message);
+        out_str("\n\n");
+        if (stat) {
+            print_stat_human(stat);
+        }
+        break;
+
+    case OUT_PORCELAIN:
+        out_str("commit\t");
+        out_int(id);
+        out_char('\t');
+        out_int(parent > 0 ? parent : 0);
+        out_char('\t');
+        out_int((long long)when);
+        out_char('\t');
+        out_str(tz);
+        out_char('\t');
+        out_view(message);
+        out_end_record();
+
+        for (int i = 0; stat && !stat->failed && i < stat->count; i++) {
+            const DiffStat* s = &stat->files[i].stat;
+            out_str("file\t");
+            if (s->binary) {
+                out_str("-\t-\t");             // no lines, like git's numstat
+            } else {
+                out_int(s->added);
+                out_char('\t');
+                out_int(s->removed);
+                out_char('\t');
+            }
+            out_str(stat->files[i].path);
+            out_end_record();
+        }
+        break;
+
+    case OUT_JSON:
+        out_str("{\"id\":");
+        out_int(id);
+        out_json_key("parent");
+        if (parent > 0) out_int(parent); else out_str("null");
+        out_json_key("time");
+        out_int((long long)when);
+        out_json_key("tz");
+        out_json_string(tz, strlen(tz));
+        out_json_key("message");
+        out_json_string(message.data, message.len);
+
+        if (stat) {
+            out_json_key("files");
+            if (stat->failed) {
+                out_str("null");
+            } else {
+                out_char('[');
+                for (int i = 0; i < stat->count; i++) {
+                    out_str(i ? ",{\"path\":" : "{\"path\":");
+                    out_json_string(stat->files[i].path, strlen(stat->files[i].path));
+                    const DiffStat* s = &stat->files[i].stat;
+                    if (s->binary) {
+                        out_str(",\"added\":null,\"removed\":null,\"binary\":true");
+                        out_json_key("old_size");
+                        out_int(s->old_size);
+                        out_json_key("new_size");
+                        out_int(s->new_size);
+                    } else {
+                        out_json_key("added");
+                        out_int(s->added);
+                        out_json_key("removed");
+                        out_int(s->removed);
+                    }
+                    out_char('}');
+                }
+                out_char(']');
+            }
+        }
+        out_char('}');
+        out_end_record();
+        break;
+    }
+    return 0;
+}
+
+
+/* ─────────── --stat ─────────── */
+
+typedef struct StatWindow {
+    WorkPool* pool;
+    StatJob* jobs;                   // ring buffer of `size` jobs
+    int size;
+    int head;                        // oldest job = next to print
+    int queued;
+} StatWindow;
+
+
+/* tree_diff callback: one changed file → one FileStat */
+static void stat_file(const char* path, unsigned long old_hash, unsigned long new_hash, void* ctx) {
+    StatJob* job = ctx;
+
+    if (job->count == job->capacity) {
+        int capacity = job->capacity ? job->capacity * 2 : 8;
+        FileStat* grown = realloc(job->files, capacity * sizeof(FileStat));
+        if (!grown) {
+            job->failed = 1;
+            return;
+        }
+        job->files = grown;
+        job->capacity = capacity;
+    }
+
+    FileStat* f = &job->files[job->count];
+    f->path = strdup(path);
+    if (!f->path || diffstat_blobs(old_hash, new_hash, &f->stat) != 0) {
+        free(f->path);
+        job->failed = 1;
+        return;
+    }
+    job->count++;
+}
+
+
+/*
+ * FUNCTION: stat_run
+ * ──────────────────
+ * Runs on a worker thread. tree_diff only reports files whose
+ * blob hash differs between the two snapshots — identical
+ * files (and whole identical directories) are never read.
+ */
+static void stat_run(PoolTask* task) {
+    StatJob* job = (StatJob*)task;
+    if (tree_diff(job->old_tree, job->new_tree, stat_file, job) != 0) {
+        job->failed = 1;
+    }
+}
+
+
+static void stat_clear(StatJob* job) {
+    for (int i = 0; i < job->count; i++) {
+        free(job->files[i].path);
+    }
+    free(job->files);
+    memset(job, 0, sizeof(*job));
+}
+
+
+/*
+ * FUNCTION: stat_queue
+ * ────────────────────
+ * Puts commit #id into the window. The snapshots are looked
+ * up here on the main thread (they come from the shared
+ * commit-graph); the worker only reads object files.
+ */
+static void stat_queue(StatWindow* window, const CommitStore* store, int id) {
+    StatJob* job = &window->jobs[(window->head + window->queued) % window->size];
+    int parent = commit_parent(store, id);
+
+    memset(job, 0, sizeof(*job));
+    job->task.run = stat_run;
+    job->id = id;
+    job->old_tree = parent > 0 ? commit_root_tree(parent) : 0;
+    job->new_tree = commit_root_tree(id);
+
+    pool_submit(window->pool, &job->task);
+    window->queued++;
+}
+
+
+/*
+ * FUNCTION: stat_flush_one
+ * ────────────────────────
+ * Waits for the OLDEST job in the window and prints it, so
+ * output stays newest-first however the workers finish.
+ *
+ * RETURNS: 0 → printed, -1 → couldn't print (stop walking)
+ */
+static int stat_flush_one(StatWindow* window, const CommitStore* store) {
+    StatJob* job = &window->jobs[window->head];
+    pool_wait(window->pool, &job->task);
+
+    int rc = print_commit(store, job->id, job);
+    stat_clear(job);
+
+    window->head = (window->head + 1) % window->size;
+    window->queued--;
+    return rc == 0 && !out_failed() ? 0 : -1;
+}
+
+
+/* ─────────── --graph ─────────── */
+
+/*
+ * HOW THE LANES WORK:
+ *   Commits come out of graph_walk_next() children-first. Each
+ *   lane (column) remembers which commit it is WAITING for —
+ *   the parent of the last commit drawn in it:
+ *
+ *     * #5 (feature) ...      lanes: [#3]      → then [#3, ...]
+ *     | * #4 (main) ...       lanes: [#3, #3]  (both wait for #3)
+ *     |/
+ *     * #3 ...                lanes: [#2]
+ *
+ *   A commit goes in the lane waiting for it (or a new one).
+ *   Other lanes waiting for the same commit end here — that
+ *   is where the branches forked ("|/"). A second parent opens
+ *   a new lane ("|\").
+ *
+ *   Only the lanes and the walk's frontier are kept, so each
+ *   commit costs O(lanes), and nothing is laid out in advance.
+ */
+
+typedef struct Lanes {
+    int* waiting;                    // commit id per column, 0 = free
+    int count;
+    int capacity;
+} Lanes;
+
+/* A new column on the right */
+static int lane_open(Lanes* lanes) {
+    if (lanes->count == lanes->capacity) {
+        int capacity = lanes->capacity ? lanes->capacity * 2 : 8;
+        int* grown = realloc(lanes->waiting, capacity * sizeof(int));
+        if (!grown) return -1;
+        lanes->waiting = grown;
+        lanes->capacity = capacity;
+    }
+    lanes->waiting[lanes->count] = 0;
+    return lanes->count++;
+}
+
+static int lane_find(const Lanes* lanes, int id) {
+    for (int i = 0; i < lanes->count; i++) {
+        if (lanes->waiting[i] == id) return i;
+    }
+    return -1;
+}
+
+/* One row of lane marks: `mark` in column `col`, '|' in busy ones */
+static void lane_row(const Lanes* lanes, int col, char mark) {
+    for (int i = 0; i < lanes->count; i++) {
+        if (i == col && mark == '*') {
+            out_color(YELLOW);
+            out_char('*');
+            out_color(RESET);
+        } else {
+            out_char(i == col ? mark : lanes->waiting[i] ? '|' : ' ');
+        }
+        out_char(' ');
+    }
+}
+
+
+/* Does lane i end here? (free, or a duplicate of lane `keep`) */
+static int lane_ends(const Lanes* lanes, int i, int keep) {
+    int w = lanes->waiting[i];
+    return w == 0 || (keep >= 0 && i != keep && w == lanes->waiting[keep]);
+}
+
+
+/*
+ * FUNCTION: lanes_collapse
+ * ────────────────────────
+ * Closes the lanes that end here — free ones, and (if keep >= 0)
+ * other lanes waiting for the same commit as lane `keep` — and
+ * slides everything right of them to the left:
+ *
+ *   | * |           lanes 0 and 1 both wait for #3,
+ *   | / /     ←     lane 1 joins lane 0, lane 2 moves over
+ *   * |
+ *
+ * Prints the connecting row only when something moves.
+ */
+static void lanes_collapse(Lanes* lanes, int keep) {
+    int gone = 0;
+    int draw = 0;
+
+    for (int i = 0; i < lanes->count; i++) {
+        if (lane_ends(lanes, i, keep)) {
+            gone++;
+            if (lanes->waiting[i] != 0) draw = 1;    // a join
+        } else if (gone > 0) {
+            draw = 1;                                // a lane moves left
+        }
+    }
+    if (gone == 0) {
+        return;
+    }
+
+    if (draw) {
+        gone = 0;
+        for (int i = 0; i < lanes->count; i++) {
+            char c;
+            if (lane_ends(lanes, i, keep)) {
+                c = lanes->waiting[i] ? '/' : ' ';
+                gone++;
+            } else {
+                c = gone > 0 ? '/' : '|';
+            }
+            out_char(c);
+            out_char(' ');
+        }
+        out_char('\n');
+    }
+
+    int kept = 0;
+    int keep_id = keep >= 0 ? lanes->waiting[keep] : 0;
+    for (int i = 0; i < lanes->count; i++) {
+        int w = lanes->waiting[i];
+        if (!(w == 0 || (keep >= 0 && i != keep && w == keep_id))) {
+            lanes->waiting[kept++] = w;
+        }
+    }
+    lanes->count = kept;
+}
+
+
+/* "(main, ci/build-7)" for commits that are a branch tip */
+static void print_decoration(const RefInfo* refs, int ref_count, int id) {
+    int first = 1;
+    for (int i = 0; i < ref_count; i++) {
+        if (refs[i].id == id) {
+            if (first) {
+                out_color(CYAN);
+                out_char('(');
+            } else {
+                out_str(", ");
+            }
+            out_str(refs[i].name);
+            first = 0;
+        }
+    }
+    if (!first) {
+        out_char(')');
+        out_color(RESET);
+        out_char(' ');
+    }
+}
+
+
+static void print_graph_line(const CommitStore* store, const RefInfo* refs, int ref_count, int id) {
+    CommitRecord rec;
+    TextView message = { "", 0 };
+    char time_text[64] = "";
+
+    if (store_find_commit(store, id, &rec)) {
+        TextView field;
+        if (record_field(&rec, "TIME", &field)) {
+            int tz_minutes;
+            time_t when = parse_commit_time(field, &tz_minutes);
+            format_timestamp_tz(when, tz_minutes, time_text, sizeof(time_text));
+            time_text[16] = '\0';   // "YYYY-MM-DD HH:MM"
+        }
+        record_field(&rec, "MSG", &message);
+    }
+
+    out_color(YELLOW);
+    out_char('#');
+    out_int(id);
+    out_color(RESET);
+    out_char(' ');
+    print_decoration(refs, ref_count, id);
+    out_str(time_text);
+    out_str("  ");
+    out_view(message);
+    out_char('\n');
+}
+
+
+/*
+ * FUNCTION: log_graph
+ * ───────────────────
+ * "mygit log --graph [--all] [branch] [-n N]"
+ */
+static int log_graph(const LogOptions* options, int tip) {
+    int ref_count = 0;
+    RefInfo* refs = refs_list(&ref_count);
+
+    /* Where to start: one branch, or every branch */
+    int* tips = malloc((ref_count + 1) * sizeof(int));
+    int tip_count = 0;
+    if (!tips) {
+        free(refs);
+        return 1;
+    }
+    if (options->all) {
+        for (int i = 0; i < ref_count; i++) {
+            if (refs[i].id > 0) tips[tip_count++] = refs[i].id;
+        }
+    } else {
+        tips[tip_count++] = tip;
+    }
+
+    GraphWalk walk;
+    if (graph_walk_start(&walk, tips, tip_count) != 0) {
+        printf(RED "✗ Could not load %s\n" RESET, GRAPH_FILE);
+        free(tips);
+        free(refs);
+        return 1;
+    }
+    free(tips);
+
+    CommitStore store;
+    store_open(&store);
+
+    Lanes lanes = { NULL, 0, 0 };
+    int shown = 0;
+    int id;
+
+    while ((id = graph_walk_next(&walk)) > 0) {
+        if (options->limit > 0 && shown >= options->limit) {
+            break;
+        }
+
+        /* The lane waiting for this commit (others waiting for it
+         * end here — that is where they branched off) */
+        int col = lane_find(&lanes, id);
+        if (col >= 0) {
+            lanes_collapse(&lanes, col);
+            col = lane_find(&lanes, id);
+        } else if ((col = lane_open(&lanes)) < 0) {
+            break;
+        }
+
+        lanes.waiting[col] = id;
+        lane_row(&lanes, col, '*');
+        print_graph_line(&store, refs, ref_count, id);
+        shown++;
+
+        /* This lane now waits for the first parent */
+        const GraphEntry* e = graph_entry(id);
+        lanes.waiting[col] = e->parents[0] != GRAPH_NO_PARENT ? (int)e->parents[0] + 1 : 0;
+
+        /* A merge: the second parent gets a lane of its own */
+        if (e->parents[1] != GRAPH_NO_PARENT) {
+            int second = (int)e->parents[1] + 1;
+            int fork = lane_find(&lanes, second) < 0 ? lane_open(&lanes) : -1;
+            if (fork >= 0) {
+                lane_row(&lanes, fork, '\\');
+                out_char('\n');
+                lanes.waiting[fork] = second;
+            }
+        }
+
+        /* A branch that started here leaves a hole → close it */
+        lanes_collapse(&lanes, -1);
+
+        if (out_failed()) {
+            break;
+        }
+    }
+
+    free(lanes.waiting);
+    store_close(&store);
+    graph_walk_end(&walk);
+    free(refs);
+    return 0;
+}
+
+
+static int compare_ids(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+
+/*
+ * ═══════════════════════════════════════════════
+ * MAIN FUNCTION: mygit_log
+ * ═══════════════════════════════════════════════
+ */
+int mygit_log(const LogOptions* options) {
+
+    /*
+     * ──────────────────────────────────
+     * STEP 1: Where do we start?
+     * ──────────────────────────────────
+     */
+    char branch[MAX_PATH];
+    if (options->branch) {
+        int tip;
+        if (!ref_read(options->branch, &tip)) {
+            printf(RED "✗ No branch named '%s'\n" RESET, options->branch);
+            return 1;
+        }
+        strncpy(branch, options->branch, sizeof(branch) - 1);
+        branch[sizeof(branch) - 1] = '\0';
+    } else {
+        get_current_branch(branch, sizeof(branch));
+    }
+
+    int id = get_last_commit_id_on_branch(branch);
+    if (id <= 0) {
+        if (out_format() == OUT_HUMAN) {
+            printf(YELLOW "No commits yet on '%s'.\n" RESET, branch);
+        }
+        return 0;
+    }
+
+    if (options->graph) {
+        if (options->since || options->until || options->grep || options->path || options->stat) {
+            printf(RED "✗ --graph only combines with -n and --all\n" RESET);
+            return 1;
+        }
+        if (out_format() != OUT_HUMAN) {
+            printf(RED "✗ --graph is a picture — use it without --format\n" RESET);
+            return 1;
+        }
+        return log_graph(options, id);
+    }
+
+    /*
+     * ──────────────────────────────────
+     * STEP 2: Narrow down a date range
+     * ──────────────────────────────────
+     * The time index (timeindex.c) turns --since/--until into
+     * the ids of every commit in the range. A parent always has
+     * a smaller id than its child, so on the way down we can
+     * skip everything above the largest id without looking, and
+     * stop as soon as we pass below the smallest.
+     */
+    int skip_above = id;
+    int stop_below = 0;
+
+    if (options->since || options->until) {
+        int min_id, max_id;
+        int in_range = time_index_range(options->since, options->until, &min_id, &max_id);
+
+        if (in_range == 0) {
+            log_note("No matching commits.");
+            return 0;
+        }
+        if (in_range > 0) {
+            skip_above = max_id;
+            stop_below = min_id;
+        }
+    }
+
+    /*
+     * ──────────────────────────────────
+     * STEP 3: Narrow down by message
+     * ──────────────────────────────────
+     * --grep is answered up front as a sorted list of ids — from
+     * the message index (msgindex.c) if there is one, otherwise
+     * by one vectorized pass over commits.dat (search.c). The
+     * list bounds the walk the same way the date range does.
+     */
+    GrepQuery query;
+    int* matches = NULL;
+    int match_count = 0;
+
+    if (options->grep) {
+        if (grep_parse(options->grep, &query) != 0) {
+            printf(RED "✗ Nothing to search for in '%s'\n" RESET, options->grep);
+            return 1;
+        }
+
+        match_count = msgindex_search(&query, &matches);
+        if (match_count < 0) {
+            match_count = grep_scan_commits(&query, &matches);
+        }
+        if (match_count < 0) {
+            printf(RED "✗ Out of memory searching commit messages\n" RESET);
+            return 1;
+        }
+        if (match_count == 0) {
+            log_note("No matching commits.");
+            free(matches);
+            return 0;
+        }
+        if (matches[match_count - 1] < skip_above) skip_above = matches[match_count - 1];
+        if (matches[0] > stop_below) stop_below = matches[0];
+    }
+
+    /*
+     * ──────────────────────────────────
+     * STEP 4: Walk and print
+     * ──────────────────────────────────
+     */
+    CommitStore store;
+    store_open(&store);
+
+    StatWindow window;
+    memset(&window, 0, sizeof(window));
+
+    if (options->stat) {
+        int threads = pool_cpu_count();
+        window.size = threads * 4;
+        window.jobs = calloc(window.size, sizeof(StatJob));
+        if (!window.jobs) {
+            printf(RED "✗ Out of memory\n" RESET);
+            store_close(&store);
+            free(matches);
+            return 1;
+        }
+        window.pool = pool_start(threads);
+    }
+
+    int shown = 0;
+
+    for (; id > 0 && id >= stop_below; id = commit_parent(&store, id)) {
+        if (options->limit > 0 && shown >= options->limit) {
+            break;
+        }
+        if (id > skip_above) {
+            continue;
+        }
+
+        if (options->since || options->until) {
+            time_t when = commit_time(&store, id);
+            if ((options->since && when < options->since)
+                || (options->until && when > options->until)) {
+                continue;
+            }
+        }
+
+        if (options->grep && !bsearch(&id, matches, match_count, sizeof(int), compare_ids)) {
+            continue;
+        }
+
+        if (options->path && !commit_touches_path(id, options->path)) {
+            continue;
+        }
+
+        if (options->stat) {
+            if (window.queued == window.size && stat_flush_one(&window, &store) != 0) {
+                break;
+            }
+            stat_queue(&window, &store, id);
+            shown++;
+            continue;
+        }
+
+        if (print_commit(&store, id, NULL) != 0) {
+            break;
+        }
+        shown++;
+
+        /* The reader went away (closed pipe, full disk) → stop */
+        if (out_failed()) {
+            break;
+        }
+    }
+
+    /* Print what is still in the window (or just let it finish
+     * if the reader is gone) */
+    while (window.queued > 0) {
+        if (out_failed()) {
+            pool_wait(window.pool, &window.jobs[window.head].task);
+            stat_clear(&window.jobs[window.head]);
+            window.head = (window.head + 1) % window.size;
+            window.queued--;
+        } else {
+            stat_flush_one(&window, &store);
+        }
+    }
+    pool_stop(window.pool);
+    free(window.jobs);
+
+    store_close(&store);
+    free(matches);
+
+    if (shown == 0 && !out_failed()) {
+        log_note("No matching commits.");
+    }
     return 0;
-}
\ No newline at end of file
+}
@@ -17,6 +17,16 @@
 
 int main(int argc, char* argv[]) {
 
+#ifdef __GLIBC__
+    /*
+     * Without TZ, glibc checks /etc/localtime again on EVERY
+     * mktime()/localtime() — a file system call per commit when
+     * log shows old-style dates. Naming the file once (what an
+     * unset TZ means anyway) makes it read it a single time.
+     */
+    setenv("TZ", ":/etc/localtime", 0);
+#endif
+
     // No command given → show help
     if (argc < 2) {
         print_banner();
@@ -42,6 +52,31 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    /*
+     * Finish any commit that was interrupted by a crash
+     * before anything reads commits.dat (see wal.c).
+     */
+    wal_recover();
+
+    /*
+     * Map the binary commit-graph once, up front.
+     * History walks (log, checkout, ...) read parents from it
+     * instead of re-parsing commits.dat every time.
+     */
+    graph_load();
+
+    /*
+     * Commands that scripts read take --format=... and -z
+     * (see output.c). They are removed from argv here, so the
+     * option parsing below never sees them.
+     */
+    if (strcmp(command, "log") == 0 || strcmp(command, "status") == 0
+        || strcmp(command, "branch") == 0 || strcmp(command, "diff") == 0) {
+        if (out_setup(&argc, argv) != 0) {
+            return 1;
+        }
+    }
+
     /* ─── ADD ─── */
     if (strcmp(command, "add") == 0) {
         if (argc < 3) {
@@ -62,7 +97,45 @@ int main(int argc, char* argv[]) {
 
     /* ─── LOG ─── */
     else if (strcmp(command, "log") == 0) {
-        return mygit_log();
+        LogOptions options;
+        memset(&options, 0, sizeof(options));
+
+        for (int i = 2; i < argc; i++) {
+            const char* arg = argv[i];
+            const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+
+            if (strcmp(arg, "-n") == 0 && value) {
+                options.limit = atoi(value);
+                i++;
+            } else if ((strcmp(arg, "--since") == 0 || strcmp(arg, "--until") == 0) && value) {
+                int until = arg[2] == 'u';
+                time_t when = parse_date_arg(value, until);
+                if (when == 0) {
+                    printf(RED "✗ Not a date: '%s' (use YYYY-MM-DD [HH:MM[:SS]])\n" RESET, value);
+                    return 1;
+                }
+                if (until) options.until = when; else options.since = when;
+                i++;
+            } else if (strcmp(arg, "--stat") == 0) {
+                options.stat = 1;
+            } else if (strcmp(arg, "--graph") == 0) {
+                options.graph = 1;
+            } else if (strcmp(arg, "--all") == 0) {
+                options.all = 1;
+            } else if (strcmp(arg, "--grep") == 0 && value) {
+                options.grep = value;
+                i++;
+            } else if (strcmp(arg, "--") == 0 && value) {
+                options.path = value;
+                i++;
+            } else if (arg[0] == '-') {
+                printf(RED "✗ Unknown log option: '%s'\n" RESET, arg);
+                return 1;
+            } else {
+                options.branch = arg;
+            }
+        }
+        return mygit_log(&options);
     }
 
     /* ─── STATUS ─── */
@@ -72,11 +145,61 @@ int main(int argc, char* argv[]) {
 
     /* ─── DIFF ─── */
     else if (strcmp(command, "diff") == 0) {
-        if (argc < 3) {
-            printf(RED "✗ Please specify a file: mygit diff <filename>\n" RESET);
-            return 1;
+        DiffOptions options;
+        memset(&options, 0, sizeof(options));
+        options.algorithm = DIFF_MYERS;
+
+        const char* args[2];
+        int arg_count = 0;
+
+        for (int i = 2; i < argc; i++) {
+            const char* arg = argv[i];
+
+            if (strncmp(arg, "--diff-algorithm=", 17) == 0) {
+                const char* name = arg + 17;
+                if (strcmp(name, "myers") == 0) {
+                    options.algorithm = DIFF_MYERS;
+                } else if (strcmp(name, "patience") == 0) {
+                    options.algorithm = DIFF_PATIENCE;
+                } else if (strcmp(name, "histogram") == 0) {
+                    options.algorithm = DIFF_HISTOGRAM;
+                } else {
+                    printf(RED "✗ Unknown diff algorithm '%s' (use myers, patience or histogram)\n" RESET, name);
+                    return 1;
+                }
+            } else if (strcmp(arg, "--cached") == 0 || strcmp(arg, "--staged") == 0) {
+                options.cached = 1;
+            } else if (strcmp(arg, "--") == 0) {
+                if (i + 1 < argc) {
+                    options.path = argv[++i];  // always a path, even "3"
+                }
+            } else if (arg[0] == '-') {
+                printf(RED "✗ Unknown diff option: '%s'\n" RESET, arg);
+                return 1;
+            } else if (arg_count < 2) {
+                args[arg_count++] = arg;
+            } else {
+                printf(RED "✗ Too many arguments: mygit diff [<commit> <commit>] [--] [path]\n" RESET);
+                return 1;
+            }
+        }
+
+        /* One word is a path, two are the commits to compare */
+        if (arg_count == 2) {
+            if (options.cached) {
+                printf(RED "✗ --cached compares staging with HEAD — it takes no commits\n" RESET);
+                return 1;
+            }
+            options.from = args[0];
+            options.to = args[1];
+        } else if (arg_count == 1) {
+            if (options.path) {
+                printf(RED "✗ Give two commits to compare: mygit diff <commit> <commit> -- %s\n" RESET, options.path);
+                return 1;
+            }
+            options.path = args[0];
         }
-        return mygit_diff(argv[2]);
+        return mygit_diff(&options);
     }
 
     /* ─── CHECKOUT ─── */
@@ -96,6 +219,80 @@ int main(int argc, char* argv[]) {
         return mygit_branch(argv[2]);      // with arg → create branch
     }
 
+    /* ─── PACK-REFS ─── */
+    else if (strcmp(command, "pack-refs") == 0) {
+        int packed = refs_pack();
+        if (packed < 0) {
+            printf(RED "✗ Could not write %s\n" RESET, PACKED_REFS_FILE);
+            return 1;
+        }
+        printf(GREEN "✓ Packed %d ref%s\n" RESET, packed, packed == 1 ? "" : "s");
+        return 0;
+    }
+
+    /* ─── GREP ─── */
+    else if (strcmp(command, "grep") == 0) {
+        const char* text = NULL;
+        const char* branch = NULL;       // default: current branch
+        int ignore_case = 0;
+
+        for (int i = 2; i < argc; i++) {
+            if (strcmp(argv[i], "-i") == 0) {
+                ignore_case = 1;
+            } else if (!text) {
+                text = argv[i];
+            } else {
+                branch = argv[i];
+            }
+        }
+        if (!text) {
+            printf(RED "✗ Please specify text to find: mygit grep [-i] <text> [branch]\n" RESET);
+            return 1;
+        }
+        return mygit_grep(text, branch, ignore_case);
+    }
+
+    /* ─── INDEX-MESSAGES ─── */
+    else if (strcmp(command, "index-messages") == 0) {
+        int indexed = msgindex_rebuild();
+        if (indexed < 0) {
+            printf(RED "✗ Could not write %s\n" RESET, MSGINDEX_FILE);
+            return 1;
+        }
+        printf(GREEN "✓ Indexed %d commit message%s\n" RESET, indexed, indexed == 1 ? "" : "s");
+        return 0;
+    }
+
+    /* ─── REFLOG ─── */
+    else if (strcmp(command, "reflog") == 0) {
+        const char* branch = NULL;       // default: current branch
+        int limit = 0;                   // 0 → everything
+
+        for (int i = 2; i < argc; i++) {
+            if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+                limit = atoi(argv[++i]);
+            } else {
+                branch = argv[i];
+            }
+        }
+        return mygit_reflog(branch, limit);
+    }
+
+    /* ─── COUNT-OBJECTS ─── */
+    else if (strcmp(command, "count-objects") == 0) {
+        const char* branch = NULL;
+        int write_bitmaps = 0;
+
+        for (int i = 2; i < argc; i++) {
+            if (strcmp(argv[i], "--write-bitmap") == 0) {
+                write_bitmaps = 1;
+            } else {
+                branch = argv[i];
+            }
+        }
+        return mygit_count_objects(branch, write_bitmaps);
+    }
+
     /* ─── HELP ─── */
     else if (strcmp(command, "help") == 0) {
         print_banner();
@@ -0,0 +1,883 @@
+/*
+ * ============================================
+ *          MYGIT - Message Index
+ *          "mygit log --grep <words>"
+ * ============================================
+ *
+ * QUESTION WE WANT TO ANSWER FAST:
+ *   "Which commits mention INC-4711?" — across millions of
+ *   commit messages.
+ *
+ * WITHOUT AN INDEX:
+ *   Read every MSG: line in commits.dat and look for the word.
+ *
+ * WITH AN INDEX (like the one at the back of a book):
+ *
+ *     word      → commits that contain it ("posting list")
+ *     ───────     ──────────────────────────
+ *     fix       → #2, #5, #9, #10, #31 ...
+ *     inc-4711  → #87, #88
+ *     parser    → #5, #31
+ *
+ *   "fix parser"  = fix ∩ parser        = #5, #31
+ *   "inc-47*"     = every word starting with "inc-47", merged
+ *
+ *   Only the lists for the words asked about are ever read.
+ *
+ * COMPACT POSTING LISTS:
+ *   Ids in a list only go up, so we store the GAPS between them
+ *   (#87, #88 → 87, 1), and each gap as a VARINT: 7 bits per
+ *   byte, high bit = "more bytes follow". Small gaps — the
+ *   common case for frequent words — take a single byte.
+ *
+ * KEEPING IT UP TO DATE:
+ *   .mygit/msg-index      sorted words + posting lists, written
+ *                         in one go (never modified in place)
+ *   .mygit/msg-index.log  "<id> <word> <word> ..." — one line
+ *                         per commit made since
+ *
+ *   Every commit appends a line to the log (cheap). When the log
+ *   gets long, it is folded into a new msg-index ("compaction")
+ *   by appending its ids to the existing lists — commits.dat is
+ *   not read again.
+ *
+ * The index is OPTIONAL: "mygit index-messages" creates it, and
+ * from then on commits keep it up to date. Without it, --grep
+ * scans the messages and finds exactly the same commits.
+ *
+ * WORDS:
+ *   Letters, digits, '_' and '-', compared without case:
+ *   "Fix INC-4711: parser" → fix, inc-4711, parser
+ */
+
+#include "mygit.h"
+
+#define MSGINDEX_MAGIC    "MGMI"
+#define MSGINDEX_VERSION  1
+#define MSGINDEX_LOG_MAX  4096       // log lines before compaction
+#define MAX_WORD          48         // longer words are cut here
+
+typedef struct MsgIndexHeader {
+    char     magic[4];               // "MGMI"
+    uint32_t version;                // MSGINDEX_VERSION
+    uint32_t term_count;
+    int32_t  covered;                // commits #1 .. #covered are in here
+    uint64_t text_offset;            // where the words start
+    uint64_t posting_offset;         // where the posting lists start
+} MsgIndexHeader;
+
+typedef struct TermEntry {
+    uint32_t text_offset;            // word, relative to text_offset
+    uint32_t text_len;
+    uint32_t posting_offset;         // list, relative to posting_offset
+    uint32_t posting_len;            // bytes
+    uint32_t count;                  // ids in the list
+    int32_t  last_id;                // so a compaction can append gaps
+} TermEntry;
+
+
+/* ─────────── WORDS ─────────── */
+
+static int is_word_char(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')
+        || (c >= '0' && c <= '9') || c == '_' || c == '-';
+}
+
+static char lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+
+/*
+ * FUNCTION: next_word
+ * ───────────────────
+ * Takes the next word out of `text` (like view_next_item, but
+ * any non-word character separates) and writes it lowercased
+ * into `word` (MAX_WORD bytes).
+ *
+ * RETURNS: the word's length, or 0 when there are no more
+ */
+static size_t next_word(TextView* text, char* word) {
+    while (text->len > 0 && !is_word_char(text->data[0])) {
+        text->data++;
+        text->len--;
+    }
+
+    size_t len = 0;
+    while (text->len > 0 && is_word_char(text->data[0])) {
+        if (len < MAX_WORD - 1) {
+            word[len++] = lower(text->data[0]);
+        }
+        text->data++;
+        text->len--;
+    }
+    word[len] = '\0';
+    return len;
+}
+
+
+/*
+ * FUNCTION: word_matches
+ * ──────────────────────
+ * "inc-47*" matches any word starting with "inc-47",
+ * anything else must match the whole word.
+ */
+static int word_matches(const char* word, size_t word_len, const char* term) {
+    size_t term_len = strlen(term);
+    if (term_len > 0 && term[term_len - 1] == '*') {
+        return word_len >= term_len - 1 && memcmp(word, term, term_len - 1) == 0;
+    }
+    return word_len == term_len && memcmp(word, term, term_len) == 0;
+}
+
+
+/* ─────────── QUERIES ─────────── */
+
+/*
+ * FUNCTION: grep_parse
+ * ────────────────────
+ * Splits "Fix INC-47*" into lowercased terms "fix", "inc-47*".
+ *
+ * RETURNS: 0 → Success, -1 → no usable term
+ */
+int grep_parse(const char* pattern, GrepQuery* query) {
+    query->count = 0;
+
+    const char* p = pattern;
+    while (*p && query->count < MAX_GREP_TERMS) {
+        while (*p && !is_word_char(*p) && *p != '*') p++;
+        if (!*p) break;
+
+        char* term = query->terms[query->count];
+        size_t len = 0;
+        int star = 0;
+        while (*p && (is_word_char(*p) || *p == '*')) {
+            if (*p == '*') {
+                star = 1;            // "inc-47*" (anything after it is ignored)
+            } else if (!star && len < MAX_WORD - 1) {
+                term[len++] = lower(*p);
+            }
+            p++;
+        }
+        if (star && len > 0) {
+            term[len++] = '*';
+        }
+        term[len] = '\0';
+
+        if (len > 0) {
+            query->count++;
+        }
+    }
+    return query->count > 0 ? 0 : -1;
+}
+
+
+/*
+ * FUNCTION: grep_message
+ * ──────────────────────
+ * Does this message contain EVERY term of the query?
+ * The scan path of --grep (no index) — same rules as the index.
+ */
+int grep_message(TextView message, const GrepQuery* query) {
+    unsigned found = 0;
+    unsigned all = (1u << query->count) - 1;
+
+    char word[MAX_WORD];
+    size_t len;
+    while (found != all && (len = next_word(&message, word)) > 0) {
+        for (int t = 0; t < query->count; t++) {
+            if (word_matches(word, len, query->terms[t])) {
+                found |= 1u << t;
+            }
+        }
+    }
+    return found == all;
+}
+
+
+/* ─────────── VARINTS ─────────── */
+
+static size_t varint_put(unsigned char* out, uint32_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (unsigned char)value;
+    return n;
+}
+
+static int varint_get(const unsigned char** p, const unsigned char* end, uint32_t* value) {
+    uint32_t result = 0;
+    for (int shift = 0; *p < end && shift < 35; shift += 7) {
+        unsigned char byte = *(*p)++;
+        result |= (uint32_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/* ─────────── BUILDING: word → list, in memory ─────────── */
+
+typedef struct TermBuild {
+    char* text;
+    uint32_t text_len;
+    unsigned char* postings;         // varint gaps
+    uint32_t posting_len;
+    uint32_t posting_cap;
+    uint32_t count;
+    int32_t last_id;
+} TermBuild;
+
+typedef struct TermTable {
+    TermBuild* slots;                // open addressing, NULL text = empty
+    size_t capacity;                 // power of two
+    size_t used;
+} TermTable;
+
+
+static uint64_t word_hash(const char* text, size_t len) {
+    uint64_t h = 1469598103934665603ULL;          // FNV-1a 64
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)text[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static int table_init(TermTable* table) {
+    table->capacity = 1024;
+    table->used = 0;
+    table->slots = calloc(table->capacity, sizeof(TermBuild));
+    return table->slots ? 0 : -1;
+}
+
+static void table_free(TermTable* table) {
+    for (size_t i = 0; i < table->capacity; i++) {
+        free(table->slots[i].text);
+        free(table->slots[i].postings);
+    }
+    free(table->slots);
+}
+
+static TermBuild* table_find(TermBuild* slots, size_t capacity, const char* text, size_t len) {
+    size_t i = (size_t)word_hash(text, len) & (capacity - 1);
+    while (slots[i].text
+           && !(slots[i].text_len == len && memcmp(slots[i].text, text, len) == 0)) {
+        i = (i + 1) & (capacity - 1);
+    }
+    return &slots[i];
+}
+
+static int table_grow(TermTable* table) {
+    size_t capacity = table->capacity * 2;
+    TermBuild* slots = calloc(capacity, sizeof(TermBuild));
+    if (!slots) return -1;
+
+    for (size_t i = 0; i < table->capacity; i++) {
+        if (table->slots[i].text) {
+            *table_find(slots, capacity, table->slots[i].text, table->slots[i].text_len) = table->slots[i];
+        }
+    }
+    free(table->slots);
+    table->slots = slots;
+    table->capacity = capacity;
+    return 0;
+}
+
+/* The word's entry — created empty if it's new */
+static TermBuild* table_get(TermTable* table, const char* text, size_t len) {
+    if ((table->used + 1) * 4 > table->capacity * 3 && table_grow(table) != 0) {
+        return NULL;
+    }
+
+    TermBuild* t = table_find(table->slots, table->capacity, text, len);
+    if (!t->text) {
+        t->text = malloc(len + 1);
+        if (!t->text) return NULL;
+        memcpy(t->text, text, len);
+        t->text[len] = '\0';
+        t->text_len = (uint32_t)len;
+        table->used++;
+    }
+    return t;
+}
+
+static int term_reserve(TermBuild* t, size_t extra) {
+    if (t->posting_len + extra <= t->posting_cap) return 0;
+
+    uint32_t cap = t->posting_cap ? t->posting_cap : 8;
+    while (cap < t->posting_len + extra) cap *= 2;
+
+    unsigned char* grown = realloc(t->postings, cap);
+    if (!grown) return -1;
+    t->postings = grown;
+    t->posting_cap = cap;
+    return 0;
+}
+
+/* Adds commit #id to the word's list (ids arrive in order) */
+static int table_add(TermTable* table, const char* text, size_t len, int id) {
+    TermBuild* t = table_get(table, text, len);
+    if (!t || t->last_id >= id || term_reserve(t, 5) != 0) {
+        return t && t->last_id >= id ? 0 : -1;    // same word twice in one message
+    }
+
+    t->posting_len += (uint32_t)varint_put(t->postings + t->posting_len, (uint32_t)(id - t->last_id));
+    t->last_id = id;
+    t->count++;
+    return 0;
+}
+
+static int table_add_message(TermTable* table, TextView message, int id) {
+    char word[MAX_WORD];
+    size_t len;
+    while ((len = next_word(&message, word)) > 0) {
+        if (table_add(table, word, len, id) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+
+static int compare_builds(const void* a, const void* b) {
+    const TermBuild* x = *(const TermBuild* const*)a;
+    const TermBuild* y = *(const TermBuild* const*)b;
+    size_t n = x->text_len < y->text_len ? x->text_len : y->text_len;
+    int c = memcmp(x->text, y->text, n);
+    if (c != 0) return c;
+    return (x->text_len > y->text_len) - (x->text_len < y->text_len);
+}
+
+
+/*
+ * FUNCTION: table_write
+ * ─────────────────────
+ * Writes the table as a new msg-index (sorted by word, so a
+ * query can binary search) and empties the log.
+ *
+ * RETURNS: 0 → Success, -1 → Error
+ */
+static int table_write(TermTable* table, int covered) {
+    TermBuild** sorted = malloc((table->used ? table->used : 1) * sizeof(TermBuild*));
+    if (!sorted) return -1;
+
+    size_t n = 0;
+    for (size_t i = 0; i < table->capacity; i++) {
+        if (table->slots[i].text) sorted[n++] = &table->slots[i];
+    }
+    qsort(sorted, n, sizeof(TermBuild*), compare_builds);
+
+    MsgIndexHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MSGINDEX_MAGIC, 4);
+    header.version = MSGINDEX_VERSION;
+    header.term_count = (uint32_t)n;
+    header.covered = covered;
+    header.text_offset = sizeof(header) + n * sizeof(TermEntry);
+
+    uint64_t text_bytes = 0;
+    for (size_t i = 0; i < n; i++) text_bytes += sorted[i]->text_len;
+    header.posting_offset = header.text_offset + text_bytes;
+
+    AtomicFile af;
+    if (atomic_open(&af, MSGINDEX_FILE) != 0) {
+        free(sorted);
+        return -1;
+    }
+
+    int ok = fwrite(&header, sizeof(header), 1, af.fp) == 1;
+
+    uint32_t text_at = 0;
+    uint32_t posting_at = 0;
+    for (size_t i = 0; ok && i < n; i++) {
+        TermEntry e;
+        e.text_offset = text_at;
+        e.text_len = sorted[i]->text_len;
+        e.posting_offset = posting_at;
+        e.posting_len = sorted[i]->posting_len;
+        e.count = sorted[i]->count;
+        e.last_id = sorted[i]->last_id;
+        ok = fwrite(&e, sizeof(e), 1, af.fp) == 1;
+
+        text_at += e.text_len;
+        posting_at += e.posting_len;
+    }
+    for (size_t i = 0; ok && i < n; i++) {
+        ok = fwrite(sorted[i]->text, 1, sorted[i]->text_len, af.fp) == sorted[i]->text_len;
+    }
+    for (size_t i = 0; ok && i < n; i++) {
+        ok = fwrite(sorted[i]->postings, 1, sorted[i]->posting_len, af.fp) == sorted[i]->posting_len;
+    }
+    free(sorted);
+
+    if (!ok) {
+        atomic_abort(&af);
+        return -1;
+    }
+    if (atomic_commit(&af) != 0) {
+        return -1;
+    }
+    remove(MSGINDEX_LOG_FILE);
+    return 0;
+}
+
+
+/* ─────────── READING THE INDEX ─────────── */
+
+typedef struct MsgIndex {
+    MappedFile file;
+    const MsgIndexHeader* header;
+    const TermEntry* terms;
+    const char* text;
+    const unsigned char* postings;
+} MsgIndex;
+
+
+/*
+ * FUNCTION: index_open
+ * ────────────────────
+ * Maps the index and checks that every word and every posting
+ * list of the term table lies inside its own area of the file
+ * — a truncated or corrupt msg-index must not send a search
+ * reading past the end of the mapping.
+ *
+ * RETURNS: 0 → mapped, -1 → missing or damaged
+ */
+static int index_open(MsgIndex* index) {
+    if (map_file(MSGINDEX_FILE, &index->file) != 0) {
+        return -1;
+    }
+
+    const MsgIndexHeader* h = (const MsgIndexHeader*)index->file.data;
+    size_t size = index->file.size;
+
+    if (size < sizeof(MsgIndexHeader)
+        || memcmp(h->magic, MSGINDEX_MAGIC, 4) != 0
+        || h->version != MSGINDEX_VERSION
+        || h->text_offset != sizeof(MsgIndexHeader) + (uint64_t)h->term_count * sizeof(TermEntry)
+        || h->posting_offset < h->text_offset || h->posting_offset > size) {
+        unmap_file(&index->file);
+        return -1;
+    }
+
+    index->header = h;
+    index->terms = (const TermEntry*)(index->file.data + sizeof(MsgIndexHeader));
+    index->text = index->file.data + h->text_offset;
+    index->postings = (const unsigned char*)index->file.data + h->posting_offset;
+
+    uint64_t text_size = h->posting_offset - h->text_offset;
+    uint64_t posting_size = size - h->posting_offset;
+    for (uint32_t i = 0; i < h->term_count; i++) {
+        const TermEntry* e = &index->terms[i];
+        if ((uint64_t)e->text_offset + e->text_len > text_size
+            || (uint64_t)e->posting_offset + e->posting_len > posting_size) {
+            unmap_file(&index->file);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+
+/* Compares entry i's word with (text, len), like strcmp */
+static int term_compare(const MsgIndex* index, uint32_t i, const char* text, size_t len) {
+    const TermEntry* e = &index->terms[i];
+    size_t n = e->text_len < len ? e->text_len : len;
+    int c = memcmp(index->text + e->text_offset, text, n);
+    if (c != 0) return c;
+    return (e->text_len > len) - (e->text_len < len);
+}
+
+/* Binary search: first word >= (text, len) */
+static uint32_t term_lower_bound(const MsgIndex* index, const char* text, size_t len) {
+    uint32_t lo = 0;
+    uint32_t hi = index->header->term_count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (term_compare(index, mid, text, len) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+
+/* A growable sorted list of ids */
+typedef struct IdList {
+    int* ids;
+    size_t count;
+    size_t capacity;
+} IdList;
+
+static int idlist_push(IdList* list, int id) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 64;
+        int* grown = realloc(list->ids, capacity * sizeof(int));
+        if (!grown) return -1;
+        list->ids = grown;
+        list->capacity = capacity;
+    }
+    list->ids[list->count++] = id;
+    return 0;
+}
+
+static int compare_ints(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+
+/*
+ * FUNCTION: term_postings
+ * ───────────────────────
+ * Every id whose message has a word matching `term`, sorted.
+ * An exact word is one binary search + one list decode.
+ * A prefix ("inc-47*") covers a RUN of neighbouring words in
+ * the sorted table — their lists are decoded and merged.
+ */
+static int term_postings(const MsgIndex* index, const char* term, IdList* out) {
+    size_t len = strlen(term);
+    int prefix = len > 0 && term[len - 1] == '*';
+    if (prefix) len--;
+
+    uint32_t first = term_lower_bound(index, term, len);
+    int runs = 0;
+
+    for (uint32_t i = first; i < index->header->term_count; i++) {
+        const TermEntry* e = &index->terms[i];
+        const char* word = index->text + e->text_offset;
+
+        int match = prefix ? e->text_len >= len && memcmp(word, term, len) == 0
+                           : e->text_len == len && memcmp(word, term, len) == 0;
+        if (!match) break;
+
+        const unsigned char* p = index->postings + e->posting_offset;
+        const unsigned char* end = p + e->posting_len;
+        int id = 0;
+        uint32_t gap;
+        while (p < end && varint_get(&p, end, &gap)) {
+            id += (int)gap;
+            if (idlist_push(out, id) != 0) return -1;
+        }
+        runs++;
+        if (!prefix) break;
+    }
+
+    /* Several words' lists → one sorted list without duplicates */
+    if (runs > 1) {
+        qsort(out->ids, out->count, sizeof(int), compare_ints);
+        size_t kept = 0;
+        for (size_t i = 0; i < out->count; i++) {
+            if (kept == 0 || out->ids[kept - 1] != out->ids[i]) {
+                out->ids[kept++] = out->ids[i];
+            }
+        }
+        out->count = kept;
+    }
+    return 0;
+}
+
+
+/* a = a ∩ b (both sorted) — one pass over both */
+static void intersect(IdList* a, const IdList* b) {
+    size_t i = 0, j = 0, kept = 0;
+    while (i < a->count && j < b->count) {
+        if (a->ids[i] < b->ids[j]) {
+            i++;
+        } else if (a->ids[i] > b->ids[j]) {
+            j++;
+        } else {
+            a->ids[kept++] = a->ids[i];
+            i++;
+            j++;
+        }
+    }
+    a->count = kept;
+}
+
+
+/* ─────────── THE LOG OF RECENT COMMITS ─────────── */
+
+/*
+ * FUNCTION: log_lines
+ * ───────────────────
+ * Calls fn(id, words) for every line of msg-index.log.
+ * RETURNS: number of lines, -1 if an id is out of sequence
+ */
+typedef int (*LogLineFn)(int id, TextView words, void* ctx);
+
+static int log_lines(int covered, LogLineFn fn, void* ctx) {
+    MappedFile mf;
+    if (map_file(MSGINDEX_LOG_FILE, &mf) != 0) {
+        return 0;
+    }
+
+    LineCursor cursor;
+    TextView line;
+    int count = 0;
+    int rc = 0;
+    lines_init(&cursor, mf.data, mf.size);
+
+    while (rc == 0 && lines_next(&cursor, &line)) {
+        long long id;
+        if (!view_take_number(&line, &id) || id != covered + count + 1) {
+            rc = -1;                 // a torn or foreign line
+            break;
+        }
+        count++;
+        if (fn) {
+            rc = fn((int)id, line, ctx);
+        }
+    }
+
+    unmap_file(&mf);
+    return rc == 0 ? count : -1;
+}
+
+
+/* ─────────── BUILD / UPDATE ─────────── */
+
+/*
+ * FUNCTION: msgindex_rebuild
+ * ──────────────────────────
+ * "mygit index-messages": indexes every commit message from
+ * scratch. Ids come out of commits.dat in increasing order,
+ * which is exactly the order posting lists need.
+ *
+ * RETURNS: number of commits indexed, or -1 on error
+ */
+int msgindex_rebuild(void) {
+    TermTable table;
+    if (table_init(&table) != 0) {
+        return -1;
+    }
+
+    CommitStore store;
+    store_open(&store);
+
+    size_t cursor = 0;
+    CommitRecord rec;
+    int covered = 0;
+    int rc = 0;
+
+    while (rc == 0 && store_next(&store, &cursor, &rec)) {
+        int id = (int)record_int_field(&rec, "COMMIT", 0);
+        TextView message;
+        if (id <= covered || !record_field(&rec, "MSG", &message)) {
+            continue;
+        }
+        rc = table_add_message(&table, message, id);
+        covered = id;
+    }
+    store_close(&store);
+
+    if (rc == 0) {
+        rc = table_write(&table, covered);
+    }
+    table_free(&table);
+    return rc == 0 ? covered : -1;
+}
+
+
+/* Compaction: one log line → the table */
+static int add_log_line(int id, TextView words, void* ctx) {
+    return table_add_message(ctx, words, id);
+}
+
+
+/*
+ * FUNCTION: msgindex_compact
+ * ──────────────────────────
+ * Folds msg-index.log into a new msg-index. Every id in the log
+ * is newer than everything in the index, so each list just
+ * gets more gaps appended — nothing is decoded or re-sorted.
+ */
+static int msgindex_compact(void) {
+    MsgIndex index;
+    if (index_open(&index) != 0) {
+        return msgindex_rebuild() < 0 ? -1 : 0;
+    }
+
+    TermTable table;
+    if (table_init(&table) != 0) {
+        unmap_file(&index.file);
+        return -1;
+    }
+
+    int rc = 0;
+    for (uint32_t i = 0; rc == 0 && i < index.header->term_count; i++) {
+        const TermEntry* e = &index.terms[i];
+        TermBuild* t = table_get(&table, index.text + e->text_offset, e->text_len);
+
+        if (!t || term_reserve(t, e->posting_len) != 0) {
+            rc = -1;
+            break;
+        }
+        memcpy(t->postings, index.postings + e->posting_offset, e->posting_len);
+        t->posting_len = e->posting_len;
+        t->count = e->count;
+        t->last_id = e->last_id;
+    }
+
+    int covered = index.header->covered;
+    unmap_file(&index.file);
+
+    int added = rc == 0 ? log_lines(covered, add_log_line, &table) : -1;
+    rc = added < 0 ? -1 : table_write(&table, covered + added);
+
+    table_free(&table);
+    return rc;
+}
+
+
+/*
+ * FUNCTION: msgindex_add
+ * ──────────────────────
+ * Called by mygit_commit() for every new commit. Does nothing
+ * unless the repository has an index.
+ *
+ * Appends "<id> <words>" to the log; compacts when the log is
+ * long. If the index has fallen behind (commits made by an
+ * older mygit, a crash) or is damaged, it is rebuilt instead.
+ *
+ * RETURNS: 0 → Success, -1 → Error (the index is only a cache)
+ */
+int msgindex_add(int id, const char* message) {
+    if (!file_exists(MSGINDEX_FILE)) {
+        return 0;                    // not enabled
+    }
+
+    MsgIndex index;
+    if (index_open(&index) != 0) {
+        return msgindex_rebuild() < 0 ? -1 : 0;
+    }
+    int covered = index.header->covered;
+    unmap_file(&index.file);
+
+    int pending = log_lines(covered, NULL, NULL);
+    if (pending < 0 || covered + pending + 1 != id) {
+        return msgindex_rebuild() < 0 ? -1 : 0;
+    }
+
+    FILE* fp = fopen(MSGINDEX_LOG_FILE, "ab");
+    if (!fp) {
+        return -1;
+    }
+
+    fprintf(fp, "%d", id);
+    TextView text = view_from(message);
+    char word[MAX_WORD];
+    while (next_word(&text, word) > 0) {
+        fprintf(fp, " %s", word);
+    }
+    fputc('\n', fp);
+
+    if (fclose(fp) != 0) {
+        return -1;
+    }
+
+    return pending + 1 >= MSGINDEX_LOG_MAX ? msgindex_compact() : 0;
+}
+
+
+/* ─────────── SEARCH ─────────── */
+
+/* Query: log line ids whose words match every term */
+typedef struct LogMatch {
+    const GrepQuery* query;
+    IdList* ids;
+} LogMatch;
+
+static int match_log_line(int id, TextView words, void* ctx) {
+    LogMatch* m = ctx;
+    return grep_message(words, m->query) ? idlist_push(m->ids, id) : 0;
+}
+
+
+/*
+ * FUNCTION: msgindex_search
+ * ─────────────────────────
+ * All commits (on any branch) whose message has every term.
+ *
+ *   1. Each term → its posting list
+ *   2. Intersect, rarest list first, so the running result only
+ *      gets smaller
+ *   3. Add matches from the not-yet-compacted log
+ *
+ * RETURNS:
+ *   number of matches (*ids = sorted array, caller frees),
+ *   or -1 if there is no usable index (caller scans instead)
+ */
+int msgindex_search(const GrepQuery* query, int** ids) {
+    if (!file_exists(MSGINDEX_FILE)) {
+        return -1;
+    }
+
+    /* Damaged → build it again; if even that fails, scan */
+    MsgIndex index;
+    if (index_open(&index) != 0
+        && (msgindex_rebuild() < 0 || index_open(&index) != 0)) {
+        return -1;
+    }
+
+    /* An index that doesn't cover every commit would miss some */
+    int covered = index.header->covered;
+    int pending = log_lines(covered, NULL, NULL);
+    if (pending < 0 || (graph_count() >= 0 && covered + pending != graph_count())) {
+        unmap_file(&index.file);
+        if (msgindex_rebuild() < 0 || index_open(&index) != 0) {
+            return -1;
+        }
+        covered = index.header->covered;
+        pending = 0;
+    }
+
+    IdList lists[MAX_GREP_TERMS];
+    memset(lists, 0, sizeof(lists));
+
+    int rc = 0;
+    for (int t = 0; rc == 0 && t < query->count; t++) {
+        rc = term_postings(&index, query->terms[t], &lists[t]);
+    }
+    unmap_file(&index.file);
+
+    IdList result = { NULL, 0, 0 };
+    if (rc == 0) {
+        int rarest = 0;
+        for (int t = 1; t < query->count; t++) {
+            if (lists[t].count < lists[rarest].count) rarest = t;
+        }
+
+        result = lists[rarest];
+        lists[rarest].ids = NULL;
+        for (int t = 0; t < query->count; t++) {
+            if (t != rarest) intersect(&result, &lists[t]);
+        }
+
+        LogMatch m = { query, &result };
+        if (pending > 0 && log_lines(covered, match_log_line, &m) < 0) {
+            rc = -1;
+        }
+    }
+
+    for (int t = 0; t < query->count; t++) {
+        free(lists[t].ids);
+    }
+
+    if (rc != 0) {
+        free(result.ids);
+        return -1;
+    }
+
+    *ids = result.ids;
+    return (int)result.count;
+}
@@ -8,8 +8,19 @@
 #ifndef MYGIT_H
 #define MYGIT_H
 
+/*
+ * POSIX functions (strdup, setenv, fileno, fdopen, ftruncate,
+ * nanosleep) are only declared when asked for — without this a
+ * strict "-std=c11" build guesses they return int, and a pointer
+ * from strdup gets cut in half. Must come before any system header.
+ */
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <time.h>
 #include <sys/stat.h>
@@ -29,6 +40,8 @@
 #else
     #include <dirent.h>     // Linux/Mac: for directory operations
     #include <unistd.h>     // Linux/Mac: for access()
+    #include <fcntl.h>      // Linux/Mac: for open()
+    #include <sys/mman.h>   // Linux/Mac: for mmap()
     #define PATH_SEP "/"
 #endif
 
@@ -41,7 +54,6 @@
 #define MAX_CONTENT     10000
 #define MAX_PATH        512
 #define MAX_LINE        1024
-#define MAX_LINES       500
 #define MAX_BRANCH_NAME 50
 #define HASH_LENGTH     20
 
@@ -49,8 +61,17 @@
 #define OBJECTS_DIR     ".mygit/objects"
 #define REFS_DIR        ".mygit/refs"
 #define HEAD_FILE       ".mygit/HEAD"
+#define DETACHED_FILE   ".mygit/DETACHED"
 #define STAGING_FILE    ".mygit/staging.dat"
 #define COMMITS_FILE    ".mygit/commits.dat"
+#define GRAPH_FILE      ".mygit/commit-graph"
+#define INDEX_FILE      ".mygit/commits.idx"
+#define BITMAP_FILE     ".mygit/objects/objects.bitmap"
+#define PACKED_REFS_FILE ".mygit/packed-refs"
+#define LOGS_DIR        ".mygit/logs"
+#define TIMES_FILE      ".mygit/commit-times"
+#define MSGINDEX_FILE   ".mygit/msg-index"
+#define MSGINDEX_LOG_FILE ".mygit/msg-index.log"
 
 /* ─────────── COLOR CODES (for pretty output) ─────────── */
 
@@ -92,20 +113,35 @@ typedef struct StagedFile {
  * → We only add to the front (latest commit)
  * → We traverse from newest → oldest (like git log)
  * → Insert: O(1), Traverse: O(n)
+ * 
+ * The files are NOT stored in here — only the id of the
+ * ROOT TREE (see tree.c), which can describe any number of
+ * files. That keeps a commit down to a few dozen bytes.
  */
 typedef struct Commit {
     int id;
-    char message[MAX_MESSAGE];
-    char timestamp[64];
-    char branch[MAX_BRANCH_NAME];
     int parent_id;                   // -1 if first commit
-    int file_count;
-    char filenames[10][MAX_FILENAME]; // files in this commit
-    unsigned long file_hashes[10];    // their hashes
+    unsigned long tree;              // root tree object (0 = empty)
+    time_t time;                     // when it was made (epoch seconds)
+    int tz_offset;                   // committer's minutes east of UTC
+    const char* message;             // not owned by the struct
+    const char* branch;              // not owned by the struct
     struct Commit* parent;           // pointer to previous commit
     struct Commit* next;             // for loading list from file
 } Commit;
 
+/*
+ * TREE ENTRY
+ * ──────────
+ * One line of a tree object: a file (blob) or a
+ * sub-directory (tree) inside ONE directory.
+ */
+typedef struct TreeEntry {
+    char name[MAX_FILENAME];         // just the name, no slashes
+    unsigned long hash;              // blob hash or tree id
+    int is_tree;                     // 1 = sub-directory
+} TreeEntry;
+
 /*
  * BRANCH NODE (Linked List)
  * ─────────────────────────
@@ -121,6 +157,320 @@ typedef struct Branch {
     struct Branch* next;
 } Branch;
 
+/*
+ * REF INFO (see refs.c)
+ * ─────────────────────
+ * One branch as returned by refs_list(): its full name
+ * ("main", "ci/build-7") and the commit it points to.
+ */
+typedef struct RefInfo {
+    char name[MAX_PATH];
+    int id;
+} RefInfo;
+
+/*
+ * REF TRANSACTION (see refs.c)
+ * ────────────────────────────
+ * "Move these branches from A to B — all of them, or none".
+ * Each update is a compare-and-swap: it only happens if the
+ * ref still holds old_id when we lock it.
+ */
+#define REF_ANY_VALUE      -1        // old_id: don't check
+#define REF_MUST_NOT_EXIST -2        // old_id: ref must be new
+#define REF_TXN_CONFLICT    1        // ref_txn_lock: someone moved a ref
+
+typedef struct RefUpdate {
+    char name[MAX_PATH];
+    int old_id;
+    int new_id;
+    int found_id;                    // what the ref really held when locked
+    char reason[48];                 // for the reflog: "commit: ..."
+} RefUpdate;
+
+typedef struct RefTxn {
+    RefUpdate* updates;
+    int count;
+    int capacity;
+    int locked;                      // how many updates[] hold their lock
+} RefTxn;
+
+/*
+ * MAPPED FILE
+ * ───────────
+ * A whole file viewed as one read-only block of memory.
+ * 
+ * On Linux/Mac this is an mmap() — the OS pages the file in
+ * only when we touch it. Windows gets a plain malloc + fread.
+ * Either way the caller just sees data[0 .. size-1].
+ */
+typedef struct MappedFile {
+    const char* data;
+    size_t size;
+    int is_mapped;                   // 1 = mmap'd, 0 = heap copy
+} MappedFile;
+
+/*
+ * ATOMIC FILE
+ * ───────────
+ * A file being replaced as a whole: written under a tmp name of
+ * its own, renamed over the real one only when complete.
+ * See atomic_open() in utils.c.
+ */
+typedef struct AtomicFile {
+    FILE* fp;                        // write here
+    char path[MAX_PATH];             // the real name
+    char tmp_path[MAX_PATH + 32];    // "<path>.tmp.<pid>"
+} AtomicFile;
+
+/*
+ * REFLOG (see reflog.c)
+ * ─────────────────────
+ * One move of a branch, exactly 64 bytes on disk, and a whole
+ * mapped log of them (oldest first).
+ */
+typedef struct ReflogEntry {
+    int32_t old_id;                  // 0 = branch had no commit
+    int32_t new_id;
+    int64_t time;                    // seconds since 1970
+    char    reason[48];              // '\0'-terminated unless full
+} ReflogEntry;
+
+typedef struct Reflog {
+    MappedFile file;
+    const ReflogEntry* entries;
+    int count;
+} Reflog;
+
+/*
+ * TEXT VIEW
+ * ─────────
+ * A piece of text that lives INSIDE some other buffer
+ * (usually a mapped file): a pointer plus a length.
+ * Not '\0'-terminated — nothing was copied to make it.
+ */
+typedef struct TextView {
+    const char* data;
+    size_t len;
+} TextView;
+
+/*
+ * LINE CURSOR (see parse.c)
+ * ─────────────────────────
+ * Where we are while walking a buffer line by line.
+ * Lives on the caller's stack — no hidden state anywhere.
+ */
+typedef struct LineCursor {
+    const char* pos;
+    const char* end;
+} LineCursor;
+
+/*
+ * COMMIT STORE + RECORD (see store.c)
+ * ───────────────────────────────────
+ * The store is commits.dat mapped into memory.
+ * A record is one "COMMIT: ... END" block inside it —
+ * again just a view; fields are parsed only when asked for.
+ */
+typedef struct CommitStore {
+    MappedFile file;
+} CommitStore;
+
+typedef struct CommitRecord {
+    size_t offset;                   // where the record starts in commits.dat
+    const char* data;                // "COMMIT:..." (inside the mapping)
+    size_t len;                      // up to and including the END line
+} CommitRecord;
+
+/*
+ * COMMIT-GRAPH ENTRY (fixed size, binary)
+ * ───────────────────────────────────────
+ * One record per commit in .mygit/commit-graph.
+ * Commit IDs are handed out 1, 2, 3 ... so commit #N lives
+ * at POSITION N-1 — finding a commit is just array indexing.
+ * 
+ * WHY GENERATION NUMBERS?
+ *   generation = 1 + max(generation of parents), roots are 1.
+ *   Every commit's generation is higher than its parents', so
+ *   visiting the highest generation first hands out children
+ *   before their parents ("log --graph").
+ * 
+ * WHY A BLOOM FILTER?
+ *   "Did this commit touch src/main.c?" A NO answer from the
+ *   filter is always right, so most commits are skipped without
+ *   opening a single tree. (A YES is only "maybe" — we check.)
+ */
+#define GRAPH_NO_PARENT 0xFFFFFFFFu
+#define BLOOM_WORDS     4            // 4 x 64 = 256-bit filter per commit
+
+typedef struct GraphEntry {
+    uint32_t parents[2];             // parent POSITIONS (GRAPH_NO_PARENT if none)
+    uint32_t generation;             // topological level, roots = 1
+    int32_t  commit_id;              // sanity check: position + 1
+    uint64_t tree;                   // root tree object (0 = none recorded)
+    int64_t  time;                   // commit time, seconds since epoch
+    uint64_t bloom[BLOOM_WORDS];     // paths changed vs. first parent
+} GraphEntry;
+
+/*
+ * GRAPH WALK (see graph.c)
+ * ────────────────────────
+ * Commits in topological order: a priority queue of commit
+ * positions, highest generation first, plus "already queued"
+ * flags.
+ */
+typedef struct GenHeap {
+    uint32_t* items;
+    int size;
+    int capacity;
+} GenHeap;
+
+typedef struct GraphWalk {
+    GenHeap heap;
+    unsigned char* seen;
+} GraphWalk;
+
+/*
+ * REACHABILITY STATS (see bitmap.c)
+ * ─────────────────────────────────
+ * What "mygit count-objects" reports for a branch.
+ */
+typedef struct ReachStats {
+    unsigned long commits;
+    unsigned long trees;
+    unsigned long blobs;
+    unsigned long long bytes;        // total size of trees + blobs on disk
+    int bitmaps_available;           // stored bitmaps that could be used
+} ReachStats;
+
+/*
+ * LOG OPTIONS (see log.c)
+ * ───────────────────────
+ * What "mygit log" was asked for. Zero / NULL = no filter.
+ */
+typedef struct LogOptions {
+    const char* branch;              // NULL → current branch
+    int limit;                       // -n
+    time_t since;                    // --since
+    time_t until;                    // --until
+    const char* path;                // -- <path>
+    const char* grep;                // --grep <words>
+    int stat;                        // --stat
+    int graph;                       // --graph
+    int all;                         // --all (every branch, with --graph)
+} LogOptions;
+
+/*
+ * OUTPUT FORMAT (see output.c)
+ * ────────────────────────────
+ * --format=human (default), porcelain or json.
+ */
+typedef enum OutFormat {
+    OUT_HUMAN,
+    OUT_PORCELAIN,
+    OUT_JSON
+} OutFormat;
+
+/*
+ * TEXT LINES (see text.c)
+ * ───────────────────────
+ * A file cut into lines (views into the file, each with its
+ * '\n'), and the table that numbers distinct lines: the same
+ * text gets the same id in every file interned together.
+ */
+typedef struct TextLine {
+    const char* data;
+    size_t len;
+    int id;                          // -1 until interned
+} TextLine;
+
+typedef struct LineInterner {
+    struct InternSlot* slots;
+    size_t mask;
+    int count;                       // ids handed out: 0 .. count-1
+} LineInterner;
+
+/*
+ * DIFF ALGORITHM (see diff.c)
+ * ───────────────────────────
+ * --diff-algorithm=myers (default), patience or histogram.
+ */
+typedef enum DiffAlgorithm {
+    DIFF_MYERS,
+    DIFF_PATIENCE,
+    DIFF_HISTOGRAM
+} DiffAlgorithm;
+
+/*
+ * DIFF STAT (see diff.c)
+ * ──────────────────────
+ * How much one file changed, for log --stat. Binary files have
+ * no lines: only their sizes are filled in.
+ */
+typedef struct DiffStat {
+    long added;                      // lines
+    long removed;
+    int binary;
+    long long old_size;              // bytes
+    long long new_size;
+} DiffStat;
+
+/*
+ * DIFF OPTIONS (see diff.c)
+ * ─────────────────────────
+ *   mygit diff [path]             working tree ↔ staged / HEAD
+ *   mygit diff --cached [path]    staged ↔ HEAD
+ *   mygit diff <commit> <commit>  one snapshot ↔ the other
+ * Without a path every tracked file is compared.
+ */
+typedef struct DiffOptions {
+    const char* path;                // NULL → all files
+    int cached;                      // --cached
+    const char* from;                // two commits (branch, id, main@{1})
+    const char* to;
+    DiffAlgorithm algorithm;         // --diff-algorithm
+} DiffOptions;
+
+/*
+ * POOL TASK (see pool.c)
+ * ──────────────────────
+ * One job for the worker pool. Embed it as the FIRST member of
+ * your own job struct; run() gets a pointer to it.
+ */
+typedef struct PoolTask {
+    void (*run)(struct PoolTask* task);
+    struct PoolTask* next;           // queue link (pool-owned)
+    int done;                        // set by the pool
+} PoolTask;
+
+typedef struct WorkPool WorkPool;    // opaque, see pool.c
+
+/*
+ * GREP QUERY (see msgindex.c)
+ * ───────────────────────────
+ * "--grep 'fix inc-47*'" → terms "fix", "inc-47*".
+ * A commit matches if its message has EVERY term as a word;
+ * a trailing '*' matches any word starting that way.
+ */
+#define MAX_GREP_TERMS 8
+
+typedef struct GrepQuery {
+    char terms[MAX_GREP_TERMS][64];
+    int count;
+} GrepQuery;
+
+/*
+ * WAL TRANSACTION (see wal.c)
+ * ───────────────────────────
+ * Every file change one commit makes, packed into a single
+ * buffer so it can be logged — and fsync'd — in one go.
+ */
+typedef struct WalTxn {
+    char* data;                      // encoded ops
+    size_t len;
+    size_t cap;
+    long append_offset;              // where the first append landed (-1 = unknown)
+} WalTxn;
+
 /* ─────────── FUNCTION DECLARATIONS ─────────── */
 
 // init.c
@@ -128,28 +478,194 @@ int mygit_init(void);
 
 // utils.c
 unsigned long hash_content(const char* content);
+unsigned long hash_bytes(const char* data, size_t len);
 int file_exists(const char* path);
 int directory_exists(const char* path);
 int create_directory(const char* path);
 int read_file(const char* path, char* buffer, int max_size);
 int write_file(const char* path, const char* content);
+int sync_path(const char* path);
+int atomic_open(AtomicFile* af, const char* path);
+int atomic_commit(AtomicFile* af);
+void atomic_abort(AtomicFile* af);
+int write_file_atomic(const char* path, const void* data, size_t size);
 void get_timestamp(char* buffer, int size);
+void format_timestamp(time_t when, char* buffer, int size);
+time_t parse_timestamp(TextView text);
+int local_tz_offset(time_t when);
+void format_timestamp_tz(time_t when, int tz_minutes, char* buffer, int size);
+time_t parse_commit_time(TextView text, int* tz_minutes);
+time_t parse_date_arg(const char* text, int end_of_day);
 int get_next_commit_id(void);
 char* get_current_branch(char* buffer, int size);
+int get_detached_commit(void);
 void print_banner(void);
 void print_help(void);
+int map_file(const char* path, MappedFile* mf);
+void unmap_file(MappedFile* mf);
 
 // add.c
 int mygit_add(const char* filename);
 
 // commit.c
 int mygit_commit(const char* message);
+int count_staged_files(void);
+StagedFile* read_staged_files(int* count);
+int get_last_commit_id_on_branch(const char* branch);
+void free_staged_files(StagedFile* head);
+
+// parse.c
+TextView view_from(const char* text);
+int view_equals(TextView view, const char* text);
+int view_starts_with(TextView view, const char* prefix);
+TextView view_trim(TextView view);
+int view_split(TextView view, char sep, TextView* left, TextView* right);
+int view_split_last(TextView view, char sep, TextView* left, TextView* right);
+int view_next_item(TextView* list, char sep, TextView* item);
+int view_take_number(TextView* view, long long* out);
+int view_take_char(TextView* view, char c);
+long long view_to_ll(TextView view, long long fallback);
+int view_to_ul(TextView view, unsigned long* out);
+int view_copy(TextView view, char* buffer, size_t size);
+void lines_init(LineCursor* cursor, const char* data, size_t len);
+int lines_next(LineCursor* cursor, TextView* line);
+int staging_next(LineCursor* cursor, TextView* path, unsigned long* hash);
+int read_ref(const char* ref_path);
+
+// refs.c
+int ref_read(const char* name, int* id);
+int ref_exists(const char* name);
+int ref_name_valid(const char* name);
+RefInfo* refs_list(int* count);
+int refs_pack(void);
+int lockfile_acquire(const char* path);
+void lockfile_release(const char* path);
+void ref_txn_init(RefTxn* txn);
+void ref_txn_free(RefTxn* txn);
+int ref_txn_update(RefTxn* txn, const char* name, int old_id, int new_id, const char* reason);
+int ref_txn_lock(RefTxn* txn);
+void ref_txn_unlock(RefTxn* txn);
+int ref_txn_queue(const RefTxn* txn, WalTxn* wal);
+int ref_apply_logged(const char* name, int old_id, int new_id, int check_only);
+int ref_txn_commit(RefTxn* txn);
+
+// graph.c
+int graph_load(void);
+void graph_close(void);
+int graph_rebuild(void);
+int graph_count(void);
+const GraphEntry* graph_entry(int commit_id);
+int graph_parent_id(int commit_id);
+int graph_append(const Commit* commit);
+int graph_walk_start(GraphWalk* walk, const int* tips, int count);
+int graph_walk_next(GraphWalk* walk);
+void graph_walk_end(GraphWalk* walk);
+unsigned long commit_root_tree(int commit_id);
+int graph_may_touch(int commit_id, const char* path);
+int commit_touches_path(int commit_id, const char* path);
+
+// timeindex.c
+int time_index_rebuild(void);
+int time_index_append(int id, time_t when);
+int time_index_range(time_t since, time_t until, int* min_id, int* max_id);
+
+// msgindex.c
+int grep_parse(const char* pattern, GrepQuery* query);
+int grep_message(TextView message, const GrepQuery* query);
+int msgindex_rebuild(void);
+int msgindex_add(int id, const char* message);
+int msgindex_search(const GrepQuery* query, int** ids);
+
+// search.c
+const char* find_text(const char* hay, size_t len, const char* needle, size_t n, int ignore_case);
+int grep_scan_commits(const GrepQuery* query, int** ids);
+int mygit_grep(const char* text, const char* branch, int ignore_case);
+
+// store.c
+uint64_t store_size(void);
+int store_open(CommitStore* store);
+void store_close(CommitStore* store);
+int store_record_at(const CommitStore* store, size_t offset, CommitRecord* rec);
+int store_next(const CommitStore* store, size_t* cursor, CommitRecord* rec);
+int record_field(const CommitRecord* rec, const char* key, TextView* value);
+long long record_int_field(const CommitRecord* rec, const char* key, long long fallback);
+int commit_index_rebuild(void);
+int commit_index_append(int id, uint64_t offset);
+int store_find_commit(const CommitStore* store, int id, CommitRecord* rec);
+
+// tree.c
+int tree_read(unsigned long id, TreeEntry** entries, int* count);
+unsigned long tree_write(TreeEntry* entries, int count);
+unsigned long legacy_commit_tree(const CommitRecord* rec, unsigned long parent_tree);
+int tree_build_commit(unsigned long parent_tree, const StagedFile* staged, unsigned long* out);
+size_t staging_root_text(unsigned long tree, char* buffer, size_t size);
+int staging_root(unsigned long* tree);
+int staging_reset(unsigned long tree);
+typedef void (*TreeDiffFn)(const char* path, unsigned long old_hash, unsigned long new_hash, void* ctx);
+int tree_diff(unsigned long old_tree, unsigned long new_tree, TreeDiffFn fn, void* ctx);
+unsigned long tree_lookup_path(unsigned long tree, const char* path);
+
+// wal.c
+void wal_txn_init(WalTxn* txn);
+void wal_txn_free(WalTxn* txn);
+int wal_txn_append(WalTxn* txn, const char* path, const char* data, size_t len);
+int wal_txn_replace(WalTxn* txn, const char* path, const char* data, size_t len);
+int wal_txn_ref(WalTxn* txn, const char* name, int old_id, int new_id);
+int wal_commit(WalTxn* txn);
+int wal_recover(void);
+
+// reflog.c
+int reflog_queue(WalTxn* wal, const char* name, int old_id, int new_id, const char* reason);
+int reflog_open(const char* name, Reflog* log);
+void reflog_close(Reflog* log);
+const ReflogEntry* reflog_nth(const Reflog* log, int n);
+int reflog_resolve(const char* spec, int* id);
+int mygit_reflog(const char* branch, int limit);
+
+// bitmap.c
+int bitmap_write(int tip_id);
+int bitmap_reach(const int* tips, int tip_count, ReachStats* stats);
+int mygit_count_objects(const char* branch, int write_bitmaps);
 
 // log.c
-int mygit_log(void);
+int mygit_log(const LogOptions* options);
+
+// output.c
+int out_setup(int* argc, char** argv);
+OutFormat out_format(void);
+int out_colors(void);
+void out_write(const char* data, size_t len);
+void out_str(const char* text);
+void out_view(TextView view);
+void out_char(char c);
+void out_int(long long value);
+void out_padded(const char* text, int width);
+void out_color(const char* code);
+void out_json_chars(const char* data, size_t len);
+void out_json_string(const char* data, size_t len);
+void out_json_key(const char* key);
+void out_end_record(void);
+void out_flush(void);
+int out_failed(void);
+
+// pool.c
+int pool_cpu_count(void);
+WorkPool* pool_start(int threads);
+void pool_submit(WorkPool* pool, PoolTask* task);
+void pool_wait(WorkPool* pool, PoolTask* task);
+void pool_stop(WorkPool* pool);
+
+// text.c
+long text_split_lines(const char* data, size_t size, TextLine** lines);
+void interner_init(LineInterner* in);
+int interner_add(LineInterner* in, TextLine* lines, long count);
+void interner_free(LineInterner* in);
+int text_is_binary(const char* data, size_t size);
+size_t text_mismatch(const char* a, const char* b, size_t size);
 
 // diff.c
-int mygit_diff(const char* filename);
+int diffstat_blobs(unsigned long old_hash, unsigned long new_hash, DiffStat* stat);
+int mygit_diff(const DiffOptions* options);
 
 // status.c
 int mygit_status(void);
@@ -0,0 +1,260 @@
+/*
+ * ============================================
+ *          MYGIT - Output Layer
+ *          --format=human|porcelain|json, -z
+ * ============================================
+ *
+ * PURPOSE:
+ *   Scripts read mygit's output too. For them, the pretty
+ *   version is a problem:
+ *
+ *     - colour codes ("\033[1;33m") end up in the text
+ *     - the layout is made for eyes ("Date:   ...") and can
+ *       change any time
+ *     - thousands of small printf()s, each parsing its format
+ *       string, are slow for a million-commit log
+ *
+ * THREE FORMATS (log, status, branch, diff):
+ *   human      the normal output; colours only on a terminal
+ *   porcelain  tab-separated fields, one record per line,
+ *              stable for scripts
+ *   json       one JSON object per line ("JSON lines")
+ *
+ *   -z ends every record with a NUL byte instead of '\n', so
+ *   even a file name with a newline in it can't break a record.
+ *
+ * ONE BIG BUFFER:
+ *   Everything is appended to a 64 KB buffer with memcpy, and
+ *   the buffer goes to stdout in one write when it is full.
+ *   Numbers are turned into digits by hand — no format string
+ *   is parsed per field.
+ *
+ *   Anything printed with printf() in between must come after
+ *   an out_flush(), or it would overtake the buffered text.
+ */
+
+#include "mygit.h"
+
+#define OUT_BUFFER_SIZE (64 * 1024)
+
+static char g_buffer[OUT_BUFFER_SIZE];
+static size_t g_used;
+static OutFormat g_format = OUT_HUMAN;
+static int g_nul_records;            // -z
+static int g_colors = -1;            // -1 → not decided yet
+
+
+/*
+ * FUNCTION: out_flush
+ * ───────────────────
+ * Hands the buffer to stdout. Called when it is full, before
+ * any printf(), and at exit.
+ */
+void out_flush(void) {
+    if (g_used > 0) {
+        fwrite(g_buffer, 1, g_used, stdout);
+        g_used = 0;
+    }
+}
+
+
+/*
+ * FUNCTION: out_setup
+ * ───────────────────
+ * Takes --format=... and -z out of the arguments (they work
+ * anywhere after the command), so commands never see them.
+ *
+ * RETURNS: 0 → Success, -1 → unknown format (message printed)
+ */
+int out_setup(int* argc, char** argv) {
+    int kept = 1;
+
+    for (int i = 1; i < *argc; i++) {
+        const char* arg = argv[i];
+
+        if (strncmp(arg, "--format=", 9) == 0) {
+            const char* name = arg + 9;
+            if (strcmp(name, "human") == 0) {
+                g_format = OUT_HUMAN;
+            } else if (strcmp(name, "porcelain") == 0) {
+                g_format = OUT_PORCELAIN;
+            } else if (strcmp(name, "json") == 0) {
+                g_format = OUT_JSON;
+            } else {
+                printf(RED "✗ Unknown format '%s' (use human, porcelain or json)\n" RESET, name);
+                return -1;
+            }
+        } else if (strcmp(arg, "-z") == 0) {
+            g_nul_records = 1;
+            if (g_format == OUT_HUMAN) g_format = OUT_PORCELAIN;
+        } else if (strcmp(arg, "--") == 0) {
+            /* Everything after "--" is a path — copy it unchanged */
+            while (i < *argc) argv[kept++] = argv[i++];
+            break;
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+
+    *argc = kept;
+    argv[kept] = NULL;
+    atexit(out_flush);
+    return 0;
+}
+
+
+OutFormat out_format(void) {
+    return g_format;
+}
+
+
+/*
+ * FUNCTION: out_colors
+ * ────────────────────
+ * Colours only for people: human format, stdout is a terminal,
+ * and NO_COLOR (https://no-color.org) isn't set.
+ */
+int out_colors(void) {
+    if (g_colors < 0) {
+#ifdef _WIN32
+        int tty = _isatty(_fileno(stdout));
+#else
+        int tty = isatty(fileno(stdout));
+#endif
+        g_colors = g_format == OUT_HUMAN && tty && !getenv("NO_COLOR");
+    }
+    return g_colors;
+}
+
+
+void out_write(const char* data, size_t len) {
+    while (len > 0) {
+        if (g_used == OUT_BUFFER_SIZE) {
+            out_flush();
+        }
+        size_t n = OUT_BUFFER_SIZE - g_used;
+        if (n > len) n = len;
+        memcpy(g_buffer + g_used, data, n);
+        g_used += n;
+        data += n;
+        len -= n;
+    }
+}
+
+void out_str(const char* text) {
+    out_write(text, strlen(text));
+}
+
+void out_view(TextView view) {
+    out_write(view.data, view.len);
+}
+
+void out_char(char c) {
+    if (g_used == OUT_BUFFER_SIZE) {
+        out_flush();
+    }
+    g_buffer[g_used++] = c;
+}
+
+/* A number without printf: digits are produced backwards */
+void out_int(long long value) {
+    char digits[24];
+    int n = 0;
+    unsigned long long v = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+
+    do {
+        digits[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v > 0);
+    if (value < 0) digits[n++] = '-';
+
+    while (n > 0) {
+        out_char(digits[--n]);
+    }
+}
+
+/* Pads `text` with spaces to `width` characters */
+void out_padded(const char* text, int width) {
+    int len = (int)strlen(text);
+    out_write(text, len);
+    for (; len < width; len++) {
+        out_char(' ');
+    }
+}
+
+/* A colour code (RED, YELLOW, RESET, ...) — dropped for pipes */
+void out_color(const char* code) {
+    if (out_colors()) {
+        out_str(code);
+    }
+}
+
+
+/*
+ * FUNCTION: out_json_chars
+ * ────────────────────────
+ * Writes text for inside a JSON string: quotes, backslashes and
+ * control characters escaped. Plain runs are copied in one go.
+ */
+void out_json_chars(const char* data, size_t len) {
+    static const char hex[] = "0123456789abcdef";
+    size_t plain = 0;
+
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)data[i];
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+
+        out_write(data + plain, i - plain);
+        plain = i + 1;
+
+        out_char('\\');
+        switch (c) {
+            case '"':  out_char('"');  break;
+            case '\\': out_char('\\'); break;
+            case '\n': out_char('n');  break;
+            case '\r': out_char('r');  break;
+            case '\t': out_char('t');  break;
+            default:
+                out_str("u00");
+                out_char(hex[c >> 4]);
+                out_char(hex[c & 15]);
+        }
+    }
+    out_write(data + plain, len - plain);
+}
+
+/* "text" as a whole JSON string */
+void out_json_string(const char* data, size_t len) {
+    out_char('"');
+    out_json_chars(data, len);
+    out_char('"');
+}
+
+/* ,"key": — the start of one JSON member after the first */
+void out_json_key(const char* key) {
+    out_str(",\"");
+    out_str(key);
+    out_str("\":");
+}
+
+
+/* End of one record: '\n', or NUL with -z */
+void out_end_record(void) {
+    out_char(g_nul_records ? '\0' : '\n');
+}
+
+
+/*
+ * FUNCTION: out_failed
+ * ────────────────────
+ * Did writing fail (reader closed the pipe, disk full)?
+ * Commands check it to stop early.
+ */
+int out_failed(void) {
+    if (g_used > OUT_BUFFER_SIZE / 2) {
+        out_flush();
+    }
+    return ferror(stdout);
+}
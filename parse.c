@@ -0,0 +1,353 @@
+/*
+ * ============================================
+ *          MYGIT - Metadata Parsing
+ *          One tokenizer for every .mygit file
+ * ============================================
+ *
+ * PURPOSE:
+ *   staging.dat, refs, HEAD, tree objects and commits.dat are
+ *   all small text formats. They used to be read with
+ *
+ *     fgets  → copy the line into a 1024-byte buffer
+ *     strcpy → copy it AGAIN (strtok destroys its input)
+ *     strtok → split it, using a hidden global pointer
+ *
+ *   which copies every line twice, silently cuts lines longer
+ *   than MAX_LINE, and breaks if two threads parse at once
+ *   (strtok's hidden pointer is shared).
+ *
+ * THE NEW WAY:
+ *   Map the file (map_file), then cut it into TextViews —
+ *   pointer + length pairs that point INTO the mapping.
+ *
+ *     no malloc   → every function here works on the stack
+ *     no copying  → a line is just two numbers
+ *     reentrant   → all state lives in the caller's variables,
+ *                   so worker threads can parse side by side
+ *     no limits   → a line is as long as it is
+ *
+ *   Views are NOT '\0'-terminated. Nothing in this file reads
+ *   past view.data + view.len — not even by one byte.
+ */
+
+#include "mygit.h"
+#include <limits.h>          // LLONG_MAX
+
+
+/* ─────────── VIEWS ─────────── */
+
+/*
+ * FUNCTION: view_from
+ * ───────────────────
+ * Wraps an ordinary C string.
+ */
+TextView view_from(const char* text) {
+    TextView view = { text, strlen(text) };
+    return view;
+}
+
+
+/*
+ * FUNCTION: view_equals
+ * ─────────────────────
+ * Compares a view with an ordinary C string.
+ */
+int view_equals(TextView view, const char* text) {
+    size_t len = strlen(text);
+    return view.len == len && memcmp(view.data, text, len) == 0;
+}
+
+
+/*
+ * FUNCTION: view_starts_with
+ * ──────────────────────────
+ * "#root 874291053" starts with "#root " → 1
+ */
+int view_starts_with(TextView view, const char* prefix) {
+    size_t len = strlen(prefix);
+    return view.len >= len && memcmp(view.data, prefix, len) == 0;
+}
+
+
+/*
+ * FUNCTION: view_trim
+ * ───────────────────
+ * Drops spaces, tabs and line endings from both ends.
+ */
+static int is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+TextView view_trim(TextView view) {
+    while (view.len > 0 && is_blank(view.data[0])) {
+        view.data++;
+        view.len--;
+    }
+    while (view.len > 0 && is_blank(view.data[view.len - 1])) {
+        view.len--;
+    }
+    return view;
+}
+
+
+/*
+ * FUNCTION: view_split
+ * ────────────────────
+ * Cuts a view in two at the FIRST `sep`:
+ *
+ *   "blob 123 a b.txt", ' '  →  "blob" | "123 a b.txt"
+ *
+ * RETURNS: 1 if `sep` was found, 0 if not (views untouched)
+ */
+int view_split(TextView view, char sep, TextView* left, TextView* right) {
+    const char* hit = memchr(view.data, sep, view.len);
+    if (!hit) return 0;
+
+    TextView l = { view.data, (size_t)(hit - view.data) };
+    TextView r = { hit + 1, view.len - l.len - 1 };
+    *left = l;
+    *right = r;
+    return 1;
+}
+
+
+/*
+ * FUNCTION: view_split_last
+ * ─────────────────────────
+ * Same, at the LAST `sep` — file names may contain '|',
+ * hashes never do:
+ *
+ *   "a|b.txt|5864370", '|'  →  "a|b.txt" | "5864370"
+ */
+int view_split_last(TextView view, char sep, TextView* left, TextView* right) {
+    size_t i = view.len;
+    while (i > 0 && view.data[i - 1] != sep) {
+        i--;
+    }
+    if (i == 0) return 0;
+
+    TextView l = { view.data, i - 1 };
+    TextView r = { view.data + i, view.len - i };
+    *left = l;
+    *right = r;
+    return 1;
+}
+
+
+/*
+ * FUNCTION: view_next_item
+ * ────────────────────────
+ * The reentrant replacement for strtok: takes the next item
+ * of a `sep`-separated list and shrinks the list past it.
+ *
+ *   list = "a.txt,b.txt"  →  item "a.txt", list = "b.txt"
+ *                         →  item "b.txt", list = ""
+ *                         →  0 (done)
+ */
+int view_next_item(TextView* list, char sep, TextView* item) {
+    if (list->len == 0) return 0;
+
+    if (!view_split(*list, sep, item, list)) {
+        *item = *list;
+        list->data += list->len;
+        list->len = 0;
+    }
+    return 1;
+}
+
+
+/*
+ * FUNCTION: view_take_number
+ * ──────────────────────────
+ * Reads a (possibly signed) decimal number from the FRONT of
+ * the view and moves the view past it:
+ *
+ *   "2025-01-15"  →  2025, view is now "-01-15"
+ *
+ * RETURNS: 1 if there was a number, 0 if not (view untouched)
+ */
+int view_take_number(TextView* view, long long* out) {
+    size_t i = 0;
+    int negative = 0;
+
+    if (i < view->len && (view->data[i] == '-' || view->data[i] == '+')) {
+        negative = view->data[i] == '-';
+        i++;
+    }
+    if (i >= view->len || view->data[i] < '0' || view->data[i] > '9') {
+        return 0;
+    }
+
+    /* Too many digits for a long long → stop at its limit, but
+     * still consume them all */
+    unsigned long long limit = negative ? (unsigned long long)LLONG_MAX + 1 : (unsigned long long)LLONG_MAX;
+    unsigned long long value = 0;
+    while (i < view->len && view->data[i] >= '0' && view->data[i] <= '9') {
+        unsigned long long digit = (unsigned long long)(view->data[i] - '0');
+        value = value > (limit - digit) / 10 ? limit : value * 10 + digit;
+        i++;
+    }
+
+    if (negative) {
+        *out = value > (unsigned long long)LLONG_MAX ? LLONG_MIN : -(long long)value;
+    } else {
+        *out = (long long)value;
+    }
+    view->data += i;
+    view->len -= i;
+    return 1;
+}
+
+
+/*
+ * FUNCTION: view_take_char
+ * ────────────────────────
+ * Consumes one expected character ("-" between date parts).
+ * RETURNS: 1 if it was there
+ */
+int view_take_char(TextView* view, char c) {
+    if (view->len == 0 || view->data[0] != c) return 0;
+    view->data++;
+    view->len--;
+    return 1;
+}
+
+
+/*
+ * FUNCTION: view_to_ll
+ * ────────────────────
+ * Parses a decimal number that starts the view.
+ * Views are NOT '\0'-terminated, so strtol can't be used here.
+ * RETURNS: the number, or `fallback` if there is none
+ */
+long long view_to_ll(TextView view, long long fallback) {
+    long long value;
+    return view_take_number(&view, &value) ? value : fallback;
+}
+
+
+/*
+ * FUNCTION: view_to_ul
+ * ────────────────────
+ * STRICT parse of an unsigned number (hashes, tree ids):
+ * the WHOLE view must be digits and must fit.
+ * RETURNS: 1 → ok, 0 → not a number
+ */
+int view_to_ul(TextView view, unsigned long* out) {
+    if (view.len == 0) return 0;
+
+    unsigned long value = 0;
+    for (size_t i = 0; i < view.len; i++) {
+        char c = view.data[i];
+        if (c < '0' || c > '9') return 0;
+
+        unsigned long digit = (unsigned long)(c - '0');
+        if (value > (~0UL - digit) / 10) return 0;   /* would overflow */
+        value = value * 10 + digit;
+    }
+
+    *out = value;
+    return 1;
+}
+
+
+/*
+ * FUNCTION: view_copy
+ * ───────────────────
+ * For the few places that must OWN a string (a struct field,
+ * a path handed to fopen): copy the view and add '\0'.
+ * RETURNS: 0 → copied, -1 → doesn't fit (buffer untouched)
+ */
+int view_copy(TextView view, char* buffer, size_t size) {
+    if (view.len >= size) return -1;
+    memcpy(buffer, view.data, view.len);
+    buffer[view.len] = '\0';
+    return 0;
+}
+
+
+/* ─────────── LINES ─────────── */
+
+/*
+ * FUNCTION: lines_init / lines_next
+ * ─────────────────────────────────
+ * Walks a buffer line by line:
+ *
+ *   LineCursor c;
+ *   TextView line;
+ *   lines_init(&c, mf.data, mf.size);
+ *   while (lines_next(&c, &line)) { ... }
+ *
+ * The line excludes its "\n" / "\r\n". A last line without a
+ * newline is still returned.
+ */
+void lines_init(LineCursor* cursor, const char* data, size_t len) {
+    cursor->pos = data;
+    cursor->end = data + len;
+}
+
+int lines_next(LineCursor* cursor, TextView* line) {
+    if (cursor->pos >= cursor->end) return 0;
+
+    const char* eol = memchr(cursor->pos, '\n', cursor->end - cursor->pos);
+    const char* stop = eol ? eol : cursor->end;
+
+    line->data = cursor->pos;
+    line->len = stop - cursor->pos;
+    if (line->len > 0 && line->data[line->len - 1] == '\r') {
+        line->len--;
+    }
+
+    cursor->pos = eol ? eol + 1 : cursor->end;
+    return 1;
+}
+
+
+/* ─────────── .mygit FORMATS ─────────── */
+
+/*
+ * FUNCTION: staging_next
+ * ──────────────────────
+ * Next staged file in staging.dat:
+ *
+ *   # MyGit Staging Area         ← comment, skipped
+ *   #root 8069698787644          ← working-folder root, skipped
+ *   src/a.c|5863879              ← path "src/a.c", hash 5863879
+ *
+ * RETURNS: 1 → got one, 0 → no more
+ */
+int staging_next(LineCursor* cursor, TextView* path, unsigned long* hash) {
+    TextView line;
+    while (lines_next(cursor, &line)) {
+        if (line.len == 0 || line.data[0] == '#') {
+            continue;
+        }
+
+        TextView hash_text;
+        if (view_split_last(line, '|', path, &hash_text)
+            && path->len > 0 && view_to_ul(hash_text, hash)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/*
+ * FUNCTION: read_ref
+ * ──────────────────
+ * A ref (refs/<branch>) holds one commit id, like "12\n".
+ * RETURNS: the id, or 0 if the ref is missing or empty
+ */
+int read_ref(const char* ref_path) {
+    MappedFile mf;
+    if (map_file(ref_path, &mf) != 0) {
+        return 0;
+    }
+
+    TextView content = { mf.data, mf.size };
+    int id = (int)view_to_ll(view_trim(content), 0);
+
+    unmap_file(&mf);
+    return id > 0 ? id : 0;
+}
@@ -0,0 +1,264 @@
+/*
+ * ============================================
+ *          MYGIT - Worker Pool
+ *          Run independent jobs on every CPU core
+ * ============================================
+ *
+ * PURPOSE:
+ *   "log --stat" has to diff every commit against its parent.
+ *   Those diffs don't depend on each other, so instead of doing
+ *   them one after another we hand them to a few WORKER THREADS.
+ *
+ * ANALOGY: a kitchen with several cooks
+ *   The waiter (main thread) pins order tickets (tasks) to a
+ *   rail (the queue). Any free cook takes the oldest ticket,
+ *   cooks, and marks it done. The waiter serves the plates in
+ *   the order the guests ordered — waiting at the pass for the
+ *   next one if it isn't ready yet — even if later plates were
+ *   finished first.
+ *
+ * USAGE:
+ *   typedef struct MyJob {
+ *       PoolTask task;          // first member
+ *       ... inputs / outputs ...
+ *   } MyJob;
+ *
+ *   job.task.run = my_run;      // called on a worker thread
+ *   pool_submit(pool, &job.task);
+ *   ...
+ *   pool_wait(pool, &job.task); // now job's outputs are ready
+ *
+ * THREADS:
+ *   POSIX threads on Linux/Mac, Windows threads on Windows.
+ *   With one CPU (or if threads can't be started) there is no
+ *   pool: pool_submit() simply runs the task right away, so
+ *   callers never need a separate single-threaded path.
+ */
+
+#include "mygit.h"
+
+#ifdef _WIN32
+typedef HANDLE             PoolThread;
+typedef CRITICAL_SECTION   PoolMutex;
+typedef CONDITION_VARIABLE PoolCond;
+#define mutex_init(m)      InitializeCriticalSection(m)
+#define mutex_destroy(m)   DeleteCriticalSection(m)
+#define mutex_lock(m)      EnterCriticalSection(m)
+#define mutex_unlock(m)    LeaveCriticalSection(m)
+#define cond_init(c)       InitializeConditionVariable(c)
+#define cond_destroy(c)    ((void)(c))
+#define cond_wait(c, m)    SleepConditionVariableCS(c, m, INFINITE)
+#define cond_signal(c)     WakeConditionVariable(c)
+#define cond_broadcast(c)  WakeAllConditionVariable(c)
+#else
+#include <pthread.h>
+typedef pthread_t          PoolThread;
+typedef pthread_mutex_t    PoolMutex;
+typedef pthread_cond_t     PoolCond;
+#define mutex_init(m)      pthread_mutex_init(m, NULL)
+#define mutex_destroy(m)   pthread_mutex_destroy(m)
+#define mutex_lock(m)      pthread_mutex_lock(m)
+#define mutex_unlock(m)    pthread_mutex_unlock(m)
+#define cond_init(c)       pthread_cond_init(c, NULL)
+#define cond_destroy(c)    pthread_cond_destroy(c)
+#define cond_wait(c, m)    pthread_cond_wait(c, m)
+#define cond_signal(c)     pthread_cond_signal(c)
+#define cond_broadcast(c)  pthread_cond_broadcast(c)
+#endif
+
+#define POOL_MAX_THREADS 16
+
+struct WorkPool {
+    PoolMutex lock;
+    PoolCond has_work;               // a task was queued (or stop)
+    PoolCond task_done;              // some task finished
+    PoolTask* head;                  // queue, oldest first
+    PoolTask* tail;
+    int stopping;
+    int thread_count;
+    PoolThread threads[POOL_MAX_THREADS];
+};
+
+
+/*
+ * FUNCTION: worker_loop
+ * ─────────────────────
+ * What every worker thread does until the pool stops:
+ * take the oldest task, run it (without holding the lock),
+ * mark it done, wake whoever may be waiting for it.
+ */
+static void worker_loop(WorkPool* pool) {
+    mutex_lock(&pool->lock);
+
+    for (;;) {
+        while (!pool->head && !pool->stopping) {
+            cond_wait(&pool->has_work, &pool->lock);
+        }
+        if (!pool->head) {
+            break;                   // stopping, and nothing left
+        }
+
+        PoolTask* task = pool->head;
+        pool->head = task->next;
+        if (!pool->head) pool->tail = NULL;
+
+        mutex_unlock(&pool->lock);
+        task->run(task);
+        mutex_lock(&pool->lock);
+
+        task->done = 1;
+        cond_broadcast(&pool->task_done);
+    }
+
+    mutex_unlock(&pool->lock);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI worker_main(LPVOID arg) {
+    worker_loop(arg);
+    return 0;
+}
+#else
+static void* worker_main(void* arg) {
+    worker_loop(arg);
+    return NULL;
+}
+#endif
+
+
+/*
+ * FUNCTION: pool_cpu_count
+ * ────────────────────────
+ * How many CPU cores can run our threads (at least 1).
+ */
+int pool_cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    long n = (long)info.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return n > 0 ? (int)n : 1;
+}
+
+
+/*
+ * FUNCTION: pool_start
+ * ────────────────────
+ * Starts `threads` workers (capped at POOL_MAX_THREADS).
+ *
+ * RETURNS: the pool, or NULL → no pool; tasks then run
+ *          inline in pool_submit()
+ */
+WorkPool* pool_start(int threads) {
+    if (threads > POOL_MAX_THREADS) threads = POOL_MAX_THREADS;
+    if (threads <= 1) {
+        return NULL;
+    }
+
+    WorkPool* pool = calloc(1, sizeof(WorkPool));
+    if (!pool) {
+        return NULL;
+    }
+
+    mutex_init(&pool->lock);
+    cond_init(&pool->has_work);
+    cond_init(&pool->task_done);
+
+    for (int i = 0; i < threads; i++) {
+#ifdef _WIN32
+        pool->threads[i] = CreateThread(NULL, 0, worker_main, pool, 0, NULL);
+        int started = pool->threads[i] != NULL;
+#else
+        int started = pthread_create(&pool->threads[i], NULL, worker_main, pool) == 0;
+#endif
+        if (!started) {
+            break;
+        }
+        pool->thread_count++;
+    }
+
+    if (pool->thread_count == 0) {
+        pool_stop(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+
+/*
+ * FUNCTION: pool_submit
+ * ─────────────────────
+ * Queues a task. It runs on some worker, some time later.
+ */
+void pool_submit(WorkPool* pool, PoolTask* task) {
+    task->next = NULL;
+    task->done = 0;
+
+    if (!pool) {
+        task->run(task);
+        task->done = 1;
+        return;
+    }
+
+    mutex_lock(&pool->lock);
+    if (pool->tail) {
+        pool->tail->next = task;
+    } else {
+        pool->head = task;
+    }
+    pool->tail = task;
+    cond_signal(&pool->has_work);
+    mutex_unlock(&pool->lock);
+}
+
+
+/*
+ * FUNCTION: pool_wait
+ * ───────────────────
+ * Blocks until `task` has finished. Afterwards everything the
+ * task wrote is visible to the caller (the lock guarantees it).
+ */
+void pool_wait(WorkPool* pool, PoolTask* task) {
+    if (!pool) {
+        return;
+    }
+
+    mutex_lock(&pool->lock);
+    while (!task->done) {
+        cond_wait(&pool->task_done, &pool->lock);
+    }
+    mutex_unlock(&pool->lock);
+}
+
+
+/*
+ * FUNCTION: pool_stop
+ * ───────────────────
+ * Lets the workers finish what is queued, then ends them.
+ */
+void pool_stop(WorkPool* pool) {
+    if (!pool) {
+        return;
+    }
+
+    mutex_lock(&pool->lock);
+    pool->stopping = 1;
+    cond_broadcast(&pool->has_work);
+    mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->thread_count; i++) {
+#ifdef _WIN32
+        WaitForSingleObject(pool->threads[i], INFINITE);
+        CloseHandle(pool->threads[i]);
+#else
+        pthread_join(pool->threads[i], NULL);
+#endif
+    }
+
+    mutex_destroy(&pool->lock);
+    cond_destroy(&pool->has_work);
+    cond_destroy(&pool->task_done);
+    free(pool);
+}
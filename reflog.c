@@ -0,0 +1,262 @@
+/*
+ * ============================================
+ *          MYGIT - Reflog
+ *          .mygit/logs/<branch>
+ * ============================================
+ *
+ * PURPOSE:
+ *   A branch only remembers where it points NOW. After a bad
+ *   commit or a checkout you regret, "where was main an hour
+ *   ago?" used to mean reading commits.dat by hand.
+ *
+ *   The reflog is a diary per branch: every time the branch
+ *   moves, one line is added — from where, to where, when, why.
+ *
+ *     mygit reflog main
+ *       #8   main@{0}  2026-10-16 12:04:11  commit: fix parser
+ *       #7   main@{1}  2026-10-16 11:58:02  commit: add parser
+ *       #6   main@{2}  ...
+ *
+ *   and "mygit checkout main@{1}" takes you back there.
+ *
+ * FILE LAYOUT:
+ *   ┌────────────────────┐
+ *   │ ReflogHeader       │  magic "MGRL", version, entry size
+ *   ├────────────────────┤
+ *   │ ReflogEntry  0     │  oldest
+ *   │ ReflogEntry  1     │
+ *   │ ...                │
+ *   │ ReflogEntry  N-1   │  newest
+ *   └────────────────────┘
+ *
+ * WHY FIXED-SIZE BINARY ENTRIES?
+ *   Every entry is exactly 64 bytes, so "the Nth entry from the
+ *   end" is plain arithmetic — entries[count - 1 - n] — no
+ *   matter if the log has 10 entries or 10 million (years of CI
+ *   pushing to the same branch). Reading newest-first is walking
+ *   the mapped array backwards; nothing is parsed.
+ *
+ * APPEND-ONLY:
+ *   Entries are only ever added at the end, inside the same
+ *   write-ahead-log record that moves the branch (see refs.c
+ *   and wal.c), so the diary and the branch never disagree.
+ *   A torn last entry (crash mid-write) is simply not counted.
+ */
+
+#include "mygit.h"
+
+#define REFLOG_MAGIC   "MGRL"
+#define REFLOG_VERSION 1
+
+typedef struct ReflogHeader {
+    char     magic[4];               // "MGRL"
+    uint32_t version;                // REFLOG_VERSION
+    uint32_t entry_size;             // sizeof(ReflogEntry)
+    uint32_t reserved;
+} ReflogHeader;
+
+
+static int log_path(const char* name, char* path, size_t size) {
+    return snprintf(path, size, "%s/%s", LOGS_DIR, name) < (int)size ? 0 : -1;
+}
+
+
+/*
+ * FUNCTION: reflog_queue
+ * ──────────────────────
+ * Adds "<name> moved old_id → new_id because <reason>" to a
+ * write-ahead-log transaction. A branch's first entry also
+ * carries the file header.
+ *
+ * Called with the ref LOCKED (see ref_txn_queue), so nobody
+ * else can be creating the same log at the same time.
+ *
+ * RETURNS: 0 → Success, -1 → Error
+ */
+int reflog_queue(WalTxn* wal, const char* name, int old_id, int new_id, const char* reason) {
+    char path[MAX_PATH];
+    if (log_path(name, path, sizeof(path)) != 0) {
+        return -1;
+    }
+
+    /* .mygit/logs/ci/build-7 needs .mygit/logs/ci */
+    for (char* slash = strchr(path + strlen(MYGIT_DIR) + 1, '/'); slash; slash = strchr(slash + 1, '/')) {
+        *slash = '\0';
+        if (!directory_exists(path)) {
+            create_directory(path);
+        }
+        *slash = '/';
+    }
+
+    struct {
+        ReflogHeader header;
+        ReflogEntry entry;
+    } out;
+    memset(&out, 0, sizeof(out));
+
+    memcpy(out.header.magic, REFLOG_MAGIC, 4);
+    out.header.version = REFLOG_VERSION;
+    out.header.entry_size = sizeof(ReflogEntry);
+
+    out.entry.old_id = old_id;
+    out.entry.new_id = new_id;
+    out.entry.time = (int64_t)time(NULL);
+    strncpy(out.entry.reason, reason, sizeof(out.entry.reason) - 1);
+
+    struct stat st;
+    if (stat(path, &st) == 0 && st.st_size > 0) {
+        return wal_txn_append(wal, path, (const char*)&out.entry, sizeof(out.entry));
+    }
+    return wal_txn_append(wal, path, (const char*)&out, sizeof(out));
+}
+
+
+/*
+ * FUNCTION: reflog_open / reflog_close
+ * ────────────────────────────────────
+ * Maps a branch's reflog. A branch without one has 0 entries.
+ *
+ * RETURNS: 0 → Success, -1 → the file isn't a reflog
+ */
+int reflog_open(const char* name, Reflog* log) {
+    log->entries = NULL;
+    log->count = 0;
+
+    char path[MAX_PATH];
+    if (log_path(name, path, sizeof(path)) != 0 || map_file(path, &log->file) != 0) {
+        log->file.data = NULL;
+        log->file.size = 0;
+        log->file.is_mapped = 0;
+        return 0;
+    }
+
+    const ReflogHeader* header = (const ReflogHeader*)log->file.data;
+
+    if (log->file.size < sizeof(ReflogHeader)
+        || memcmp(header->magic, REFLOG_MAGIC, 4) != 0
+        || header->version != REFLOG_VERSION
+        || header->entry_size != sizeof(ReflogEntry)) {
+        unmap_file(&log->file);
+        return -1;
+    }
+
+    /* Rounding down drops a torn last entry */
+    log->entries = (const ReflogEntry*)(log->file.data + sizeof(ReflogHeader));
+    log->count = (int)((log->file.size - sizeof(ReflogHeader)) / sizeof(ReflogEntry));
+    return 0;
+}
+
+void reflog_close(Reflog* log) {
+    if (log->file.data) {
+        unmap_file(&log->file);
+    }
+    log->entries = NULL;
+    log->count = 0;
+}
+
+
+/*
+ * FUNCTION: reflog_nth
+ * ────────────────────
+ * The entry n steps back: 0 = newest ("main@{0}").
+ * O(1) — just an index into the mapped array.
+ *
+ * RETURNS: the entry, or NULL if the log is shorter
+ */
+const ReflogEntry* reflog_nth(const Reflog* log, int n) {
+    if (n < 0 || n >= log->count) {
+        return NULL;
+    }
+    return &log->entries[log->count - 1 - n];
+}
+
+
+/*
+ * FUNCTION: reflog_resolve
+ * ────────────────────────
+ * Understands "main@{2}" → where main was 2 moves ago.
+ *
+ * RETURNS:
+ *   1  → *id set
+ *   0  → not written like <branch>@{<n>}
+ *  -1  → it is, but that entry doesn't exist (message printed)
+ */
+int reflog_resolve(const char* spec, int* id) {
+    const char* at = strstr(spec, "@{");
+    size_t len = strlen(spec);
+    if (!at || at == spec || spec[len - 1] != '}') {
+        return 0;
+    }
+
+    TextView number = { at + 2, (size_t)(spec + len - 1 - (at + 2)) };
+    unsigned long n;
+    if (!view_to_ul(number, &n)) {
+        return 0;
+    }
+
+    char name[MAX_PATH];
+    TextView name_view = { spec, (size_t)(at - spec) };
+    if (view_copy(name_view, name, sizeof(name)) != 0) {
+        return 0;
+    }
+
+    Reflog log;
+    reflog_open(name, &log);
+    const ReflogEntry* entry = n < (unsigned long)log.count ? reflog_nth(&log, (int)n) : NULL;
+    if (entry) {
+        *id = entry->new_id;
+    }
+    int count = log.count;
+    reflog_close(&log);
+
+    if (!entry) {
+        printf(RED "✗ '%s' only has %d reflog entr%s\n" RESET, name, count, count == 1 ? "y" : "ies");
+        return -1;
+    }
+    return 1;
+}
+
+
+/*
+ * ═══════════════════════════════════════════════
+ * MAIN FUNCTION: mygit_reflog
+ * ═══════════════════════════════════════════════
+ *
+ * "mygit reflog [branch] [-n N]" — newest first.
+ * Only the N entries shown are ever touched.
+ */
+int mygit_reflog(const char* branch, int limit) {
+    char current[MAX_BRANCH_NAME];
+    if (!branch) {
+        get_current_branch(current, sizeof(current));
+        branch = current;
+    }
+
+    Reflog log;
+    if (reflog_open(branch, &log) != 0) {
+        printf(RED "✗ The reflog of '%s' is damaged\n" RESET, branch);
+        return 1;
+    }
+
+    if (log.count == 0) {
+        printf(YELLOW "No reflog entries for '%s' yet.\n" RESET, branch);
+        reflog_close(&log);
+        return 0;
+    }
+
+    int shown = limit > 0 && limit < log.count ? limit : log.count;
+
+    for (int n = 0; n < shown; n++) {
+        const ReflogEntry* entry = reflog_nth(&log, n);
+
+        char time_text[64];
+        format_timestamp((time_t)entry->time, time_text, sizeof(time_text));
+
+        printf(YELLOW "#%-4d" RESET " %s@{%d}  " CYAN "%s" RESET "  %.*s\n",
+               entry->new_id, branch, n, time_text,
+               (int)sizeof(entry->reason), entry->reason);
+    }
+
+    reflog_close(&log);
+    return 0;
+}
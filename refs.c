@@ -0,0 +1,809 @@
+/*
+ * ============================================
+ *          MYGIT - References (branches)
+ *          Loose refs + one packed-refs file
+ * ============================================
+ *
+ * TWO PLACES A BRANCH CAN LIVE:
+ *
+ *   LOOSE   .mygit/refs/<name>      one tiny file per branch,
+ *                                   holding its commit id
+ *
+ *   PACKED  .mygit/packed-refs      ONE sorted file for all:
+ *             # mygit packed-refs
+ *             12 ci/build-1041
+ *             12 ci/build-1042
+ *             9 feature/login
+ *             31 main
+ *
+ * WHY PACK?
+ *   A CI system that creates 5000 branches means 5000 files.
+ *   Listing them = 5000 opens. Finding one = a directory lookup
+ *   in a huge directory.
+ *   The packed file is mapped ONCE, and since it's sorted by
+ *   name, finding a branch is a BINARY SEARCH:
+ *   5000 branches → about 13 comparisons.
+ *
+ * WHO WINS?
+ *   A loose ref always overrides the packed one. Commits keep
+ *   writing loose refs (cheap, one small file); "mygit pack-refs"
+ *   folds them into packed-refs now and then.
+ */
+
+#include "mygit.h"
+
+#ifndef _WIN32
+    #include <sys/file.h>    // flock()
+#endif
+
+#define PACKED_REFS_HEADER "# mygit packed-refs\n"
+
+
+/* ─────────── THE PACKED FILE ─────────── */
+
+static MappedFile g_packed;
+static int g_packed_state;           // 0 = not loaded, 1 = mapped, -1 = no file
+
+
+static const MappedFile* packed_map(void) {
+    if (g_packed_state == 0) {
+        g_packed_state = map_file(PACKED_REFS_FILE, &g_packed) == 0 ? 1 : -1;
+    }
+    return g_packed_state == 1 ? &g_packed : NULL;
+}
+
+/* After pack-refs rewrote the file, map it again next time */
+static void packed_forget(void) {
+    if (g_packed_state == 1) {
+        unmap_file(&g_packed);
+    }
+    g_packed_state = 0;
+}
+
+
+/*
+ * FUNCTION: packed_parse_line
+ * ───────────────────────────
+ * "31 main" → name "main", id 31
+ * RETURNS: 1 if the line is a ref
+ */
+static int packed_parse_line(TextView line, TextView* name, int* id) {
+    TextView id_text;
+    unsigned long value;
+
+    if (line.len == 0 || line.data[0] == '#'
+        || !view_split(line, ' ', &id_text, name)
+        || !view_to_ul(id_text, &value) || name->len == 0) {
+        return 0;
+    }
+
+    *id = (int)value;
+    return 1;
+}
+
+
+/* Compares a view with a C string the way strcmp would */
+static int compare_name(TextView view, const char* name) {
+    size_t len = strlen(name);
+    size_t n = view.len < len ? view.len : len;
+
+    int cmp = memcmp(view.data, name, n);
+    if (cmp != 0) return cmp;
+    return view.len < len ? -1 : (view.len > len ? 1 : 0);
+}
+
+
+/*
+ * FUNCTION: packed_find
+ * ─────────────────────
+ * Binary search over a sorted file of VARIABLE-length lines.
+ *
+ *   1. Jump to the middle BYTE of the remaining range
+ *   2. Back up to the start of the line it landed in
+ *   3. Compare that line's name → keep the left or right half
+ *
+ * `lo` always sits at a line start, so step 2 never backs up
+ * past it.
+ *
+ * RETURNS: 1 and *id set if found
+ */
+static int packed_find(const char* name, int* id) {
+    const MappedFile* mf = packed_map();
+    if (!mf) return 0;
+
+    const char* data = mf->data;
+    size_t lo = 0;
+    size_t hi = mf->size;
+
+    /* Skip the header comment(s) */
+    while (lo < hi && data[lo] == '#') {
+        const char* eol = memchr(data + lo, '\n', hi - lo);
+        lo = eol ? (size_t)(eol - data) + 1 : hi;
+    }
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        while (mid > lo && data[mid - 1] != '\n') {
+            mid--;
+        }
+
+        const char* eol = memchr(data + mid, '\n', hi - mid);
+        size_t line_end = eol ? (size_t)(eol - data) : hi;
+
+        TextView line = { data + mid, line_end - mid };
+        if (line.len > 0 && line.data[line.len - 1] == '\r') line.len--;
+
+        TextView line_name;
+        int line_id;
+        if (!packed_parse_line(line, &line_name, &line_id)) {
+            return 0;   /* corrupt file — treat as "not packed" */
+        }
+
+        int cmp = compare_name(line_name, name);
+        if (cmp == 0) {
+            *id = line_id;
+            return 1;
+        }
+        if (cmp < 0) {
+            lo = line_end + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return 0;
+}
+
+
+/* ─────────── READING ONE REF ─────────── */
+
+static int loose_path(const char* name, char* path, size_t size) {
+    return snprintf(path, size, "%s/%s", REFS_DIR, name) < (int)size ? 0 : -1;
+}
+
+
+/*
+ * FUNCTION: ref_read
+ * ──────────────────
+ * Looks a branch up: loose file first, then packed-refs.
+ *
+ * RETURNS:
+ *   1 → found (*id = its commit, 0 if it has no commits yet)
+ *   0 → no such branch
+ */
+int ref_read(const char* name, int* id) {
+    char path[MAX_PATH];
+    if (loose_path(name, path, sizeof(path)) != 0) {
+        return 0;
+    }
+
+    if (file_exists(path) && !directory_exists(path)) {
+        *id = read_ref(path);
+        return 1;
+    }
+
+    return packed_find(name, id);
+}
+
+
+int ref_exists(const char* name) {
+    int id;
+    return ref_read(name, &id);
+}
+
+
+/* Our own temp files: "main.tmp", "main.tmp.4711" (see atomic_open), "main.lock" */
+static int is_temp_name(const char* name) {
+    size_t len = strlen(name);
+    const char* tmp = strstr(name, ".tmp.");
+    if (tmp && tmp[5] && strspn(tmp + 5, "0123456789") == strlen(tmp + 5)) {
+        return 1;
+    }
+    return (len >= 4 && strcmp(name + len - 4, ".tmp") == 0)
+        || (len >= 5 && strcmp(name + len - 5, ".lock") == 0);
+}
+
+
+/*
+ * FUNCTION: ref_name_valid
+ * ────────────────────────
+ * Branch names become file paths, so keep them tame:
+ * letters, digits, "-_./", no "..", no leading or trailing '/',
+ * and no ".tmp" / ".lock" ending (those are our temp files).
+ */
+int ref_name_valid(const char* name) {
+    size_t len = strlen(name);
+    if (len == 0 || len >= MAX_BRANCH_NAME || name[0] == '/' || name[0] == '.'
+        || name[len - 1] == '/' || strstr(name, "..") || strstr(name, "//")) {
+        return 0;
+    }
+
+    for (const char* p = name; *p; p++) {
+        char c = *p;
+        int ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')
+              || (c >= '0' && c <= '9') || c == '-' || c == '_' || c == '.' || c == '/';
+        if (!ok) return 0;
+    }
+
+    return !is_temp_name(name);
+}
+
+
+/* refs/ci/build-7 needs its refs/ci folder */
+static void make_ref_dirs(char* path) {
+    for (char* slash = strchr(path + strlen(REFS_DIR) + 1, '/'); slash; slash = strchr(slash + 1, '/')) {
+        *slash = '\0';
+        if (!directory_exists(path)) {
+            create_directory(path);
+        }
+        *slash = '/';
+    }
+}
+
+
+/* ─────────── LISTING ALL REFS ─────────── */
+
+typedef struct RefList {
+    RefInfo* items;
+    int count;
+    int capacity;
+} RefList;
+
+static int ref_list_add(RefList* list, const char* name, int id) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 64;
+        RefInfo* grown = realloc(list->items, capacity * sizeof(RefInfo));
+        if (!grown) return -1;
+        list->items = grown;
+        list->capacity = capacity;
+    }
+
+    RefInfo* r = &list->items[list->count++];
+    strncpy(r->name, name, MAX_PATH - 1);
+    r->name[MAX_PATH - 1] = '\0';
+    r->id = id;
+    return 0;
+}
+
+static int compare_refs(const void* a, const void* b) {
+    return strcmp(((const RefInfo*)a)->name, ((const RefInfo*)b)->name);
+}
+
+
+/*
+ * FUNCTION: collect_loose
+ * ───────────────────────
+ * Walks refs/ (and sub-folders like refs/ci/) collecting
+ * every loose ref. `prefix` is the name so far: "" or "ci/".
+ */
+static void collect_loose(const char* dir, const char* prefix, RefList* list) {
+    char path[MAX_PATH];
+    char name[MAX_PATH];
+
+#ifdef _WIN32
+    char pattern[MAX_PATH];
+    snprintf(pattern, sizeof(pattern), "%s\\*", dir);
+
+    WIN32_FIND_DATAA found;
+    HANDLE h = FindFirstFileA(pattern, &found);
+    if (h == INVALID_HANDLE_VALUE) return;
+
+    do {
+        const char* entry = found.cFileName;
+#else
+    DIR* d = opendir(dir);
+    if (!d) return;
+
+    struct dirent* de;
+    while ((de = readdir(d)) != NULL) {
+        const char* entry = de->d_name;
+#endif
+        if (entry[0] == '.' || is_temp_name(entry)) continue;
+
+        if (snprintf(path, sizeof(path), "%s/%s", dir, entry) >= (int)sizeof(path)
+            || snprintf(name, sizeof(name), "%s%s", prefix, entry) >= (int)sizeof(name)) {
+            continue;
+        }
+
+        if (directory_exists(path)) {
+            char sub_prefix[MAX_PATH];
+            if (snprintf(sub_prefix, sizeof(sub_prefix), "%s/", name) < (int)sizeof(sub_prefix)) {
+                collect_loose(path, sub_prefix, list);
+            }
+        } else {
+            ref_list_add(list, name, read_ref(path));
+        }
+#ifdef _WIN32
+    } while (FindNextFileA(h, &found));
+    FindClose(h);
+#else
+    }
+    closedir(d);
+#endif
+}
+
+
+/*
+ * FUNCTION: refs_list
+ * ───────────────────
+ * Every branch, sorted by name, each exactly once.
+ *
+ * HOW: a MERGE of two sorted lists —
+ *   loose refs (sorted after reading the folder)
+ *   packed refs (already sorted in the file)
+ * When both have a name, the loose one wins.
+ *
+ * RETURNS: malloc'd array (caller frees), count in *count
+ */
+RefInfo* refs_list(int* count) {
+    RefList loose = { NULL, 0, 0 };
+    RefList merged = { NULL, 0, 0 };
+
+    collect_loose(REFS_DIR, "", &loose);
+    if (loose.count > 0) {           // no loose refs → items is still NULL
+        qsort(loose.items, loose.count, sizeof(RefInfo), compare_refs);
+    }
+
+    const MappedFile* mf = packed_map();
+    LineCursor cursor;
+    lines_init(&cursor, mf ? mf->data : "", mf ? mf->size : 0);
+
+    TextView line, packed_name;
+    int packed_id = 0;
+    int have_packed = 0;
+    int i = 0;
+
+    for (;;) {
+        /* Pull the next packed ref if we don't hold one */
+        while (!have_packed && lines_next(&cursor, &line)) {
+            have_packed = packed_parse_line(line, &packed_name, &packed_id);
+        }
+
+        if (!have_packed && i >= loose.count) break;
+
+        int cmp;
+        if (!have_packed)         cmp = -1;
+        else if (i >= loose.count) cmp = 1;
+        else                       cmp = -compare_name(packed_name, loose.items[i].name);
+
+        if (cmp <= 0) {
+            /* loose first (or same name → loose wins) */
+            ref_list_add(&merged, loose.items[i].name, loose.items[i].id);
+            i++;
+            if (cmp == 0) have_packed = 0;
+        } else {
+            char name[MAX_PATH];
+            if (view_copy(packed_name, name, sizeof(name)) == 0) {
+                ref_list_add(&merged, name, packed_id);
+            }
+            have_packed = 0;
+        }
+    }
+
+    free(loose.items);
+    *count = merged.count;
+    return merged.items;
+}
+
+
+/* Steps 1 + 2: write the sorted list to packed-refs */
+static int write_packed(const RefInfo* refs, int count) {
+    AtomicFile af;
+    if (atomic_open(&af, PACKED_REFS_FILE) != 0) {
+        return -1;
+    }
+
+    fputs(PACKED_REFS_HEADER, af.fp);
+    for (int i = 0; i < count; i++) {
+        fprintf(af.fp, "%d %s\n", refs[i].id, refs[i].name);
+    }
+
+    packed_forget();
+    return atomic_commit(&af);
+}
+
+
+/*
+ * FUNCTION: refs_pack
+ * ───────────────────
+ * "mygit pack-refs": fold every loose ref into packed-refs.
+ *
+ *   1. Merge loose + packed (loose wins)  → sorted list
+ *   2. Write a tmp file, rename it over packed-refs
+ *   3. Delete each loose file — but only if it STILL holds the
+ *      value we packed (a commit may have moved it meanwhile).
+ *      Check + delete happen under that ref's lock, so a commit
+ *      can't slip in between.
+ *
+ * packed-refs itself stays locked the whole time, so two
+ * pack-refs never race to rename over it.
+ *
+ * RETURNS: number of refs packed, or -1 on error
+ */
+int refs_pack(void) {
+    if (lockfile_acquire(PACKED_REFS_FILE) != 0) {
+        return -1;
+    }
+
+    int count;
+    RefInfo* refs = refs_list(&count);
+
+    if (write_packed(refs, count) != 0) {
+        count = -1;
+    }
+
+    /* Step 3 */
+    for (int i = 0; i < count; i++) {
+        char path[MAX_PATH];
+        if (loose_path(refs[i].name, path, sizeof(path)) != 0 || !file_exists(path)) {
+            continue;
+        }
+        if (lockfile_acquire(path) != 0) {
+            continue;                    // busy: leave it loose
+        }
+        if (read_ref(path) == refs[i].id) {
+            remove(path);
+        }
+        lockfile_release(path);
+    }
+
+    free(refs);
+    lockfile_release(PACKED_REFS_FILE);
+    return count;
+}
+
+
+/*
+ * ─────────── REF TRANSACTIONS ───────────
+ *
+ * PROBLEM:
+ *   Two "mygit commit"s on the same branch at the same time:
+ *
+ *     A reads main = 5          B reads main = 5
+ *     A writes commit #6        B writes commit #7
+ *     A sets main = 6           B sets main = 7   ← #6 is LOST
+ *
+ * SOLUTION — compare-and-swap with lock files:
+ *   1. Lock refs/main.lock (only ONE process can hold it)
+ *   2. Check main still says what we expect (5). If not,
+ *      someone beat us: unlock and let the caller retry.
+ *   3. Write the new value, rename it over refs/main, unlock.
+ *
+ * A transaction can hold several refs: ALL are locked and
+ * checked before ANY is written, and the new values go through
+ * the write-ahead log in one record — all or nothing.
+ */
+
+#define LOCK_WAIT_MS   2000          // give up on a busy lock after this
+#define LOCK_POLL_MS   5
+
+
+static void sleep_ms(int ms) {
+#ifdef _WIN32
+    Sleep(ms);
+#else
+    struct timespec ts = { ms / 1000, (long)(ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+#endif
+}
+
+
+/*
+ * The locks this process holds: lockfile_release only gets the
+ * path, but the lock lives on the open file.
+ */
+typedef struct HeldLock {
+    char path[MAX_PATH];
+#ifdef _WIN32
+    HANDLE handle;
+#else
+    int fd;
+#endif
+} HeldLock;
+
+static HeldLock* g_held;
+static int g_held_count;
+static int g_held_capacity;
+
+
+/*
+ * FUNCTION: lockfile_acquire / lockfile_release
+ * ─────────────────────────────────────────────
+ * Locks "<path>.lock" for this process.
+ *
+ *   Linux/Mac: flock() on the file — the same lock wal.c uses
+ *   Windows:   the file opened with NO sharing, deleted on close
+ *
+ * Either way the OS drops the lock when the process dies, so a
+ * crash can never leave a branch locked forever. (On Linux/Mac
+ * the file itself stays behind: deleting a flock'd file would
+ * let a late-comer lock a NEW file of the same name while
+ * someone still holds the old one.)
+ *
+ * A busy lock is retried for a while, then we give up.
+ *
+ * RETURNS: 0 → we hold it, -1 → couldn't get it
+ */
+int lockfile_acquire(const char* path) {
+    char lock_path[MAX_PATH + 8];
+    snprintf(lock_path, sizeof(lock_path), "%s.lock", path);
+
+    if (g_held_count == g_held_capacity) {
+        int capacity = g_held_capacity ? g_held_capacity * 2 : 4;
+        HeldLock* grown = realloc(g_held, capacity * sizeof(HeldLock));
+        if (!grown) return -1;
+        g_held = grown;
+        g_held_capacity = capacity;
+    }
+    HeldLock* held = &g_held[g_held_count];
+    snprintf(held->path, sizeof(held->path), "%s", path);
+    int busy = 0;
+
+#ifdef _WIN32
+    for (int waited = 0; ; waited += LOCK_POLL_MS) {
+        held->handle = CreateFileA(lock_path, GENERIC_WRITE, 0, NULL, OPEN_ALWAYS,
+                                   FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, NULL);
+        if (held->handle != INVALID_HANDLE_VALUE) {
+            g_held_count++;
+            return 0;
+        }
+        busy = GetLastError() == ERROR_SHARING_VIOLATION;
+        if (!busy || waited >= LOCK_WAIT_MS) {
+            break;
+        }
+        sleep_ms(LOCK_POLL_MS);
+    }
+#else
+    held->fd = open(lock_path, O_RDWR | O_CREAT, 0644);
+    if (held->fd >= 0) {
+        for (int waited = 0; ; waited += LOCK_POLL_MS) {
+            if (flock(held->fd, LOCK_EX | LOCK_NB) == 0) {
+                g_held_count++;
+                return 0;
+            }
+            busy = errno == EWOULDBLOCK;
+            if (!busy || waited >= LOCK_WAIT_MS) {
+                break;
+            }
+            sleep_ms(LOCK_POLL_MS);
+        }
+        close(held->fd);
+    }
+#endif
+
+    printf(RED "✗ Could not lock %s\n" RESET, path);
+    if (busy) {
+        printf("  Another mygit is still working on it — try again in a moment.\n");
+    }
+    return -1;
+}
+
+void lockfile_release(const char* path) {
+    for (int i = g_held_count - 1; i >= 0; i--) {
+        if (strcmp(g_held[i].path, path) != 0) {
+            continue;
+        }
+#ifdef _WIN32
+        CloseHandle(g_held[i].handle);   // also deletes the file
+#else
+        close(g_held[i].fd);             // closing drops the flock
+#endif
+        g_held[i] = g_held[--g_held_count];
+        return;
+    }
+}
+
+
+void ref_txn_init(RefTxn* txn) {
+    txn->updates = NULL;
+    txn->count = 0;
+    txn->capacity = 0;
+    txn->locked = 0;
+}
+
+void ref_txn_free(RefTxn* txn) {
+    ref_txn_unlock(txn);
+    free(txn->updates);
+    ref_txn_init(txn);
+}
+
+
+/*
+ * FUNCTION: ref_txn_update
+ * ────────────────────────
+ * Adds "set <name> from <old_id> to <new_id>" to the transaction.
+ *
+ *   old_id = REF_MUST_NOT_EXIST → the branch must be new
+ *   old_id = REF_ANY_VALUE      → don't check (plain overwrite)
+ *
+ * `reason` ends up in the branch's reflog ("commit: fix bug").
+ *
+ * RETURNS: 0 → Success, -1 → Error
+ */
+int ref_txn_update(RefTxn* txn, const char* name, int old_id, int new_id, const char* reason) {
+    if (txn->locked) return -1;
+
+    if (txn->count == txn->capacity) {
+        int capacity = txn->capacity ? txn->capacity * 2 : 4;
+        RefUpdate* grown = realloc(txn->updates, capacity * sizeof(RefUpdate));
+        if (!grown) return -1;
+        txn->updates = grown;
+        txn->capacity = capacity;
+    }
+
+    RefUpdate* u = &txn->updates[txn->count++];
+    strncpy(u->name, name, MAX_PATH - 1);
+    u->name[MAX_PATH - 1] = '\0';
+    u->old_id = old_id;
+    u->new_id = new_id;
+    u->found_id = 0;
+    strncpy(u->reason, reason, sizeof(u->reason) - 1);
+    u->reason[sizeof(u->reason) - 1] = '\0';
+    return 0;
+}
+
+
+static int compare_updates(const void* a, const void* b) {
+    return strcmp(((const RefUpdate*)a)->name, ((const RefUpdate*)b)->name);
+}
+
+
+/*
+ * FUNCTION: ref_txn_lock
+ * ──────────────────────
+ * Locks every ref in the transaction and checks its old value.
+ *
+ * Locks are always taken in NAME order, so two transactions
+ * touching the same refs can never each hold what the other
+ * waits for (no deadlock).
+ *
+ * RETURNS:
+ *   0                → all locked and as expected
+ *   REF_TXN_CONFLICT → a ref moved; nothing is held any more
+ *   -1               → couldn't lock; nothing is held any more
+ */
+int ref_txn_lock(RefTxn* txn) {
+    qsort(txn->updates, txn->count, sizeof(RefUpdate), compare_updates);
+
+    /* Another process may have re-packed since we mapped it */
+    packed_forget();
+
+    for (int i = 0; i < txn->count; i++) {
+        RefUpdate* u = &txn->updates[i];
+
+        char path[MAX_PATH];
+        if (loose_path(u->name, path, sizeof(path)) != 0) {
+            ref_txn_unlock(txn);
+            return -1;
+        }
+        make_ref_dirs(path);             // the lock file lives next to the ref
+
+        if (lockfile_acquire(path) != 0) {
+            ref_txn_unlock(txn);
+            return -1;
+        }
+        txn->locked = i + 1;
+
+        int current = 0;
+        int exists = ref_read(u->name, &current);
+        u->found_id = exists ? current : 0;
+
+        if (u->old_id == REF_ANY_VALUE) {
+            continue;
+        }
+
+        int as_expected = u->old_id == REF_MUST_NOT_EXIST ? !exists
+                                                          : (exists ? current : 0) == u->old_id;
+        if (!as_expected) {
+            ref_txn_unlock(txn);
+            return REF_TXN_CONFLICT;
+        }
+    }
+    return 0;
+}
+
+
+/*
+ * FUNCTION: ref_txn_queue
+ * ───────────────────────
+ * Adds the new ref values — and a reflog entry for each (see
+ * reflog.c) — to a WAL transaction (see wal.c).
+ * The caller may put more into the same record — a commit
+ * adds its commit record and the staging reset.
+ *
+ * Each ref goes in as "from <value we saw under the lock> to
+ * <new value>", so a redo after a crash can tell whether the
+ * branch has moved on since (ref_apply_logged).
+ */
+int ref_txn_queue(const RefTxn* txn, WalTxn* wal) {
+    for (int i = 0; i < txn->count; i++) {
+        const RefUpdate* u = &txn->updates[i];
+
+        if (wal_txn_ref(wal, u->name, u->found_id, u->new_id) != 0
+            || reflog_queue(wal, u->name, u->found_id, u->new_id, u->reason) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+
+/*
+ * FUNCTION: ref_apply_logged
+ * ──────────────────────────
+ * Carries out one ref update from the write-ahead log:
+ * <name> becomes new_id — but only if it still says old_id
+ * (0 = the ref didn't exist). Already saying new_id counts as
+ * done: the update landed before a crash.
+ *
+ * check_only → don't write, just tell.
+ *
+ * RETURNS: 0 → done (or would be), REF_TXN_CONFLICT → the ref
+ *          moved on in between, -1 → write error
+ */
+int ref_apply_logged(const char* name, int old_id, int new_id, int check_only) {
+    packed_forget();
+
+    int current = 0;
+    if (!ref_read(name, &current)) {
+        current = 0;
+    }
+    if (current == new_id) {
+        return 0;
+    }
+    if (current != old_id) {
+        return REF_TXN_CONFLICT;
+    }
+    if (check_only) {
+        return 0;
+    }
+
+    char path[MAX_PATH];
+    char id_text[20];
+    if (loose_path(name, path, sizeof(path)) != 0) {
+        return -1;
+    }
+    make_ref_dirs(path);
+    snprintf(id_text, sizeof(id_text), "%d", new_id);
+    return write_file_atomic(path, id_text, strlen(id_text));
+}
+
+
+void ref_txn_unlock(RefTxn* txn) {
+    for (int i = 0; i < txn->locked; i++) {
+        char path[MAX_PATH];
+        if (loose_path(txn->updates[i].name, path, sizeof(path)) == 0) {
+            lockfile_release(path);
+        }
+    }
+    txn->locked = 0;
+}
+
+
+/*
+ * FUNCTION: ref_txn_commit
+ * ────────────────────────
+ * The whole thing for ref-only changes (e.g. creating a branch):
+ * finish a crashed record first, then lock + check → log +
+ * write → unlock.
+ *
+ * RETURNS: 0, REF_TXN_CONFLICT or -1 (see ref_txn_lock)
+ */
+int ref_txn_commit(RefTxn* txn) {
+    if (wal_recover() != 0) {
+        return -1;
+    }
+
+    int rc = ref_txn_lock(txn);
+    if (rc != 0) {
+        return rc;
+    }
+
+    WalTxn wal;
+    wal_txn_init(&wal);
+
+    rc = ref_txn_queue(txn, &wal) == 0 ? wal_commit(&wal) : -1;
+
+    wal_txn_free(&wal);
+    ref_txn_unlock(txn);
+    return rc;
+}
@@ -0,0 +1,415 @@
+/*
+ * ============================================
+ *          MYGIT - Text Search
+ *          "mygit grep <text> [branch]"
+ *          "mygit log --grep" without an index
+ * ============================================
+ *
+ * PURPOSE:
+ *   Find a piece of text inside a LOT of bytes — every commit
+ *   message in commits.dat, or every file of a snapshot.
+ *
+ * THE IDEA (compare 32 positions at once):
+ *   Looking for "parser" the slow way means trying every
+ *   position. Instead we ask, for 32 positions in one go:
+ *
+ *     "is the byte here 'p'  AND  the byte 5 later 'r'?"
+ *
+ *     text:   ...the new parser is fast...
+ *     'p'?    0000000100000000000000000000
+ *     'r'?    0000000100000000000000000000   (shifted by 5)
+ *     both:   0000000100000000000000000000   → check position 7
+ *
+ *   A CPU vector register holds 32 bytes (AVX2) or 16 (SSE2),
+ *   and one instruction compares all of them. Only positions
+ *   where both the first AND last character match are checked
+ *   in full — in normal text that is rare, so we move through
+ *   the data at close to memory speed.
+ *
+ * WHICH INSTRUCTIONS?
+ *   Decided once, at run time:
+ *     AVX2   if the CPU has it       (32 bytes per step)
+ *     SSE2   any other x86-64 CPU    (16 bytes per step)
+ *     plain C everywhere else        (memchr + memcmp)
+ *   All three give identical answers.
+ *
+ * IGNORING CASE:
+ *   'A' (0x41) and 'a' (0x61) differ only in bit 0x20. Setting
+ *   that bit on both sides before comparing makes 'A' == 'a';
+ *   it also lets a few non-letters through ('@' == '`'), but
+ *   every candidate is checked properly afterwards anyway.
+ */
+
+#include "mygit.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SEARCH_X86 1
+#include <immintrin.h>
+#endif
+
+
+static unsigned char fold(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? (unsigned char)(c - 'A' + 'a') : c;
+}
+
+/* Full check of one candidate position */
+static int same_text(const char* a, const char* b, size_t len, int ignore_case) {
+    if (!ignore_case) {
+        return memcmp(a, b, len) == 0;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (fold((unsigned char)a[i]) != fold((unsigned char)b[i])) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+/*
+ * FUNCTION: find_scalar
+ * ─────────────────────
+ * Plain C version. Case-sensitive searches let memchr (itself
+ * vectorized in most C libraries) jump to the first character.
+ */
+static const char* find_scalar(const char* hay, size_t len,
+                               const char* needle, size_t n, int ignore_case) {
+    const char* last = hay + len - n;      // last possible start
+
+    if (!ignore_case) {
+        const char* p = hay;
+        while (p <= last) {
+            p = memchr(p, needle[0], (size_t)(last - p) + 1);
+            if (!p) return NULL;
+            if (memcmp(p, needle, n) == 0) return p;
+            p++;
+        }
+        return NULL;
+    }
+
+    unsigned char first = fold((unsigned char)needle[0]);
+    for (const char* p = hay; p <= last; p++) {
+        if (fold((unsigned char)*p) == first && same_text(p, needle, n, 1)) {
+            return p;
+        }
+    }
+    return NULL;
+}
+
+
+#ifdef SEARCH_X86
+
+/*
+ * FUNCTION: find_sse2 / find_avx2
+ * ───────────────────────────────
+ * The 16- and 32-byte versions of the idea above. Each step
+ * loads the block at i (first characters) and the block at
+ * i + n - 1 (last characters), compares both, and turns the
+ * AND of the two into a bit mask: bit k set → check i + k.
+ * Whatever is left at the end goes to find_scalar.
+ */
+static const char* find_sse2(const char* hay, size_t len,
+                             const char* needle, size_t n, int ignore_case) {
+    const __m128i bit = _mm_set1_epi8(ignore_case ? 0x20 : 0);
+    const __m128i first = _mm_set1_epi8((char)(needle[0] | (ignore_case ? 0x20 : 0)));
+    const __m128i last = _mm_set1_epi8((char)(needle[n - 1] | (ignore_case ? 0x20 : 0)));
+
+    size_t i = 0;
+    for (; i + 16 + n - 1 <= len; i += 16) {
+        __m128i a = _mm_or_si128(_mm_loadu_si128((const __m128i*)(hay + i)), bit);
+        __m128i b = _mm_or_si128(_mm_loadu_si128((const __m128i*)(hay + i + n - 1)), bit);
+        unsigned mask = (unsigned)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+
+        while (mask) {
+            int k = __builtin_ctz(mask);
+            if (same_text(hay + i + k, needle, n, ignore_case)) {
+                return hay + i + k;
+            }
+            mask &= mask - 1;
+        }
+    }
+
+    return find_scalar(hay + i, len - i, needle, n, ignore_case);
+}
+
+__attribute__((target("avx2")))
+static const char* find_avx2(const char* hay, size_t len,
+                             const char* needle, size_t n, int ignore_case) {
+    const __m256i bit = _mm256_set1_epi8(ignore_case ? 0x20 : 0);
+    const __m256i first = _mm256_set1_epi8((char)(needle[0] | (ignore_case ? 0x20 : 0)));
+    const __m256i last = _mm256_set1_epi8((char)(needle[n - 1] | (ignore_case ? 0x20 : 0)));
+
+    size_t i = 0;
+    for (; i + 32 + n - 1 <= len; i += 32) {
+        __m256i a = _mm256_or_si256(_mm256_loadu_si256((const __m256i*)(hay + i)), bit);
+        __m256i b = _mm256_or_si256(_mm256_loadu_si256((const __m256i*)(hay + i + n - 1)), bit);
+        unsigned mask = (unsigned)_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last)));
+
+        while (mask) {
+            int k = __builtin_ctz(mask);
+            if (same_text(hay + i + k, needle, n, ignore_case)) {
+                return hay + i + k;
+            }
+            mask &= mask - 1;
+        }
+    }
+
+    return find_scalar(hay + i, len - i, needle, n, ignore_case);
+}
+
+#endif
+
+
+typedef const char* (*FindFn)(const char*, size_t, const char*, size_t, int);
+
+/* Picks the fastest version this CPU can run (once) */
+static FindFn pick_kernel(void) {
+    static FindFn chosen = NULL;
+    if (!chosen) {
+#ifdef SEARCH_X86
+        __builtin_cpu_init();
+        chosen = __builtin_cpu_supports("avx2") ? find_avx2 : find_sse2;
+#else
+        chosen = find_scalar;
+#endif
+    }
+    return chosen;
+}
+
+
+/*
+ * FUNCTION: find_text
+ * ───────────────────
+ * First occurrence of needle[0..n) in hay[0..len), optionally
+ * ignoring ASCII case. Like memmem().
+ *
+ * RETURNS: pointer to the match, or NULL
+ */
+const char* find_text(const char* hay, size_t len, const char* needle, size_t n, int ignore_case) {
+    if (n == 0) return hay;
+    if (n > len) return NULL;
+    return pick_kernel()(hay, len, needle, n, ignore_case);
+}
+
+
+/*
+ * FUNCTION: record_around
+ * ───────────────────────
+ * The commit record that contains `hit` (a pointer into the
+ * mapped commits.dat): step back to its "COMMIT:" line.
+ *
+ * RETURNS: 1 → rec filled in, 0 → hit is not inside a record
+ */
+static int record_around(const CommitStore* store, const char* hit, CommitRecord* rec) {
+    const char* data = store->file.data;
+    size_t size = store->file.size;
+    size_t start = (size_t)(hit - data);
+
+    while (start > 0 && !(data[start - 1] == '\n'
+                          && size - start >= 7 && memcmp(data + start, "COMMIT:", 7) == 0)) {
+        start--;
+    }
+    return store_record_at(store, start, rec) && hit < rec->data + rec->len;
+}
+
+
+/*
+ * FUNCTION: grep_scan_commits
+ * ───────────────────────────
+ * The no-index answer to "log --grep": one pass over the whole
+ * mapped commits.dat, where the TERMS take turns jumping ahead:
+ *
+ *   "fix parser":
+ *     find "fix"    → first in record #40
+ *     find "parser" from #40 → first in record #97
+ *     find "fix"    from #97 → in #97 too → check #97's message
+ *
+ * Each jump skips every record in between, so the pass is
+ * about as fast as finding the RAREST term — a common word
+ * like "fix" never makes us look at every commit. Candidate
+ * records are confirmed with grep_message (whole words).
+ *
+ * RETURNS: number of matches (*ids = sorted array, caller
+ *          frees), or -1 on error
+ */
+int grep_scan_commits(const GrepQuery* query, int** ids) {
+    *ids = NULL;
+
+    /* "inc-47*" is searched as the text "inc-47" */
+    size_t lens[MAX_GREP_TERMS];
+    for (int t = 0; t < query->count; t++) {
+        lens[t] = strlen(query->terms[t]);
+        if (query->terms[t][lens[t] - 1] == '*') lens[t]--;
+    }
+
+    CommitStore store;
+    store_open(&store);
+
+    const char* data = store.file.data;
+    size_t size = store.file.size;
+    size_t from = 0;                     // current record (or search start)
+    int t = 0;                           // terms 0..t-1 are in the record at `from`
+
+    int count = 0;
+    int capacity = 0;
+    int rc = 0;
+
+    while (from < size) {
+        const char* hit = find_text(data + from, size - from, query->terms[t], lens[t], 1);
+        if (!hit) break;
+
+        CommitRecord rec;
+        if (!record_around(&store, hit, &rec)) {
+            from = (size_t)(hit - data) + 1;
+            t = 0;
+            continue;
+        }
+
+        /* Found further on → that record is the new candidate,
+         * and the earlier terms must be found again in it */
+        if (rec.offset != from) {
+            from = rec.offset;
+            t = t == 0 ? 1 : 0;
+        } else {
+            t++;
+        }
+        if (t < query->count) {
+            continue;
+        }
+
+        /* Every term appears somewhere in this record */
+        from = rec.offset + rec.len;
+        t = 0;
+
+        TextView message;
+        if (!record_field(&rec, "MSG", &message) || !grep_message(message, query)) {
+            continue;
+        }
+
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            int* grown = realloc(*ids, capacity * sizeof(int));
+            if (!grown) {
+                rc = -1;
+                break;
+            }
+            *ids = grown;
+        }
+        (*ids)[count++] = (int)record_int_field(&rec, "COMMIT", 0);
+    }
+
+    store_close(&store);
+
+    if (rc != 0) {
+        free(*ids);
+        *ids = NULL;
+        return -1;
+    }
+    return count;
+}
+
+
+/* ─────────── mygit grep ─────────── */
+
+typedef struct GrepFiles {
+    const char* text;
+    size_t text_len;
+    int ignore_case;
+    int matches;
+} GrepFiles;
+
+
+/*
+ * FUNCTION: grep_blob
+ * ───────────────────
+ * Prints every line of one file that contains the text:
+ *
+ *   src/parser.c:42: if (parser_fails) {
+ *
+ * Line numbers are counted only up to each hit, with memchr.
+ */
+static void grep_blob(const char* path, unsigned long old_hash, unsigned long hash, void* ctx) {
+    GrepFiles* g = ctx;
+    (void)old_hash;
+
+    char blob_path[MAX_PATH];
+    snprintf(blob_path, sizeof(blob_path), "%s/%lu.blob", OBJECTS_DIR, hash);
+
+    MappedFile mf;
+    if (map_file(blob_path, &mf) != 0) {
+        printf(RED "✗ Missing blob for %s\n" RESET, path);
+        return;
+    }
+
+    const char* data = mf.data;
+    const char* end = data + mf.size;
+    const char* counted = data;        // line_no is correct up to here
+    int line_no = 1;
+
+    const char* hit;
+    const char* from = data;
+    while (from < end && (hit = find_text(from, (size_t)(end - from), g->text, g->text_len, g->ignore_case))) {
+        const char* line = hit;
+        while (line > data && line[-1] != '\n') line--;
+
+        const char* eol = memchr(hit, '\n', (size_t)(end - hit));
+        if (!eol) eol = end;
+
+        const char* nl;
+        while ((nl = memchr(counted, '\n', (size_t)(line - counted)))) {
+            line_no++;
+            counted = nl + 1;
+        }
+
+        size_t shown = (size_t)(eol - line);
+        if (shown > 0 && line[shown - 1] == '\r') shown--;
+
+        printf(CYAN "%s" RESET ":" YELLOW "%d" RESET ": %.*s\n", path, line_no, (int)shown, line);
+        g->matches++;
+
+        from = eol + 1;                // one report per line
+    }
+
+    unmap_file(&mf);
+}
+
+
+/*
+ * ═══════════════════════════════════════════════
+ * MAIN FUNCTION: mygit_grep
+ * ═══════════════════════════════════════════════
+ *
+ *   mygit grep TODO          → files of the current branch's tip
+ *   mygit grep -i todo dev   → ignoring case, branch "dev"
+ */
+int mygit_grep(const char* text, const char* branch, int ignore_case) {
+    char current[MAX_BRANCH_NAME];
+    if (!branch) {
+        branch = get_current_branch(current, sizeof(current));
+    }
+
+    int tip = get_last_commit_id_on_branch(branch);
+    if (tip <= 0) {
+        printf(YELLOW "No commits yet on '%s'.\n" RESET, branch);
+        return 0;
+    }
+
+    GrepFiles g = { text, strlen(text), ignore_case, 0 };
+    if (g.text_len == 0) {
+        printf(RED "✗ Nothing to search for\n" RESET);
+        return 1;
+    }
+
+    /* Every file of the snapshot = what changed since "nothing" */
+    if (tree_diff(0, commit_root_tree(tip), grep_blob, &g) != 0) {
+        printf(RED "✗ Could not read the tree of commit #%d\n" RESET, tip);
+        return 1;
+    }
+
+    if (g.matches == 0) {
+        printf(YELLOW "No matches.\n" RESET);
+    }
+    return 0;
+}
@@ -1,6 +1,291 @@
+/*
+ * ============================================
+ *          MYGIT - Status Command
+ *          "mygit status"
+ * ============================================
+ *
+ * PURPOSE:
+ *   "What would my next commit contain, and what did I change
+ *    since I last ran add?"
+ *
+ *   Every tracked file has up to THREE versions:
+ *
+ *     HEAD        the last commit on this branch
+ *     staged      what "mygit add" recorded in staging.dat
+ *     working     the file on disk right now
+ *
+ *   and status compares them pairwise:
+ *
+ *     HEAD ↔ staged     "Changes to be committed"
+ *     staged ↔ working  "Changes not staged for commit"
+ *                       (HEAD ↔ working if the file isn't staged)
+ *
+ * FORMATS (see output.c):
+ *   human      git-style sections, coloured on a terminal
+ *   porcelain  "XY path" — X = staged (A, M or ' '),
+ *              Y = working (M, D or ' ')
+ *   json       {"path":"a.txt","staged":"added","worktree":null}
+ *
+ *   Files nobody has added yet (untracked) are not listed.
+ */
+
 #include "mygit.h"
 
-int mygit_status(void) {
-    printf(YELLOW "📊 [Coming Week 2] Will show status\n" RESET);
+/* One tracked file: its hash in HEAD and in staging (0 = none) */
+typedef struct StatusEntry {
+    char* path;
+    unsigned long head_hash;
+    unsigned long staged_hash;
+    char staged;                     // 'A', 'M' or ' '
+    char worktree;                   // 'M', 'D' or ' '
+} StatusEntry;
+
+typedef struct StatusList {
+    StatusEntry* entries;
+    int count;
+    int capacity;
+    int failed;
+} StatusList;
+
+
+static StatusEntry* status_append(StatusList* list, const char* path) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 64;
+        StatusEntry* grown = realloc(list->entries, capacity * sizeof(StatusEntry));
+        if (!grown) {
+            list->failed = 1;
+            return NULL;
+        }
+        list->entries = grown;
+        list->capacity = capacity;
+    }
+
+    StatusEntry* e = &list->entries[list->count];
+    e->path = malloc(strlen(path) + 1);
+    if (!e->path) {
+        list->failed = 1;
+        return NULL;
+    }
+    strcpy(e->path, path);
+    e->head_hash = 0;
+    e->staged_hash = 0;
+    e->staged = ' ';
+    e->worktree = ' ';
+    list->count++;
+    return e;
+}
+
+/* tree_diff(0, head) visits every file of the HEAD snapshot */
+static void collect_head_file(const char* path, unsigned long old_hash,
+                              unsigned long new_hash, void* ctx) {
+    (void)old_hash;
+    StatusEntry* e = status_append(ctx, path);
+    if (e) {
+        e->head_hash = new_hash;
+    }
+}
+
+static int compare_entries(const void* a, const void* b) {
+    return strcmp(((const StatusEntry*)a)->path, ((const StatusEntry*)b)->path);
+}
+
+
+/*
+ * FUNCTION: status_collect
+ * ────────────────────────
+ * Builds the list of tracked files, sorted by path, with both
+ * letters filled in.
+ *
+ * RETURNS: 0 → Success, -1 → out of memory
+ */
+static int status_collect(StatusList* list) {
+
+    /*
+     * STEP 1: Every file in HEAD
+     */
+    char branch[MAX_BRANCH_NAME];
+    get_current_branch(branch, sizeof(branch));
+    int head = get_last_commit_id_on_branch(branch);
+    if (head > 0) {
+        tree_diff(0, commit_root_tree(head), collect_head_file, list);
+    }
+    if (list->count > 0) {
+        qsort(list->entries, list->count, sizeof(StatusEntry), compare_entries);
+    }
+
+    /*
+     * STEP 2: Lay the staging area over it. HEAD is sorted, so
+     * a staged file is found by binary search; one that isn't
+     * there is new and goes at the end (sorted again below).
+     */
+    int head_count = list->count;
+    int staged_count;
+    StagedFile* staged = read_staged_files(&staged_count);
+
+    for (StagedFile* s = staged; s && !list->failed; s = s->next) {
+        StatusEntry key;
+        key.path = s->filename;
+        StatusEntry* e = head_count > 0
+                         ? bsearch(&key, list->entries, head_count, sizeof(StatusEntry), compare_entries)
+                         : NULL;               // no commit yet: entries may be NULL
+
+        if (!e) {
+            for (int i = head_count; i < list->count; i++) {
+                if (strcmp(list->entries[i].path, s->filename) == 0) {
+                    e = &list->entries[i];
+                    break;
+                }
+            }
+        }
+        if (!e && !(e = status_append(list, s->filename))) {
+            break;
+        }
+        e->staged_hash = s->hash;
+    }
+    free_staged_files(staged);
+
+    if (list->failed) {
+        return -1;
+    }
+    if (list->count == 0) {
+        return 0;
+    }
+    qsort(list->entries, list->count, sizeof(StatusEntry), compare_entries);
+
+    /*
+     * STEP 3: The letters. The working file is read and hashed
+     * exactly the way "mygit add" does it, so an unchanged file
+     * gives the very same hash.
+     */
+    for (int i = 0; i < list->count; i++) {
+        StatusEntry* e = &list->entries[i];
+
+        if (e->staged_hash != 0 && e->staged_hash != e->head_hash) {
+            e->staged = e->head_hash == 0 ? 'A' : 'M';
+        }
+
+        unsigned long expected = e->staged_hash ? e->staged_hash : e->head_hash;
+        MappedFile mf;
+        if (!file_exists(e->path) || map_file(e->path, &mf) != 0) {
+            e->worktree = 'D';
+            continue;
+        }
+        if (hash_bytes(mf.data, mf.size) != expected) {
+            e->worktree = 'M';
+        }
+        unmap_file(&mf);
+    }
+
     return 0;
-}
\ No newline at end of file
+}
+
+
+/* One section of the human output ("Changes to be committed") */
+static int print_section(const StatusList* list, int staged_side) {
+    int shown = 0;
+
+    for (int i = 0; i < list->count; i++) {
+        const StatusEntry* e = &list->entries[i];
+        char letter = staged_side ? e->staged : e->worktree;
+        if (letter == ' ') {
+            continue;
+        }
+
+        if (shown++ == 0) {
+            out_str(staged_side ? "Changes to be committed:\n"
+                                : "Changes not staged for commit:\n");
+        }
+        out_color(staged_side ? GREEN : RED);
+        out_str(letter == 'A' ? "        new file:   "
+                : letter == 'D' ? "        deleted:    "
+                : "        modified:   ");
+        out_str(e->path);
+        out_color(RESET);
+        out_char('\n');
+    }
+
+    if (shown > 0) {
+        out_char('\n');
+    }
+    return shown;
+}
+
+
+static void print_json_side(char letter) {
+    switch (letter) {
+        case 'A': out_str("\"added\"");    break;
+        case 'M': out_str("\"modified\""); break;
+        case 'D': out_str("\"deleted\"");  break;
+        default:  out_str("null");
+    }
+}
+
+
+/*
+ * ═══════════════════════════════════════════════
+ * MAIN FUNCTION: mygit_status
+ * ═══════════════════════════════════════════════
+ */
+int mygit_status(void) {
+
+    StatusList list = { NULL, 0, 0, 0 };
+    int rc = status_collect(&list);
+
+    if (rc != 0) {
+        printf(RED "✗ Out of memory reading the status\n" RESET);
+    } else if (out_format() == OUT_HUMAN) {
+        char branch[MAX_BRANCH_NAME];
+        get_current_branch(branch, sizeof(branch));
+        out_str("On branch ");
+        out_color(CYAN);
+        out_str(branch);
+        out_color(RESET);
+
+        int detached = get_detached_commit();
+        if (detached > 0) {
+            out_color(YELLOW);
+            out_str(" (viewing commit #");
+            out_int(detached);
+            out_str(" — add and commit are off)");
+            out_color(RESET);
+        }
+        out_str("\n\n");
+
+        int changes = print_section(&list, 1);
+        changes += print_section(&list, 0);
+        if (changes == 0) {
+            out_color(GREEN);
+            out_str("nothing to commit, working tree clean\n");
+            out_color(RESET);
+        }
+    } else {
+        for (int i = 0; i < list.count; i++) {
+            const StatusEntry* e = &list.entries[i];
+            if (e->staged == ' ' && e->worktree == ' ') {
+                continue;
+            }
+
+            if (out_format() == OUT_PORCELAIN) {
+                out_char(e->staged);
+                out_char(e->worktree);
+                out_char(' ');
+                out_str(e->path);
+            } else {
+                out_str("{\"path\":");
+                out_json_string(e->path, strlen(e->path));
+                out_json_key("staged");
+                print_json_side(e->staged);
+                out_json_key("worktree");
+                print_json_side(e->worktree);
+                out_char('}');
+            }
+            out_end_record();
+        }
+    }
+
+    for (int i = 0; i < list.count; i++) {
+        free(list.entries[i].path);
+    }
+    free(list.entries);
+    return rc == 0 ? 0 : 1;
+}
@@ -0,0 +1,566 @@
+/*
+ * ============================================
+ *          MYGIT - Commit Store Reader
+ *          Zero-copy access to commits.dat
+ * ============================================
+ *
+ * PURPOSE:
+ *   The old way to read commits.dat was:
+ *     fgets  → copy a line into a 1024-byte buffer
+ *     sscanf → copy again into variables
+ *   A line longer than the buffer got silently cut in two.
+ *
+ *   The new way: map the WHOLE file into memory once, then hand
+ *   out VIEWS — a pointer into the mapping plus a length.
+ *   Nothing is copied, and no line is ever too long.
+ *
+ * HOW RECORDS ARE FOUND:
+ *   A record runs from a "COMMIT:" line to its "END" line.
+ *   We jump between them with memchr / memmem, which the C
+ *   library implements with SIMD instructions — it scans 16 or
+ *   32 bytes per step instead of one character at a time.
+ *
+ * LAZY FIELDS:
+ *   A record knows only where it starts and ends. Asking for
+ *   "PARENT" searches just that record for "\nPARENT:" — fields
+ *   a caller never touches are never looked at.
+ */
+
+#define _GNU_SOURCE          // glibc only declares memmem() with this
+#include "mygit.h"
+
+
+/*
+ * FUNCTION: find_bytes
+ * ────────────────────
+ * memmem() — search for a byte string inside a block.
+ * glibc's version is vectorized; Windows doesn't have one, so
+ * there we let memchr find candidate first bytes.
+ */
+static const char* find_bytes(const char* hay, size_t hay_len,
+                              const char* needle, size_t needle_len) {
+#ifdef _WIN32
+    if (needle_len == 0) return hay;
+
+    const char* end = hay + hay_len;
+    while (hay_len >= needle_len) {
+        const char* hit = memchr(hay, needle[0], hay_len - needle_len + 1);
+        if (!hit) return NULL;
+        if (memcmp(hit, needle, needle_len) == 0) return hit;
+        hay = hit + 1;
+        hay_len = end - hay;
+    }
+    return NULL;
+#else
+    return memmem(hay, hay_len, needle, needle_len);
+#endif
+}
+
+
+/*
+ * FUNCTION: store_size
+ * ────────────────────
+ * Current size of commits.dat in bytes (0 if it doesn't exist).
+ * The binary caches (commit-graph, time index) remember it to
+ * tell whether they are still up to date.
+ */
+uint64_t store_size(void) {
+    struct stat st;
+    if (stat(COMMITS_FILE, &st) != 0) {
+        return 0;
+    }
+    return (uint64_t)st.st_size;
+}
+
+
+/*
+ * FUNCTION: store_open / store_close
+ * ──────────────────────────────────
+ * Maps commits.dat. A missing file is fine — it just has
+ * no records (same as a fresh repository).
+ */
+int store_open(CommitStore* store) {
+    if (map_file(COMMITS_FILE, &store->file) != 0) {
+        store->file.data = "";
+        store->file.size = 0;
+        store->file.is_mapped = 0;
+    }
+    return 0;
+}
+
+void store_close(CommitStore* store) {
+    unmap_file(&store->file);
+}
+
+
+/*
+ * FUNCTION: store_record_at
+ * ─────────────────────────
+ * Reads the record that starts exactly at `offset`.
+ * (The offset must point at a "COMMIT:" line.)
+ *
+ * RETURNS:
+ *   1 → rec filled in
+ *   0 → no complete record there (bad offset, or a record
+ *       that was cut off before its END line)
+ */
+int store_record_at(const CommitStore* store, size_t offset, CommitRecord* rec) {
+    const char* data = store->file.data;
+    size_t size = store->file.size;
+
+    if (offset >= size || size - offset < 7 || memcmp(data + offset, "COMMIT:", 7) != 0) {
+        return 0;
+    }
+
+    /* The record may not run into the next one */
+    const char* start = data + offset;
+    const char* limit = find_bytes(start + 1, size - offset - 1, "\nCOMMIT:", 8);
+    size_t span = limit ? (size_t)(limit + 1 - start) : size - offset;
+
+    /* Look for an "END" line: "\nEND" followed by a line ending */
+    const char* p = start;
+    size_t left = span;
+    while (left > 0) {
+        const char* end = find_bytes(p, left, "\nEND", 4);
+        if (!end) return 0;
+
+        const char* after = end + 4;
+        const char* stop = start + span;
+        if (after == stop || *after == '\n' || *after == '\r') {
+            if (after < stop && *after == '\r') after++;
+            if (after < stop && *after == '\n') after++;
+
+            rec->offset = offset;
+            rec->data = start;
+            rec->len = after - start;
+            return 1;
+        }
+
+        left -= (after - p);
+        p = after;
+    }
+
+    return 0;
+}
+
+
+/*
+ * FUNCTION: store_next
+ * ────────────────────
+ * Iterator over all complete records, oldest first.
+ *
+ *   size_t cursor = 0;
+ *   CommitRecord rec;
+ *   while (store_next(&store, &cursor, &rec)) { ... }
+ *
+ * RETURNS: 1 while records remain, 0 at the end
+ */
+int store_next(const CommitStore* store, size_t* cursor, CommitRecord* rec) {
+    const char* data = store->file.data;
+    size_t size = store->file.size;
+
+    while (*cursor < size) {
+        size_t pos = *cursor;
+
+        /* Not at a record start? Jump to the next "\nCOMMIT:" */
+        if (!(size - pos >= 7 && memcmp(data + pos, "COMMIT:", 7) == 0
+              && (pos == 0 || data[pos - 1] == '\n'))) {
+            const char* hit = find_bytes(data + pos, size - pos, "\nCOMMIT:", 8);
+            if (!hit) {
+                *cursor = size;
+                return 0;
+            }
+            pos = (hit + 1) - data;
+        }
+
+        if (store_record_at(store, pos, rec)) {
+            *cursor = pos + rec->len;
+            return 1;
+        }
+
+        *cursor = pos + 1;   /* damaged record — skip past it */
+    }
+
+    return 0;
+}
+
+
+/*
+ * FUNCTION: record_field
+ * ──────────────────────
+ * Returns the value of KEY as a view into the mapping:
+ *
+ *   record_field(&rec, "MSG")  →  "Added new feature" (no copy)
+ *
+ * RETURNS: 1 if the field exists (view filled), 0 if not
+ */
+int record_field(const CommitRecord* rec, const char* key, TextView* value) {
+    char needle[32];
+    size_t key_len = strlen(key);
+    if (key_len + 2 > sizeof(needle)) return 0;
+
+    /* "COMMIT" is the first line, every other key follows a '\n' */
+    const char* hit;
+    if (strcmp(key, "COMMIT") == 0) {
+        hit = rec->data;
+        key_len += 1;   /* "COMMIT:" */
+    } else {
+        needle[0] = '\n';
+        memcpy(needle + 1, key, key_len);
+        needle[key_len + 1] = ':';
+        key_len += 2;   /* "\nKEY:" */
+
+        hit = find_bytes(rec->data, rec->len, needle, key_len);
+        if (!hit) return 0;
+    }
+
+    const char* begin = hit + key_len;
+    const char* end = rec->data + rec->len;
+    const char* eol = memchr(begin, '\n', end - begin);
+    if (!eol) eol = end;
+    if (eol > begin && eol[-1] == '\r') eol--;
+
+    value->data = begin;
+    value->len = eol - begin;
+    return 1;
+}
+
+
+/*
+ * FUNCTION: record_int_field
+ * ──────────────────────────
+ * Convenience: parse a numeric field, e.g. PARENT or COMMIT.
+ * RETURNS: the number, or `fallback` if the field is missing
+ */
+long long record_int_field(const CommitRecord* rec, const char* key, long long fallback) {
+    TextView value;
+    if (!record_field(rec, key, &value)) {
+        return fallback;
+    }
+    return view_to_ll(value, fallback);
+}
+
+
+/*
+ * ─────────── COMMIT-BY-ID INDEX (.mygit/commits.idx) ───────────
+ *
+ * PROBLEM:
+ *   "Show me commit #48213" means scanning commits.dat from the
+ *   top until we meet COMMIT:48213.
+ *
+ * SOLUTION:
+ *   A side file with one fixed-size slot per commit:
+ *
+ *     slot[id - 1] = { byte offset of "COMMIT:<id>", id, check }
+ *
+ *   Lookup = one 16-byte read from the mapped index, however
+ *   long the history is. mygit_commit() appends a slot for
+ *   every commit.
+ *
+ * CAN WE TRUST IT?
+ *   Each slot carries a checksum of its own offset and id, and
+ *   the record it points at must really start with COMMIT:<id>.
+ *   The header remembers how big commits.dat was when the index
+ *   last caught up with it. A lookup that misses is only worth a
+ *   rebuild (a full scan) when that size is out of date — with
+ *   an up-to-date index a miss means "no such commit".
+ */
+
+#define INDEX_MAGIC   "MGIX"
+#define INDEX_VERSION 2
+
+typedef struct IndexHeader {
+    char     magic[4];
+    uint32_t version;
+    uint32_t slot_size;
+    uint32_t reserved;
+    uint64_t store_size;             // size of commits.dat it describes
+} IndexHeader;
+
+typedef struct IndexSlot {
+    uint64_t offset;                 // where "COMMIT:<id>" starts
+    int32_t  id;
+    uint32_t check;                  // slot_checksum(offset, id)
+} IndexSlot;
+
+
+/*
+ * Lookups read the index through one mapping, made on first
+ * use — walking a long history is then just array reads, not
+ * an fopen per commit. Writers drop it (index_forget).
+ */
+static MappedFile g_index;
+static int g_index_state;            // 0 = not mapped yet, 1 = mapped, -1 = unusable
+
+static void index_forget(void) {
+    if (g_index_state == 1) {
+        unmap_file(&g_index);
+    }
+    g_index_state = 0;
+}
+
+
+/*
+ * FUNCTION: slot_checksum
+ * ───────────────────────
+ * FNV-1a over the slot's bytes. Catches torn writes and
+ * slots that were never filled in (all zeros → wrong check).
+ */
+static uint32_t slot_checksum(uint64_t offset, int32_t id) {
+    uint32_t h = 2166136261u;
+    unsigned char bytes[12];
+    memcpy(bytes, &offset, 8);
+    memcpy(bytes + 8, &id, 4);
+
+    for (int i = 0; i < 12; i++) {
+        h ^= bytes[i];
+        h *= 16777619u;
+    }
+    return h ^ 0x5a5a5a5au;
+}
+
+
+/*
+ * FUNCTION: commit_index_rebuild
+ * ──────────────────────────────
+ * Scans commits.dat once and writes a complete index.
+ * Ids that never appeared get an all-zero (invalid) slot.
+ */
+int commit_index_rebuild(void) {
+    CommitStore store;
+    store_open(&store);
+
+    int capacity = 64;
+    int count = 0;
+    IndexSlot* slots = calloc(capacity, sizeof(IndexSlot));
+    if (!slots) {
+        store_close(&store);
+        return -1;
+    }
+
+    size_t cursor = 0;
+    CommitRecord rec;
+    while (store_next(&store, &cursor, &rec)) {
+        int id = (int)record_int_field(&rec, "COMMIT", 0);
+        if (id <= 0) continue;
+
+        if (id > capacity) {
+            int new_capacity = capacity;
+            while (new_capacity < id) new_capacity *= 2;
+
+            IndexSlot* grown = realloc(slots, new_capacity * sizeof(IndexSlot));
+            if (!grown) {
+                free(slots);
+                store_close(&store);
+                return -1;
+            }
+            memset(grown + capacity, 0, (new_capacity - capacity) * sizeof(IndexSlot));
+            slots = grown;
+            capacity = new_capacity;
+        }
+
+        slots[id - 1].offset = rec.offset;
+        slots[id - 1].id = id;
+        slots[id - 1].check = slot_checksum(rec.offset, id);
+        if (id > count) count = id;
+    }
+    uint64_t scanned = store.file.size;
+    store_close(&store);
+
+    AtomicFile af;
+    if (atomic_open(&af, INDEX_FILE) != 0) {
+        free(slots);
+        return -1;
+    }
+
+    IndexHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, INDEX_MAGIC, 4);
+    header.version = INDEX_VERSION;
+    header.slot_size = sizeof(IndexSlot);
+    header.store_size = scanned;
+
+    int ok = fwrite(&header, sizeof(header), 1, af.fp) == 1;
+    if (ok && count > 0) {
+        ok = fwrite(slots, sizeof(IndexSlot), count, af.fp) == (size_t)count;
+    }
+    free(slots);
+
+    if (!ok) {
+        atomic_abort(&af);
+        return -1;
+    }
+
+    index_forget();
+    return atomic_commit(&af);
+}
+
+
+/*
+ * FUNCTION: index_open
+ * ────────────────────
+ * Opens the index and checks its header.
+ * RETURNS: open FILE (caller closes), its header and the slot
+ *          count, or NULL
+ */
+static FILE* index_open(const char* mode, IndexHeader* header, long* slot_count) {
+    FILE* fp = fopen(INDEX_FILE, mode);
+    if (!fp) return NULL;
+
+    if (fread(header, sizeof(*header), 1, fp) != 1
+        || memcmp(header->magic, INDEX_MAGIC, 4) != 0
+        || header->version != INDEX_VERSION
+        || header->slot_size != sizeof(IndexSlot)
+        || fseek(fp, 0, SEEK_END) != 0) {
+        fclose(fp);
+        return NULL;
+    }
+
+    long bytes = ftell(fp) - (long)sizeof(IndexHeader);
+    if (bytes < 0 || bytes % (long)sizeof(IndexSlot) != 0) {
+        fclose(fp);
+        return NULL;
+    }
+
+    *slot_count = bytes / (long)sizeof(IndexSlot);
+    return fp;
+}
+
+
+/*
+ * FUNCTION: commit_index_append
+ * ─────────────────────────────
+ * Called by mygit_commit() right after COMMIT:<id> was written
+ * at byte `offset`. Normally just appends one slot; if the
+ * index is missing or out of step, rebuilds it instead.
+ *
+ * RETURNS: 0 → Success, -1 → Error
+ */
+int commit_index_append(int id, uint64_t offset) {
+    index_forget();
+
+    IndexHeader header;
+    long slot_count;
+    FILE* fp = index_open("r+b", &header, &slot_count);
+
+    if (!fp || slot_count != id - 1) {
+        if (fp) fclose(fp);
+        return commit_index_rebuild();
+    }
+
+    IndexSlot slot;
+    slot.offset = offset;
+    slot.id = id;
+    slot.check = slot_checksum(offset, id);
+
+    /* Slot first, then the header: a torn append leaves the old size behind */
+    header.store_size = store_size();
+    int ok = fseek(fp, 0, SEEK_END) == 0
+          && fwrite(&slot, sizeof(slot), 1, fp) == 1
+          && fseek(fp, 0, SEEK_SET) == 0
+          && fwrite(&header, sizeof(header), 1, fp) == 1;
+    if (fclose(fp) != 0 || !ok) {
+        return commit_index_rebuild();
+    }
+    return 0;
+}
+
+
+/*
+ * FUNCTION: index_map
+ * ───────────────────
+ * Maps the index and checks its header (once).
+ * RETURNS: the slots and their count, or NULL
+ */
+static const IndexSlot* index_map(long* slot_count) {
+    if (g_index_state == 0) {
+        g_index_state = -1;
+
+        if (map_file(INDEX_FILE, &g_index) == 0) {
+            const IndexHeader* header = (const IndexHeader*)g_index.data;
+
+            if (g_index.size >= sizeof(IndexHeader)
+                && memcmp(header->magic, INDEX_MAGIC, 4) == 0
+                && header->version == INDEX_VERSION
+                && header->slot_size == sizeof(IndexSlot)
+                && (g_index.size - sizeof(IndexHeader)) % sizeof(IndexSlot) == 0) {
+                g_index_state = 1;
+            } else {
+                unmap_file(&g_index);
+            }
+        }
+    }
+
+    if (g_index_state != 1) {
+        return NULL;
+    }
+    *slot_count = (long)((g_index.size - sizeof(IndexHeader)) / sizeof(IndexSlot));
+    return (const IndexSlot*)(g_index.data + sizeof(IndexHeader));
+}
+
+
+/*
+ * FUNCTION: index_is_current
+ * ──────────────────────────
+ * Does the index describe commits.dat as it is right now?
+ * RETURNS: 1 → yes, 0 → missing, damaged or behind
+ */
+static int index_is_current(void) {
+    long slot_count;
+    if (!index_map(&slot_count)) {
+        return 0;
+    }
+    const IndexHeader* header = (const IndexHeader*)g_index.data;
+    return header->store_size == store_size();
+}
+
+
+/*
+ * FUNCTION: index_lookup
+ * ──────────────────────
+ * Reads slot id-1 and checks it against the store.
+ * RETURNS: 1 → rec filled, 0 → slot missing or failed a check
+ */
+static int index_lookup(const CommitStore* store, int id, CommitRecord* rec) {
+    long slot_count;
+    const IndexSlot* slots = index_map(&slot_count);
+    if (!slots || id > slot_count) return 0;
+
+    IndexSlot slot;
+    memcpy(&slot, &slots[id - 1], sizeof(slot));
+
+    if (slot.id != id || slot.check != slot_checksum(slot.offset, slot.id)) {
+        return 0;
+    }
+
+    return store_record_at(store, (size_t)slot.offset, rec)
+        && record_int_field(rec, "COMMIT", 0) == id;
+}
+
+
+/*
+ * FUNCTION: store_find_commit
+ * ───────────────────────────
+ * Finds commit #id in O(1) through the index.
+ *
+ * On a miss, an index that is up to date with commits.dat has
+ * the final word: no such commit. Only a stale (or missing)
+ * index is rebuilt, once, and asked again.
+ *
+ * RETURNS: 1 → found (rec filled), 0 → no such commit
+ */
+int store_find_commit(const CommitStore* store, int id, CommitRecord* rec) {
+    if (id <= 0) {
+        return 0;
+    }
+
+    if (index_lookup(store, id, rec)) {
+        return 1;
+    }
+
+    if (index_is_current() || commit_index_rebuild() != 0) {
+        return 0;
+    }
+
+    return index_lookup(store, id, rec);
+}
@@ -0,0 +1,488 @@
+/*
+ * ============================================
+ *          MYGIT - Text Lines
+ *          shared by diff, log --stat
+ * ============================================
+ *
+ * PURPOSE:
+ *   Everything that compares files line by line starts the
+ *   same way: cut both files into lines, then ask "is line x
+ *   of one file the same as line y of the other?" — for Myers,
+ *   many times over for the same pair.
+ *
+ *   Done naively, that means looking at every byte for '\n',
+ *   and a memcmp for every question. Here both are done ONCE
+ *   per file, up front:
+ *
+ * STEP 1 — SPLIT (32 bytes at a time):
+ *   One vector compare tells which of 32 bytes are '\n'; the
+ *   answer comes back as a 32-bit mask, and each set bit is a
+ *   line end (same trick as search.c):
+ *
+ *     bytes:  "int x;\n}\n\nreturn"...
+ *     mask:    000000101100000...
+ *
+ *   AVX2 if the CPU has it, SSE2 on any other x86-64, memchr
+ *   elsewhere.
+ *
+ * STEP 2 — INTERN (every distinct line gets a number):
+ *   Each line is hashed once and looked up in a table. The
+ *   first time a text is seen it gets the next free id; after
+ *   that, the same text always gets the same id — in EVERY file
+ *   interned with the same LineInterner:
+ *
+ *     old file           new file
+ *     "{"       → 0      "{"       → 0
+ *     "x = 1;"  → 1      "x = 2;"  → 3
+ *     "}"       → 2      "}"       → 2
+ *
+ *   From then on "same line?" is one integer compare, and ids
+ *   are dense (0, 1, 2, ...), so they can index arrays.
+ *
+ * BINARY FILES:
+ *   Splitting a firmware image into "lines" is slow and says
+ *   nothing. text_is_binary spots one from its first few KB,
+ *   and text_mismatch helps describe its changes as byte ranges
+ *   instead (see diff.c).
+ */
+
+#include "mygit.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define TEXT_X86 1
+#include <immintrin.h>
+#endif
+
+
+/* ─────────── STEP 1: splitting ─────────── */
+
+/* The lines found so far, and where the current one started */
+typedef struct Splitter {
+    TextLine* lines;
+    long count;
+    long capacity;
+    const char* start;
+    int failed;
+} Splitter;
+
+/* A line ends just before `next` */
+static inline void split_push(Splitter* sp, const char* next) {
+    if (sp->count == sp->capacity) {
+        long capacity = sp->capacity * 2;
+        TextLine* grown = realloc(sp->lines, capacity * sizeof(TextLine));
+        if (!grown) {
+            sp->failed = 1;
+            return;
+        }
+        sp->lines = grown;
+        sp->capacity = capacity;
+    }
+
+    TextLine* line = &sp->lines[sp->count++];
+    line->data = sp->start;
+    line->len = (size_t)(next - sp->start);
+    line->id = -1;
+    sp->start = next;
+}
+
+static void split_scalar(Splitter* sp, const char* data, size_t size) {
+    const char* end = data + size;
+    const char* p = data;
+    while (!sp->failed && (p = memchr(p, '\n', end - p)) != NULL) {
+        split_push(sp, ++p);
+    }
+}
+
+#ifdef TEXT_X86
+
+static void split_sse2(Splitter* sp, const char* data, size_t size) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    size_t i = 0;
+
+    for (; i + 16 <= size && !sp->failed; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline));
+        while (mask) {
+            split_push(sp, data + i + __builtin_ctz(mask) + 1);
+            mask &= mask - 1;
+        }
+    }
+    split_scalar(sp, data + i, size - i);
+}
+
+__attribute__((target("avx2")))
+static void split_avx2(Splitter* sp, const char* data, size_t size) {
+    const __m256i newline = _mm256_set1_epi8('\n');
+    size_t i = 0;
+
+    for (; i + 32 <= size && !sp->failed; i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(data + i));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, newline));
+        while (mask) {
+            split_push(sp, data + i + __builtin_ctz(mask) + 1);
+            mask &= mask - 1;
+        }
+    }
+    split_scalar(sp, data + i, size - i);
+}
+
+#endif
+
+
+/*
+ * FUNCTION: text_split_lines
+ * ──────────────────────────
+ * Cuts data[0..size) into lines — views into the data, no
+ * copies. Each line keeps its '\n'; only the last one may lack
+ * it. Ids are -1 until the lines are interned.
+ *
+ * Safe to call from worker threads.
+ *
+ * RETURNS: number of lines (*lines is malloc'd), -1 if out of memory
+ */
+long text_split_lines(const char* data, size_t size, TextLine** lines) {
+    Splitter sp;
+    sp.capacity = (long)(size / 32) + 16;          // ~32 bytes per line, then grow
+    sp.lines = malloc(sp.capacity * sizeof(TextLine));
+    sp.count = 0;
+    sp.start = data;
+    sp.failed = sp.lines == NULL;
+
+    if (!sp.failed) {
+#ifdef TEXT_X86
+        if (__builtin_cpu_supports("avx2")) {
+            split_avx2(&sp, data, size);
+        } else {
+            split_sse2(&sp, data, size);
+        }
+#else
+        split_scalar(&sp, data, size);
+#endif
+    }
+
+    /* The last line, if the file doesn't end with '\n' */
+    if (!sp.failed && sp.start < data + size) {
+        split_push(&sp, data + size);
+    }
+
+    if (sp.failed) {
+        free(sp.lines);
+        return -1;
+    }
+    *lines = sp.lines;
+    return sp.count;
+}
+
+
+/* ─────────── STEP 2: interning ─────────── */
+
+#define INTERN_AHEAD 8               // lines hashed before they are looked up
+
+/* Everything a lookup needs is in the slot — one cache miss */
+struct InternSlot {
+    const char* data;                // the first line with this text
+    uint32_t len;
+    uint32_t hash;                   // low bits of the line's hash
+    int key;                         // id + 1, 0 → empty slot
+};
+
+/*
+ * A line's hash, 8 bytes at a time: each word is mixed in with
+ * a multiply, and a final shuffle spreads the bits so the low
+ * ones (the table index) depend on all of them.
+ */
+static uint64_t text_hash(const char* data, size_t len) {
+    uint64_t h = 0x9E3779B97F4A7C15ull ^ len;
+    size_t i = 0;
+
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        h = (h ^ word) * 0xFF51AFD7ED558CCDull;
+        h ^= h >> 32;
+    }
+    if (i < len) {
+        uint64_t word = 0;
+        memcpy(&word, data + i, len - i);
+        h = (h ^ word) * 0xFF51AFD7ED558CCDull;
+    }
+
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+
+void interner_init(LineInterner* in) {
+    in->slots = NULL;
+    in->mask = 0;
+    in->count = 0;
+}
+
+void interner_free(LineInterner* in) {
+    free(in->slots);
+    interner_init(in);
+}
+
+/* A table of at least `size` slots; every id is filed again */
+static int interner_resize(LineInterner* in, size_t size) {
+    size_t slots_size = 1024;
+    while (slots_size < size) slots_size *= 2;
+
+    struct InternSlot* slots = calloc(slots_size, sizeof(struct InternSlot));
+    if (!slots) {
+        return -1;
+    }
+
+    for (size_t i = 0; in->slots && i <= in->mask; i++) {
+        if (in->slots[i].key != 0) {
+            size_t j = in->slots[i].hash & (slots_size - 1);
+            while (slots[j].key != 0) j = (j + 1) & (slots_size - 1);
+            slots[j] = in->slots[i];
+        }
+    }
+
+    free(in->slots);
+    in->slots = slots;
+    in->mask = slots_size - 1;
+    return 0;
+}
+
+/*
+ * FUNCTION: interner_add
+ * ──────────────────────
+ * Gives every line its id. Lines already seen (in this file
+ * or an earlier one) get their old id; new texts get the next
+ * free one. The interner keeps pointers into the first file
+ * with each text, so the files must stay mapped while it is
+ * used.
+ *
+ * The table is kept at most half full, growing with the number
+ * of DIFFERENT lines — two versions of a big file mostly share
+ * their lines, so they hardly cost more than one.
+ *
+ * Each line lands on a random slot, so almost every lookup is
+ * a cache miss. The hashes are computed INTERN_AHEAD lines in
+ * advance and their slots prefetched, so several misses are in
+ * flight at once instead of one after the other.
+ *
+ * RETURNS: 0 → Success, -1 → out of memory
+ */
+int interner_add(LineInterner* in, TextLine* lines, long count) {
+    if (!in->slots && interner_resize(in, (size_t)count) != 0) {
+        return -1;
+    }
+
+    uint32_t ahead[INTERN_AHEAD];
+    for (long k = 0; k < count && k < INTERN_AHEAD; k++) {
+        ahead[k] = (uint32_t)text_hash(lines[k].data, lines[k].len);
+        __builtin_prefetch(&in->slots[ahead[k] & in->mask]);
+    }
+
+    for (long k = 0; k < count; k++) {
+        TextLine* line = &lines[k];
+        uint32_t hash = ahead[k % INTERN_AHEAD];
+        size_t i = hash & in->mask;
+
+        if (k + INTERN_AHEAD < count) {
+            const TextLine* next = &lines[k + INTERN_AHEAD];
+            uint32_t next_hash = (uint32_t)text_hash(next->data, next->len);
+            ahead[k % INTERN_AHEAD] = next_hash;
+            __builtin_prefetch(&in->slots[next_hash & in->mask]);
+        }
+
+        for (;;) {
+            struct InternSlot* slot = &in->slots[i];
+
+            if (slot->key == 0) {
+                int id = in->count++;
+                slot->data = line->data;
+                slot->len = (uint32_t)line->len;
+                slot->hash = hash;
+                slot->key = id + 1;
+                line->id = id;
+
+                if ((size_t)in->count * 2 > in->mask + 1
+                    && interner_resize(in, (in->mask + 1) * 2) != 0) {
+                    return -1;
+                }
+                break;
+            }
+
+            if (slot->hash == hash && slot->len == line->len
+                && memcmp(slot->data, line->data, line->len) == 0) {
+                line->id = slot->key - 1;
+                break;
+            }
+            i = (i + 1) & in->mask;
+        }
+    }
+    return 0;
+}
+
+
+/* ─────────── binary or text? ─────────── */
+
+#define TEXT_BINARY_SCAN  8000       // bytes looked at, like git
+#define TEXT_CONTROL_SHARE 64        // > 1 in 64 control bytes → binary
+
+/*
+ * Control bytes that text files do contain: \b, \t, \n, \v,
+ * \f, \r (8..13) and ESC (colour codes in logs).
+ */
+static int is_odd_control(unsigned char c) {
+    return c < 0x20 && !(c >= 8 && c <= 13) && c != 0x1B;
+}
+
+static int binary_scalar(const unsigned char* data, size_t size, size_t* odd) {
+    for (size_t i = 0; i < size; i++) {
+        if (data[i] == 0) {
+            return 1;
+        }
+        *odd += is_odd_control(data[i]);
+    }
+    return 0;
+}
+
+#ifdef TEXT_X86
+
+/*
+ * 16 bytes per step: "c <= 0x1F" is min(c, 0x1F) == c, and
+ * "8 <= c <= 13" is (c - 8) <= 5 — both unsigned, which is
+ * the only kind of byte compare SSE2 has.
+ */
+static int binary_sse2(const unsigned char* data, size_t size, size_t* odd) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i low_max = _mm_set1_epi8(0x1F);
+    const __m128i eight = _mm_set1_epi8(8);
+    const __m128i five = _mm_set1_epi8(5);
+    const __m128i esc = _mm_set1_epi8(0x1B);
+    size_t i = 0;
+
+    for (; i + 16 <= size; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(data + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, zero))) {
+            return 1;
+        }
+        __m128i low = _mm_cmpeq_epi8(_mm_min_epu8(x, low_max), x);
+        __m128i shifted = _mm_sub_epi8(x, eight);
+        __m128i space = _mm_cmpeq_epi8(_mm_min_epu8(shifted, five), shifted);
+        __m128i fine = _mm_or_si128(space, _mm_cmpeq_epi8(x, esc));
+        *odd += __builtin_popcount((unsigned)_mm_movemask_epi8(_mm_andnot_si128(fine, low)));
+    }
+    return binary_scalar(data + i, size - i, odd);
+}
+
+__attribute__((target("avx2")))
+static int binary_avx2(const unsigned char* data, size_t size, size_t* odd) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i low_max = _mm256_set1_epi8(0x1F);
+    const __m256i eight = _mm256_set1_epi8(8);
+    const __m256i five = _mm256_set1_epi8(5);
+    const __m256i esc = _mm256_set1_epi8(0x1B);
+    size_t i = 0;
+
+    for (; i + 32 <= size; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(data + i));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, zero))) {
+            return 1;
+        }
+        __m256i low = _mm256_cmpeq_epi8(_mm256_min_epu8(x, low_max), x);
+        __m256i shifted = _mm256_sub_epi8(x, eight);
+        __m256i space = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, five), shifted);
+        __m256i fine = _mm256_or_si256(space, _mm256_cmpeq_epi8(x, esc));
+        *odd += __builtin_popcount((unsigned)_mm256_movemask_epi8(_mm256_andnot_si256(fine, low)));
+    }
+    return binary_scalar(data + i, size - i, odd);
+}
+
+#endif
+
+
+/*
+ * FUNCTION: text_is_binary
+ * ────────────────────────
+ * Is this a binary file (firmware, an image, a model) rather
+ * than text? Only the first TEXT_BINARY_SCAN bytes are looked
+ * at, so the answer costs the same for any file size:
+ *
+ *   a '\0' byte                      → binary (text never has one)
+ *   many other control bytes         → binary
+ *   (more than 1 in TEXT_CONTROL_SHARE)
+ *
+ * RETURNS: 1 → binary, 0 → text
+ */
+int text_is_binary(const char* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    size_t scan = size < TEXT_BINARY_SCAN ? size : TEXT_BINARY_SCAN;
+    size_t odd = 0;
+    int has_nul;
+
+#ifdef TEXT_X86
+    if (__builtin_cpu_supports("avx2")) {
+        has_nul = binary_avx2(bytes, scan, &odd);
+    } else {
+        has_nul = binary_sse2(bytes, scan, &odd);
+    }
+#else
+    has_nul = binary_scalar(bytes, scan, &odd);
+#endif
+
+    return has_nul || odd * TEXT_CONTROL_SHARE > scan;
+}
+
+
+#ifdef TEXT_X86
+
+static size_t mismatch_sse2(const char* a, const char* b, size_t size) {
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+        unsigned differ = ~(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) & 0xFFFF;
+        if (differ) {
+            return i + __builtin_ctz(differ);
+        }
+    }
+    while (i < size && a[i] == b[i]) i++;
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t mismatch_avx2(const char* a, const char* b, size_t size) {
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+        unsigned differ = ~(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y));
+        if (differ) {
+            return i + __builtin_ctz(differ);
+        }
+    }
+    while (i < size && a[i] == b[i]) i++;
+    return i;
+}
+
+#endif
+
+/*
+ * FUNCTION: text_mismatch
+ * ───────────────────────
+ * The first position where a and b differ — what memcmp finds
+ * but doesn't tell — 32 bytes per compare.
+ *
+ * RETURNS: index of the first different byte, `size` if none
+ */
+size_t text_mismatch(const char* a, const char* b, size_t size) {
+#ifdef TEXT_X86
+    if (__builtin_cpu_supports("avx2")) {
+        return mismatch_avx2(a, b, size);
+    }
+    return mismatch_sse2(a, b, size);
+#else
+    size_t i = 0;
+    while (i < size && a[i] == b[i]) i++;
+    return i;
+#endif
+}
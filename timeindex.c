@@ -0,0 +1,306 @@
+/*
+ * ============================================
+ *          MYGIT - Time Index
+ *          .mygit/commit-times
+ * ============================================
+ *
+ * QUESTION WE WANT TO ANSWER FAST:
+ *   "Which commits were made between 02:00 and 04:00 yesterday?"
+ *   "What was on main at 03:00?"
+ *
+ * THE SLOW WAY:
+ *   Look at the time of every commit in history.
+ *
+ * THE INDEX:
+ *   Every commit's (time, id), SORTED BY TIME:
+ *
+ *     pos:   0      1      2      3      4      5
+ *     time:  09:00  09:05  10:12  10:12  11:40  13:02
+ *     id:    #1     #2     #3     #5     #4     #6
+ *                                 └──────┘
+ *                 (a wrong clock can put ids out of order)
+ *
+ *   A time range becomes a range of POSITIONS with two binary
+ *   searches — about 20 steps for a million commits. The ids
+ *   inside tell us exactly where on a branch to start and stop
+ *   walking (see log.c).
+ *
+ * FILE LAYOUT:
+ *   TimesHeader (magic "MGTI", count, commits.dat size)
+ *   TimeSlot × count, sorted by (time, id), each also holding
+ *   the largest id up to and including itself — so "--until"
+ *   alone (a range that starts at position 0) knows its largest
+ *   id without looking at every slot before it.
+ *
+ * Like the commit-graph it is only a CACHE, built from the
+ * graph's times. If it doesn't describe the current commits.dat
+ * it is rebuilt; a new commit usually just appends one slot
+ * (times normally only go up).
+ */
+
+#include "mygit.h"
+
+#define TIMES_MAGIC   "MGTI"
+#define TIMES_VERSION 2           // 2: prefix_max_id filled in
+
+typedef struct TimesHeader {
+    char     magic[4];               // "MGTI"
+    uint32_t version;                // TIMES_VERSION
+    uint32_t slot_size;              // sizeof(TimeSlot)
+    uint32_t count;                  // number of slots
+    uint64_t store_size;             // size of commits.dat when last synced
+} TimesHeader;
+
+typedef struct TimeSlot {
+    int64_t  time;                   // epoch seconds
+    int32_t  id;
+    uint32_t prefix_max_id;          // largest id in slots [0 .. this one]
+} TimeSlot;
+
+static MappedFile g_times;
+static const TimeSlot* g_slots;
+static int g_slot_count = -1;        // -1 → not mapped
+
+
+static void times_close(void) {
+    if (g_slot_count >= 0) {
+        unmap_file(&g_times);
+    }
+    g_slots = NULL;
+    g_slot_count = -1;
+}
+
+
+/*
+ * FUNCTION: times_map
+ * ───────────────────
+ * Maps the index if it matches commits.dat and the graph.
+ * RETURNS: 0 → mapped, -1 → missing or out of date
+ */
+static int times_map(void) {
+    if (map_file(TIMES_FILE, &g_times) != 0) {
+        return -1;
+    }
+
+    const TimesHeader* header = (const TimesHeader*)g_times.data;
+
+    if (g_times.size < sizeof(TimesHeader)
+        || memcmp(header->magic, TIMES_MAGIC, 4) != 0
+        || header->version != TIMES_VERSION
+        || header->slot_size != sizeof(TimeSlot)
+        || g_times.size != sizeof(TimesHeader) + (size_t)header->count * sizeof(TimeSlot)
+        || (int)header->count != graph_count()
+        || header->store_size != store_size()) {
+        unmap_file(&g_times);
+        return -1;
+    }
+
+    g_slots = (const TimeSlot*)(g_times.data + sizeof(TimesHeader));
+    g_slot_count = (int)header->count;
+    return 0;
+}
+
+
+static int compare_slots(const void* a, const void* b) {
+    const TimeSlot* x = a;
+    const TimeSlot* y = b;
+    if (x->time != y->time) return x->time < y->time ? -1 : 1;
+    return (x->id > y->id) - (x->id < y->id);
+}
+
+
+/*
+ * FUNCTION: time_index_rebuild
+ * ────────────────────────────
+ * Sorts the graph's commit times into a fresh index.
+ * RETURNS: 0 → Success, -1 → Error (e.g. no graph)
+ */
+int time_index_rebuild(void) {
+    int count = graph_count();
+    if (count < 0) {
+        return -1;
+    }
+
+    TimeSlot* slots = calloc(count > 0 ? count : 1, sizeof(TimeSlot));
+    if (!slots) {
+        return -1;
+    }
+
+    for (int id = 1; id <= count; id++) {
+        slots[id - 1].time = graph_entry(id)->time;
+        slots[id - 1].id = id;
+    }
+    qsort(slots, count, sizeof(TimeSlot), compare_slots);
+
+    uint32_t running_max = 0;
+    for (int pos = 0; pos < count; pos++) {
+        if ((uint32_t)slots[pos].id > running_max) running_max = (uint32_t)slots[pos].id;
+        slots[pos].prefix_max_id = running_max;
+    }
+
+    TimesHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TIMES_MAGIC, 4);
+    header.version = TIMES_VERSION;
+    header.slot_size = sizeof(TimeSlot);
+    header.count = (uint32_t)count;
+    header.store_size = store_size();
+
+    AtomicFile af;
+    if (atomic_open(&af, TIMES_FILE) != 0) {
+        free(slots);
+        return -1;
+    }
+
+    int ok = fwrite(&header, sizeof(header), 1, af.fp) == 1
+          && fwrite(slots, sizeof(TimeSlot), count, af.fp) == (size_t)count;
+    free(slots);
+
+    if (!ok) {
+        atomic_abort(&af);
+        return -1;
+    }
+
+    times_close();
+    return atomic_commit(&af);
+}
+
+
+/*
+ * FUNCTION: times_load
+ * ────────────────────
+ * Maps the index, (re)building it first when needed.
+ */
+static int times_load(void) {
+    if (g_slot_count >= 0 || times_map() == 0) {
+        return 0;
+    }
+    if (time_index_rebuild() != 0) {
+        return -1;
+    }
+    return times_map();
+}
+
+
+/*
+ * FUNCTION: time_index_append
+ * ───────────────────────────
+ * Called by mygit_commit() after the graph got commit #id.
+ *
+ * Normal case: the new time is the latest, so it belongs at the
+ * END — append one slot, refresh the header. A clock that went
+ * backwards (or an index that is out of step) → rebuild later,
+ * on first use.
+ *
+ * RETURNS: 0 → Success, -1 → Error
+ */
+int time_index_append(int id, time_t when) {
+    times_close();
+
+    FILE* fp = fopen(TIMES_FILE, "r+b");
+    if (!fp) {
+        return 0;                    // nothing to keep up to date yet
+    }
+
+    TimesHeader header;
+    TimeSlot last;
+    int ok = fread(&header, sizeof(header), 1, fp) == 1
+          && header.count == (uint32_t)(id - 1)
+          && fseek(fp, 0, SEEK_END) == 0
+          && ftell(fp) == (long)(sizeof(TimesHeader) + (size_t)header.count * sizeof(TimeSlot));
+
+    if (ok && header.count > 0) {
+        ok = fseek(fp, -(long)sizeof(TimeSlot), SEEK_END) == 0
+          && fread(&last, sizeof(last), 1, fp) == 1
+          && last.time <= (int64_t)when;
+    }
+
+    if (ok) {
+        TimeSlot slot;
+        memset(&slot, 0, sizeof(slot));
+        slot.time = (int64_t)when;
+        slot.id = id;
+        slot.prefix_max_id = (uint32_t)id;      // the newest id is the largest so far
+
+        header.count++;
+        header.store_size = store_size();
+        ok = fseek(fp, 0, SEEK_END) == 0
+          && fwrite(&slot, sizeof(slot), 1, fp) == 1
+          && fseek(fp, 0, SEEK_SET) == 0
+          && fwrite(&header, sizeof(header), 1, fp) == 1;
+    }
+
+    fclose(fp);
+
+    /* Out of order or out of step: the stale file is rebuilt on
+     * its next use, since its header no longer matches */
+    return ok ? 0 : -1;
+}
+
+
+/*
+ * FUNCTION: first_at_or_after
+ * ───────────────────────────
+ * Binary search: position of the first slot with time >= t
+ * (g_slot_count if there is none).
+ */
+static int first_at_or_after(int64_t t) {
+    int lo = 0;
+    int hi = g_slot_count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (g_slots[mid].time < t) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+
+/*
+ * FUNCTION: time_index_range
+ * ──────────────────────────
+ * Which commits were made in [since, until]? (0 = no bound)
+ *
+ * Sets *min_id / *max_id to the smallest and largest id among
+ * them. Since a parent always has a smaller id than its child,
+ * a walk down a branch can skip everything above *max_id and
+ * stop below *min_id.
+ *
+ * A range that starts at the first slot (no --since) is answered
+ * from prefix_max_id without a scan. Its *min_id is then just 1:
+ * still a correct bound, and ids handed out in time order mean
+ * the true smallest id is (almost) always 1 anyway.
+ *
+ * RETURNS: how many commits are in the range, -1 if the index
+ *          can't be used
+ */
+int time_index_range(time_t since, time_t until, int* min_id, int* max_id) {
+    if (times_load() != 0) {
+        return -1;
+    }
+
+    int from = since ? first_at_or_after((int64_t)since) : 0;
+    int to = until ? first_at_or_after((int64_t)until + 1) : g_slot_count;
+
+    *min_id = 0;
+    *max_id = 0;
+    if (from == 0) {
+        if (to > 0) {
+            *min_id = 1;
+            *max_id = (int)g_slots[to - 1].prefix_max_id;
+        }
+        return to;
+    }
+
+    /* From --since on: the slots scanned are exactly the ones in range */
+    for (int pos = from; pos < to; pos++) {
+        int id = g_slots[pos].id;
+        if (*min_id == 0 || id < *min_id) *min_id = id;
+        if (id > *max_id) *max_id = id;
+    }
+
+    return to > from ? to - from : 0;
+}
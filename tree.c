@@ -0,0 +1,652 @@
+/*
+ * ============================================
+ *          MYGIT - Tree Objects
+ *          One snapshot = one tree of trees
+ * ============================================
+ *
+ * PURPOSE:
+ *   A commit used to carry a fixed array of 10 filenames.
+ *   Now it carries ONE number: the id of its ROOT TREE.
+ *
+ *   A tree object describes ONE directory:
+ *
+ *     .mygit/objects/<id>.tree
+ *       blob 193485797 README.md
+ *       tree 874291053 src
+ *       blob 55512345 zzz.txt
+ *
+ *   "blob" lines point at file contents (<hash>.blob),
+ *   "tree" lines point at sub-directories (<id>.tree).
+ *   The tree's own id is the hash of that text.
+ *
+ * WHY THIS SHAPE?
+ *   → Same directory contents = same text = same id.
+ *     If src/ didn't change, the new commit's root simply
+ *     points at the OLD src tree — it is shared, not copied.
+ *   → Objects are content-addressed like blobs, so a tree
+ *     that already exists on disk is never written again.
+ *     Changing one file writes only the trees on its path.
+ *
+ * ENTRY ORDER (canonical):
+ *   Entries are sorted by name, where a directory's name is
+ *   compared as "name/". This is exactly the order strcmp()
+ *   gives full paths, so sorted path lists map straight onto
+ *   trees and the same directory always hashes the same.
+ */
+
+#include "mygit.h"
+
+/*
+ * FUNCTION: compare_tree_entries
+ * ──────────────────────────────
+ * Canonical order: compare names, treating a directory as
+ * if it had a trailing '/'.  ("a.txt" < "a/" < "a0")
+ */
+static int compare_tree_entries(const void* a, const void* b) {
+    const TreeEntry* x = a;
+    const TreeEntry* y = b;
+
+    const char* p = x->name;
+    const char* q = y->name;
+    while (*p && *p == *q) {
+        p++;
+        q++;
+    }
+
+    unsigned char cp = *p ? (unsigned char)*p : (x->is_tree ? '/' : 0);
+    unsigned char cq = *q ? (unsigned char)*q : (y->is_tree ? '/' : 0);
+    return (int)cp - (int)cq;
+}
+
+
+/*
+ * FUNCTION: tree_read
+ * ───────────────────
+ * Loads one tree object into a freshly malloc'd array.
+ *
+ * PARAMETERS:
+ *   id      → tree id (0 = the empty tree, no file needed)
+ *   entries → receives the array (caller frees)
+ *   count   → receives how many entries
+ *
+ * RETURNS:
+ *   0  → Success
+ *   -1 → Tree object missing or unreadable
+ */
+int tree_read(unsigned long id, TreeEntry** entries, int* count) {
+    *entries = NULL;
+    *count = 0;
+
+    if (id == 0) {
+        return 0;   /* empty tree */
+    }
+
+    char tree_path[MAX_PATH];
+    snprintf(tree_path, sizeof(tree_path), "%s/%lu.tree", OBJECTS_DIR, id);
+
+    MappedFile mf;
+    if (map_file(tree_path, &mf) != 0) {
+        return -1;
+    }
+
+    /* One entry per line — count newlines to size the array */
+    int lines = 1;
+    for (size_t i = 0; i < mf.size; i++) {
+        if (mf.data[i] == '\n') lines++;
+    }
+
+    TreeEntry* list = calloc(lines, sizeof(TreeEntry));
+    if (!list) {
+        unmap_file(&mf);
+        return -1;
+    }
+
+    LineCursor cursor;
+    TextView line;
+    int n = 0;
+
+    lines_init(&cursor, mf.data, mf.size);
+
+    while (n < lines && lines_next(&cursor, &line)) {
+
+        /* "blob <hash> <name>" or "tree <id> <name>" */
+        TextView kind, rest, hash_text, name;
+        if (!view_split(line, ' ', &kind, &rest)
+            || !view_split(rest, ' ', &hash_text, &name)
+            || !(view_equals(kind, "blob") || view_equals(kind, "tree"))
+            || !view_to_ul(hash_text, &list[n].hash)
+            || view_copy(name, list[n].name, MAX_FILENAME) != 0) {
+            continue;
+        }
+
+        list[n].is_tree = view_equals(kind, "tree");
+        n++;
+    }
+
+    unmap_file(&mf);
+    *entries = list;
+    *count = n;
+    return 0;
+}
+
+
+/*
+ * FUNCTION: tree_write
+ * ────────────────────
+ * Serializes entries into a tree object and saves it.
+ * The entries are put in canonical order first.
+ *
+ * Like save_blob, an object that already exists is left alone —
+ * an unchanged directory costs a hash (and a stat), never a write.
+ *
+ * RETURNS:
+ *   The tree id, or 0 on error (0 also means "empty tree"
+ *   when count is 0 — nothing is written for that case)
+ */
+unsigned long tree_write(TreeEntry* entries, int count) {
+    if (count == 0) {
+        return 0;
+    }
+
+    qsort(entries, count, sizeof(TreeEntry), compare_tree_entries);
+
+    /* Each line: "tree " + up to 20 digits + " " + name + "\n" */
+    size_t capacity = 1;
+    for (int i = 0; i < count; i++) {
+        capacity += strlen(entries[i].name) + 28;
+    }
+
+    char* text = malloc(capacity);
+    if (!text) return 0;
+
+    size_t len = 0;
+    for (int i = 0; i < count; i++) {
+        len += snprintf(text + len, capacity - len, "%s %lu %s\n",
+                        entries[i].is_tree ? "tree" : "blob",
+                        entries[i].hash, entries[i].name);
+    }
+
+    unsigned long id = hash_content(text);
+
+    char tree_path[MAX_PATH];
+    snprintf(tree_path, sizeof(tree_path), "%s/%lu.tree", OBJECTS_DIR, id);
+
+    /*
+     * "Already exists" means exactly `len` bytes on disk: a tree
+     * torn by a crash in an older mygit gets written again instead
+     * of being trusted forever. New trees are renamed into place
+     * only when complete and synced (write_file_atomic).
+     */
+    struct stat st;
+    int complete = stat(tree_path, &st) == 0 && (size_t)st.st_size == len;
+
+    if (!complete && write_file_atomic(tree_path, text, len) != 0) {
+        id = 0;
+    }
+
+    free(text);
+    return id;
+}
+
+
+
+
+/*
+ * ─────────── WORKING-FOLDER ROOT (staging.dat "#root" line) ───────────
+ *
+ * PROBLEM:
+ *   Checkout diffs "the snapshot in the working folder" against
+ *   the one it goes to — so it has to know which one that is.
+ *   After "mygit checkout 3" it is NOT the branch tip.
+ *
+ * STORED IN staging.dat as a comment line, so readers that skip
+ * '#' lines simply ignore it:
+ *
+ *   # MyGit Staging Area
+ *   #root 986183336227009579
+ *   src/util/io.c|5863879
+ *
+ *   Written by every commit (its new root) and every checkout
+ *   (the target's root). Older staging areas carry the same id
+ *   on a "#tree <count> <id> ." line; that is still understood.
+ *
+ * WHY NOT ONE LINE PER DIRECTORY (Git's "cache-tree")?
+ *   A commit starts from the parent's root tree, and rebuild_dir
+ *   below only opens the directories that have a staged file
+ *   under them — clean sub-trees keep their id without being
+ *   read. "Rebuild only the dirty directories" needs no cache.
+ */
+
+#define ROOT_TAG        "#root "
+#define OLD_ROOT_TAG    "#tree "     // "#tree <count> <id> ."
+
+
+/*
+ * FUNCTION: parse_root_line
+ * ─────────────────────────
+ * "#root <id>" or an older "#tree <count> <id> ." → the id.
+ * RETURNS: 1 if the line names the root tree
+ */
+static int parse_root_line(TextView line, unsigned long* tree) {
+    if (view_starts_with(line, ROOT_TAG)) {
+        line.data += strlen(ROOT_TAG);
+        line.len -= strlen(ROOT_TAG);
+        return view_to_ul(line, tree);
+    }
+
+    TextView count_text, rest, id_text, path;
+    if (!view_starts_with(line, OLD_ROOT_TAG)) return 0;
+    line.data += strlen(OLD_ROOT_TAG);
+    line.len -= strlen(OLD_ROOT_TAG);
+
+    return view_split(line, ' ', &count_text, &rest)
+        && view_split(rest, ' ', &id_text, &path)
+        && view_equals(path, ".")
+        && view_to_ul(id_text, tree);
+}
+
+
+/*
+ * FUNCTION: staging_root_text
+ * ───────────────────────────
+ * A fresh staging.dat — the header comment and the root line,
+ * no staged files — for the snapshot `tree` (0: nothing yet).
+ * Used by clear_staging_area after a commit and by checkout.
+ *
+ * RETURNS: bytes written into `buffer`
+ */
+size_t staging_root_text(unsigned long tree, char* buffer, size_t size) {
+    int used = tree != 0
+        ? snprintf(buffer, size, "# MyGit Staging Area\n%s%lu\n", ROOT_TAG, tree)
+        : snprintf(buffer, size, "# MyGit Staging Area\n");
+    return used > 0 && (size_t)used < size ? (size_t)used : 0;
+}
+
+
+/*
+ * FUNCTION: staging_root
+ * ──────────────────────
+ * The root tree that was last committed or checked out into
+ * the working folder.
+ *
+ * RETURNS: 1 and *tree set, or 0 if staging.dat has no root line
+ */
+int staging_root(unsigned long* tree) {
+    MappedFile mf;
+    if (map_file(STAGING_FILE, &mf) != 0) {
+        return 0;
+    }
+
+    LineCursor cursor;
+    TextView line;
+    int found = 0;
+    lines_init(&cursor, mf.data, mf.size);
+
+    while (!found && lines_next(&cursor, &line)) {
+        found = line.len > 0 && line.data[0] == '#' && parse_root_line(line, tree);
+    }
+
+    unmap_file(&mf);
+    return found;
+}
+
+
+/*
+ * FUNCTION: staging_reset
+ * ───────────────────────
+ * Starts the staging area over on top of `tree` (checkout):
+ * no staged files, just the root line.
+ *
+ * RETURNS: 0 → Success, -1 → Error
+ */
+int staging_reset(unsigned long tree) {
+    char text[128];
+    size_t len = staging_root_text(tree, text, sizeof(text));
+    if (len == 0) {
+        return -1;
+    }
+    return write_file_atomic(STAGING_FILE, text, len);
+}
+
+
+/*
+ * FUNCTION: rebuild_dir
+ * ─────────────────────
+ * Rebuilds ONE dirty directory and, recursively, its dirty
+ * sub-directories.
+ *
+ * PARAMETERS:
+ *   prefix     → "src/util/" ("" for the root), shared buffer
+ *   base       → this directory's tree in the parent commit
+ *   staged     → staged files sorted by path
+ *   lo .. hi   → the slice of staged files inside this directory
+ *
+ * HOW:
+ *   1. Load the base tree (we only ever read DIRTY directories)
+ *   2. Staged files directly here replace/add blob entries
+ *   3. Sub-directories with staged files below them are
+ *      rebuilt by recursion; all other entries are kept as-is,
+ *      so clean sub-trees are never opened, hashed or written
+ *   4. Write the new tree object
+ */
+static unsigned long rebuild_dir(char* prefix, size_t prefix_len, unsigned long base,
+                                 const StagedFile** staged, int lo, int hi, int* error) {
+    TreeEntry* entries;
+    int old_count;
+
+    if (tree_read(base, &entries, &old_count) != 0) {
+        *error = 1;
+        return 0;
+    }
+
+    /* Room for every old entry plus one new entry per staged file */
+    int capacity = old_count + (hi - lo);
+    TreeEntry* grown = realloc(entries, capacity * sizeof(TreeEntry));
+    if (!grown) {
+        free(entries);
+        *error = 1;
+        return 0;
+    }
+    entries = grown;
+
+    int n = old_count;
+    int i = lo;
+
+    while (i < hi && !*error) {
+        const char* name = staged[i]->filename + prefix_len;
+        const char* slash = strchr(name, '/');
+        size_t name_len = slash ? (size_t)(slash - name) : strlen(name);
+        int j = i + 1;
+
+        TreeEntry key;
+        if (name_len >= MAX_FILENAME) name_len = MAX_FILENAME - 1;
+        memcpy(key.name, name, name_len);
+        key.name[name_len] = '\0';
+        key.is_tree = slash != NULL;
+
+        /* Old entries are in canonical order → binary search */
+        TreeEntry* found = bsearch(&key, entries, old_count, sizeof(TreeEntry), compare_tree_entries);
+        unsigned long hash;
+
+        if (!slash) {
+            hash = staged[i]->hash;                          /* a file right here */
+        } else {
+            /* Every staged path starting with "name/" is in this sub-directory */
+            size_t dir_len = slash - name + 1;
+            while (j < hi && strncmp(staged[j]->filename + prefix_len, name, dir_len) == 0) {
+                j++;
+            }
+
+            if (prefix_len + dir_len >= MAX_PATH) {
+                *error = 1;
+                break;
+            }
+            memcpy(prefix + prefix_len, name, dir_len);
+            prefix[prefix_len + dir_len] = '\0';
+
+            hash = rebuild_dir(prefix, prefix_len + dir_len, found ? found->hash : 0,
+                               staged, i, j, error);
+            prefix[prefix_len] = '\0';
+        }
+
+        if (!found) {
+            found = &entries[n++];
+            *found = key;
+        }
+        found->hash = hash;
+        i = j;
+    }
+
+    unsigned long id = *error ? 0 : tree_write(entries, n);
+    if (n > 0 && id == 0) {
+        *error = 1;
+    }
+
+    free(entries);
+    return id;
+}
+
+
+static int compare_staged(const void* a, const void* b) {
+    return strcmp((*(const StagedFile* const*)a)->filename,
+                  (*(const StagedFile* const*)b)->filename);
+}
+
+
+/*
+ * FUNCTION: build_over
+ * ────────────────────
+ * Shared driver: sorts the staged list into an array (so each
+ * directory's files sit next to each other) and rebuilds from
+ * the root down.
+ */
+static int build_over(unsigned long base, const StagedFile* staged, unsigned long* out) {
+    int count = 0;
+    for (const StagedFile* s = staged; s; s = s->next) count++;
+
+    const StagedFile** sorted = malloc((count > 0 ? count : 1) * sizeof(StagedFile*));
+    if (!sorted) return -1;
+
+    int i = 0;
+    for (const StagedFile* s = staged; s; s = s->next) sorted[i++] = s;
+    qsort(sorted, count, sizeof(StagedFile*), compare_staged);
+
+    char prefix[MAX_PATH] = "";
+    int error = 0;
+
+    *out = count > 0 ? rebuild_dir(prefix, 0, base, sorted, 0, count, &error) : base;
+
+    free(sorted);
+    return error ? -1 : 0;
+}
+
+
+/*
+ * FUNCTION: legacy_commit_tree
+ * ────────────────────────────
+ * Commits written before tree objects existed list their files
+ * on FILES: / HASHES: lines instead of a TREE: line — and ONLY
+ * the files staged for that commit, not the whole project.
+ *
+ * So the real snapshot is "parent's snapshot + these files",
+ * the same fold a new commit does. This builds (and saves)
+ * that tree so newer commits can inherit from it like from
+ * any other commit. graph_rebuild() runs it once per old
+ * commit, oldest first, and remembers the result.
+ *
+ * PARAMETERS:
+ *   rec         → the old commit's record
+ *   parent_tree → the parent's (already folded) snapshot
+ *
+ * RETURNS: tree id (0 if nothing was ever committed)
+ */
+unsigned long legacy_commit_tree(const CommitRecord* rec, unsigned long parent_tree) {
+    TextView files = { "", 0 };
+    TextView hashes = { "", 0 };
+
+    record_field(rec, "FILES", &files);
+    record_field(rec, "HASHES", &hashes);
+
+    /* Walk both comma lists side by side, building a staged list */
+    StagedFile* head = NULL;
+    TextView name, hash_text;
+
+    while (view_next_item(&files, ',', &name) && view_next_item(&hashes, ',', &hash_text)) {
+        StagedFile* node = malloc(sizeof(StagedFile));
+        if (!node) break;
+
+        if (view_copy(name, node->filename, MAX_FILENAME) != 0
+            || !view_to_ul(hash_text, &node->hash)) {
+            free(node);
+            continue;
+        }
+
+        node->next = head;
+        head = node;
+    }
+
+    unsigned long tree = parent_tree;
+    build_over(parent_tree, head, &tree);
+    free_staged_files(head);
+    return tree;
+}
+
+
+/*
+ * FUNCTION: tree_build_commit
+ * ───────────────────────────
+ * Computes the root tree for a new commit:
+ *
+ *   parent's snapshot  +  staged files  =  new snapshot
+ *
+ * Only directories on the path of a staged file are rebuilt
+ * (see rebuild_dir); every other directory keeps the id it has
+ * in the parent.
+ *
+ * PARAMETERS:
+ *   parent_tree → root tree of the parent (0 for first commit)
+ *   staged      → linked list of staged files
+ *   out         → receives the new root tree id
+ *
+ * RETURNS:
+ *   0 → Success, -1 → Error
+ */
+int tree_build_commit(unsigned long parent_tree, const StagedFile* staged, unsigned long* out) {
+    return build_over(parent_tree, staged, out);
+}
+
+
+/*
+ * ─────────── COMPARING TREES ───────────
+ */
+
+/*
+ * FUNCTION: diff_dirs
+ * ───────────────────
+ * Walks two versions of one directory side by side.
+ * Both entry lists are in canonical order, so this is a
+ * MERGE of two sorted lists (like merge sort's merge step):
+ *
+ *   same name, same id   → identical, skip (even whole sub-trees!)
+ *   same name, both dirs → recurse
+ *   only on one side     → added / deleted
+ */
+static int diff_dirs(unsigned long old_tree, unsigned long new_tree,
+                     char* path, size_t path_len, TreeDiffFn fn, void* ctx) {
+    if (old_tree == new_tree) {
+        return 0;
+    }
+
+    TreeEntry* a;
+    TreeEntry* b;
+    int a_count, b_count;
+
+    if (tree_read(old_tree, &a, &a_count) != 0) {
+        return -1;
+    }
+    if (tree_read(new_tree, &b, &b_count) != 0) {
+        free(a);
+        return -1;
+    }
+
+    int i = 0, j = 0;
+    int result = 0;
+
+    while ((i < a_count || j < b_count) && result == 0) {
+        int cmp;
+        if (i >= a_count)      cmp = 1;
+        else if (j >= b_count) cmp = -1;
+        else                   cmp = compare_tree_entries(&a[i], &b[j]);
+
+        /* Name the entry we're looking at: path + name */
+        const TreeEntry* e = cmp <= 0 ? &a[i] : &b[j];
+        size_t name_len = strlen(e->name);
+        if (path_len + name_len + 2 > MAX_PATH) {
+            result = -1;
+            break;
+        }
+        memcpy(path + path_len, e->name, name_len + 1);
+
+        unsigned long old_id = cmp <= 0 ? a[i].hash : 0;
+        unsigned long new_id = cmp >= 0 ? b[j].hash : 0;
+
+        if (old_id != new_id || cmp != 0) {
+            if (e->is_tree) {
+                path[path_len + name_len] = '/';
+                path[path_len + name_len + 1] = '\0';
+                result = diff_dirs(old_id, new_id, path, path_len + name_len + 1, fn, ctx);
+            } else {
+                fn(path, old_id, new_id, ctx);
+            }
+        }
+
+        path[path_len] = '\0';
+        if (cmp <= 0) i++;
+        if (cmp >= 0) j++;
+    }
+
+    free(a);
+    free(b);
+    return result;
+}
+
+
+/*
+ * FUNCTION: tree_diff
+ * ───────────────────
+ * Reports every FILE that differs between two trees:
+ *
+ *   fn(path, old_hash, new_hash, ctx)
+ *     old_hash == 0 → file was added
+ *     new_hash == 0 → file was deleted
+ *
+ * Sub-trees with the same id are skipped without reading
+ * them, so the cost depends on what changed, not repo size.
+ *
+ * RETURNS: 0 → Success, -1 → a tree object couldn't be read
+ */
+int tree_diff(unsigned long old_tree, unsigned long new_tree, TreeDiffFn fn, void* ctx) {
+    char path[MAX_PATH] = "";
+    return diff_dirs(old_tree, new_tree, path, 0, fn, ctx);
+}
+
+
+/*
+ * FUNCTION: tree_lookup_path
+ * ──────────────────────────
+ * Finds "src/util/io.c" inside a tree by following one
+ * directory level at a time.
+ *
+ * RETURNS:
+ *   the blob hash / tree id at that path, or 0 if it isn't there
+ */
+unsigned long tree_lookup_path(unsigned long tree, const char* path) {
+    while (tree != 0 && *path) {
+        const char* slash = strchr(path, '/');
+        size_t len = slash ? (size_t)(slash - path) : strlen(path);
+
+        TreeEntry* entries;
+        int count;
+        if (len == 0 || len >= MAX_FILENAME || tree_read(tree, &entries, &count) != 0) {
+            return 0;
+        }
+
+        unsigned long found = 0;
+        for (int i = 0; i < count; i++) {
+            if (strncmp(entries[i].name, path, len) == 0 && entries[i].name[len] == '\0'
+                && (slash == NULL || entries[i].is_tree)) {
+                found = entries[i].hash;
+                break;
+            }
+        }
+        free(entries);
+
+        if (!slash || slash[1] == '\0') {
+            return found;
+        }
+        tree = found;
+        path = slash + 1;
+    }
+
+    return 0;
+}
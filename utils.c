@@ -29,10 +29,23 @@
  *             We use djb2 (simple but effective for our scale)
  */
 unsigned long hash_content(const char* content) {
+    return hash_bytes(content, strlen(content));
+}
+
+/*
+ * HASH ANY BYTES — the same djb2, but over a length
+ * ─────────────────────────────────────────────────
+ * hash_content stops at the first '\0', so a binary file
+ * (firmware, images, ...) would be hashed — and stored — only up
+ * to its first zero byte. For text there is no difference: the
+ * same bytes give the same hash either way, so old blobs keep
+ * their names.
+ */
+unsigned long hash_bytes(const char* data, size_t len) {
     unsigned long hash = 5381;
-    int c;
 
-    while ((c = *content++)) {
+    for (size_t i = 0; i < len; i++) {
+        int c = data[i];                   // same sign as hash_content's
         hash = ((hash << 5) + hash) + c;   // hash * 33 + c
     }
 
@@ -92,50 +105,305 @@ int read_file(const char* path, char* buffer, int max_size) {
 }
 
 /*
- * WRITE STRING TO FILE
+ * FSYNC A FILE (OR, ON LINUX/MAC, A DIRECTORY) BY NAME
  * Returns: 0 on success, -1 on error
+ *
+ * A rename only survives a crash once the DIRECTORY holding
+ * the new name has been synced as well.
  */
-int write_file(const char* path, const char* content) {
-    FILE* fp = fopen(path, "w");
+int sync_path(const char* path) {
+#ifdef _WIN32
+    FILE* fp = fopen(path, "r+b");
     if (!fp) {
+        return directory_exists(path) ? 0 : -1;   // no directory fsync here
+    }
+    int rc = _commit(_fileno(fp));
+    fclose(fp);
+    return rc;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
         return -1;
     }
+    int rc = fsync(fd);
+    close(fd);
+    return rc;
+#endif
+}
 
-    fprintf(fp, "%s", content);
-    fclose(fp);
+/*
+ * FUNCTION: atomic_open / atomic_commit / atomic_abort
+ * ────────────────────────────────────────────────────
+ * Replaces a whole file so that readers only ever see the old
+ * version or the complete new one:
+ *
+ *   atomic_open    → write into "<path>.tmp.<pid>"
+ *   atomic_commit  → fsync it, rename it over <path>,
+ *                    fsync the directory
+ *   atomic_abort   → throw the tmp file away
+ *
+ * WHY ".tmp.<pid>"?
+ *   Two processes rebuilding the same cache must not share one
+ *   tmp file: the second "w" truncates it under the first one's
+ *   rename, and whoever mapped the result reads past its end
+ *   (SIGBUS). Each writer gets its own name; the last rename wins
+ *   and every version it can win with is complete.
+ *
+ * Returns: 0 on success, -1 on error (atomic_commit cleans up
+ *          after itself either way)
+ */
+int atomic_open(AtomicFile* af, const char* path) {
+#ifdef _WIN32
+    unsigned long pid = (unsigned long)GetCurrentProcessId();
+#else
+    unsigned long pid = (unsigned long)getpid();
+#endif
+    snprintf(af->path, sizeof(af->path), "%s", path);
+    snprintf(af->tmp_path, sizeof(af->tmp_path), "%s.tmp.%lu", path, pid);
+
+    af->fp = fopen(af->tmp_path, "wb");
+    return af->fp ? 0 : -1;
+}
+
+void atomic_abort(AtomicFile* af) {
+    if (af->fp) {
+        fclose(af->fp);
+        af->fp = NULL;
+    }
+    remove(af->tmp_path);
+}
+
+int atomic_commit(AtomicFile* af) {
+    FILE* fp = af->fp;
+    af->fp = NULL;
+
+    /* Step 1: the bytes must be on disk BEFORE the name points at them */
+    int ok = !ferror(fp) && fflush(fp) == 0;
+#ifdef _WIN32
+    ok = ok && _commit(_fileno(fp)) == 0;
+#else
+    ok = ok && fsync(fileno(fp)) == 0;
+#endif
+    if (fclose(fp) != 0) {
+        ok = 0;
+    }
+
+    /* Step 2: swap the name over */
+#ifdef _WIN32
+    ok = ok && MoveFileExA(af->tmp_path, af->path, MOVEFILE_REPLACE_EXISTING);
+#else
+    ok = ok && rename(af->tmp_path, af->path) == 0;
+#endif
+    if (!ok) {
+        remove(af->tmp_path);
+        return -1;
+    }
+
+    /* Step 3: make the rename itself durable */
+    char dir[MAX_PATH];
+    snprintf(dir, sizeof(dir), "%s", af->path);
+    char* slash = strrchr(dir, '/');
+    if (slash) {
+        *slash = '\0';
+    } else {
+        snprintf(dir, sizeof(dir), ".");
+    }
+    sync_path(dir);
 
     return 0;
 }
 
+/*
+ * WRITE A WHOLE BUFFER TO A FILE, ATOMICALLY (see atomic_open)
+ * Returns: 0 on success, -1 on error
+ */
+int write_file_atomic(const char* path, const void* data, size_t size) {
+    AtomicFile af;
+    if (atomic_open(&af, path) != 0) {
+        return -1;
+    }
+    if (size > 0 && fwrite(data, 1, size, af.fp) != size) {
+        atomic_abort(&af);
+        return -1;
+    }
+    return atomic_commit(&af);
+}
+
+/*
+ * WRITE STRING TO FILE
+ * Returns: 0 on success, -1 on error
+ *
+ * All or nothing: a crash leaves the old file or the new one,
+ * never a torn mix (see atomic_open).
+ */
+int write_file(const char* path, const char* content) {
+    return write_file_atomic(path, content, strlen(content));
+}
+
 /*
  * GET CURRENT TIMESTAMP
  * Format: "2025-01-15 14:30:45"
  */
 void get_timestamp(char* buffer, int size) {
-    time_t now = time(NULL);
-    struct tm* t = localtime(&now);
+    format_timestamp(time(NULL), buffer, size);
+}
+
+/*
+ * FORMAT A GIVEN TIME
+ * Same format as get_timestamp, for any epoch value
+ */
+void format_timestamp(time_t when, char* buffer, int size) {
+    struct tm* t = localtime(&when);
     strftime(buffer, size, "%Y-%m-%d %H:%M:%S", t);
 }
 
+/*
+ * PARSE TIMESTAMP
+ * Turns "2025-01-15 14:30:45" (local time, as written by
+ * get_timestamp) back into seconds since the epoch.
+ * Returns: epoch seconds, or 0 if the text is not a timestamp
+ */
+time_t parse_timestamp(TextView text) {
+    long long part[6];
+    const char separators[6] = { '-', '-', ' ', ':', ':', '\0' };
+
+    /* number, separator, number, separator ... read in place */
+    for (int i = 0; i < 6; i++) {
+        if (!view_take_number(&text, &part[i])
+            || (separators[i] && !view_take_char(&text, separators[i]))) {
+            return 0;
+        }
+    }
+
+    struct tm t;
+    memset(&t, 0, sizeof(t));
+    t.tm_year = (int)part[0];
+    t.tm_mon  = (int)part[1];
+    t.tm_mday = (int)part[2];
+    t.tm_hour = (int)part[3];
+    t.tm_min  = (int)part[4];
+    t.tm_sec  = (int)part[5];
+
+    t.tm_year -= 1900;   // struct tm counts years from 1900
+    t.tm_mon  -= 1;      // ... and months from 0
+    t.tm_isdst = -1;     // let mktime figure out daylight saving
+
+    time_t result = mktime(&t);
+    return result == (time_t)-1 ? 0 : result;
+}
+
+/*
+ * LOCAL TIMEZONE OFFSET
+ * Minutes east of UTC at the given moment (+120 for CEST),
+ * daylight saving included.
+ */
+int local_tz_offset(time_t when) {
+    struct tm local = *localtime(&when);
+    struct tm utc = *gmtime(&when);
+
+    /* Read the UTC clock as if it were local time: the difference
+     * between the two mktime()s is exactly the offset */
+    utc.tm_isdst = local.tm_isdst;
+    return (int)(difftime(mktime(&local), mktime(&utc)) / 60);
+}
+
+/*
+ * FORMAT A TIME IN ITS OWN TIMEZONE
+ * "2025-01-15 14:30:45 +0100" — the clock the committer saw,
+ * not the one of whoever is reading the log.
+ */
+void format_timestamp_tz(time_t when, int tz_minutes, char* buffer, int size) {
+    time_t shifted = when + (time_t)tz_minutes * 60;
+    struct tm* t = gmtime(&shifted);
+
+    int offset = tz_minutes < 0 ? -tz_minutes : tz_minutes;
+    char text[32];
+    strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", t);
+    snprintf(buffer, size, "%s %c%02d%02d", text, tz_minutes < 0 ? '-' : '+',
+             offset / 60, offset % 60);
+}
+
+/*
+ * PARSE A COMMIT'S TIME: LINE
+ * New commits store "1736947845 +0100" — epoch seconds (compare
+ * them as plain numbers, no calendar maths) and the committer's
+ * UTC offset in hours and minutes, for display.
+ * Older commits have "2025-01-15 14:30:45" in local time.
+ * Returns: epoch seconds (0 if unreadable); *tz_minutes is set
+ * unless it is NULL
+ */
+time_t parse_commit_time(TextView text, int* tz_minutes) {
+    TextView rest = text;
+    long long seconds;
+    TextView sign_view;
+
+    if (view_take_number(&rest, &seconds) && view_take_char(&rest, ' ')
+        && rest.len == 5 && (rest.data[0] == '+' || rest.data[0] == '-')) {
+        sign_view.data = rest.data + 1;
+        sign_view.len = 4;
+
+        unsigned long hhmm;
+        if (view_to_ul(sign_view, &hhmm)) {
+            int minutes = (int)(hhmm / 100) * 60 + (int)(hhmm % 100);
+            if (tz_minutes) *tz_minutes = rest.data[0] == '-' ? -minutes : minutes;
+            return (time_t)seconds;
+        }
+    }
+
+    time_t when = parse_timestamp(text);
+    if (tz_minutes) *tz_minutes = when ? local_tz_offset(when) : 0;
+    return when;
+}
+
+/*
+ * PARSE A DATE FROM THE COMMAND LINE
+ * "2025-01-15 14:30:45", "2025-01-15 14:30", or just
+ * "2025-01-15" — which means the start of that day, or its last
+ * second when end_of_day is set ("--until 2025-01-15" should
+ * include the whole 15th).
+ * Returns: epoch seconds, or 0 if the text is not a date
+ */
+time_t parse_date_arg(const char* text, int end_of_day) {
+    const char* endings[3] = { "", end_of_day ? ":59" : ":00",
+                               end_of_day ? " 23:59:59" : " 00:00:00" };
+
+    for (int i = 0; i < 3; i++) {
+        char full[64];
+        snprintf(full, sizeof(full), "%s%s", text, endings[i]);
+
+        time_t when = parse_timestamp(view_from(full));
+        if (when != 0) {
+            return when;
+        }
+    }
+    return 0;
+}
+
 /*
  * GET NEXT COMMIT ID
- * Reads commits file and returns max_id + 1
+ * Commit IDs are dense (1, 2, 3 ...), so when the commit-graph
+ * is loaded the answer is simply count + 1 — no parsing.
+ * Otherwise scans the commit store and returns max_id + 1
  */
 int get_next_commit_id(void) {
-    FILE* fp = fopen(COMMITS_FILE, "r");
-    if (!fp) return 1;  // first commit
+    int graph_commits = graph_count();
+    if (graph_commits >= 0) {
+        return graph_commits + 1;
+    }
+
+    CommitStore store;
+    store_open(&store);
 
     int max_id = 0;
-    int id;
-    char line[MAX_LINE];
+    size_t cursor = 0;
+    CommitRecord rec;
 
-    while (fgets(line, sizeof(line), fp)) {
-        if (sscanf(line, "COMMIT:%d", &id) == 1) {
-            if (id > max_id) max_id = id;
-        }
+    while (store_next(&store, &cursor, &rec)) {
+        int id = (int)record_int_field(&rec, "COMMIT", 0);
+        if (id > max_id) max_id = id;
     }
 
-    fclose(fp);
+    store_close(&store);
     return max_id + 1;
 }
 
@@ -144,19 +412,41 @@ int get_next_commit_id(void) {
  * Reads from HEAD file
  */
 char* get_current_branch(char* buffer, int size) {
-    if (read_file(HEAD_FILE, buffer, size) < 0) {
-        strcpy(buffer, "main");
-    }
+    MappedFile mf;
+    int ok = 0;
 
-    // Remove newline if present
-    int len = strlen(buffer);
-    if (len > 0 && buffer[len - 1] == '\n') {
-        buffer[len - 1] = '\0';
+    if (map_file(HEAD_FILE, &mf) == 0) {
+        // Just the branch name, without the newline
+        TextView content = { mf.data, mf.size };
+        TextView name = view_trim(content);
+        ok = name.len > 0 && view_copy(name, buffer, size) == 0;
+        unmap_file(&mf);
     }
 
+    if (!ok) {
+        snprintf(buffer, size, "main");
+    }
     return buffer;
 }
 
+/*
+ * GET DETACHED COMMIT
+ * "mygit checkout <commit-id>" leaves the id in DETACHED_FILE
+ * until a branch is checked out again.
+ * Returns that commit id, or 0 when we are on a branch.
+ */
+int get_detached_commit(void) {
+    MappedFile mf;
+    if (!file_exists(DETACHED_FILE) || map_file(DETACHED_FILE, &mf) != 0) {
+        return 0;
+    }
+
+    TextView content = { mf.data, mf.size };
+    int id = (int)view_to_ll(view_trim(content), 0);
+    unmap_file(&mf);
+    return id > 0 ? id : 0;
+}
+
 /*
  * PRINT COOL BANNER
  */
@@ -184,12 +474,103 @@ void print_help(void) {
     printf(GREEN "  init              " RESET "Initialize a new repository\n");
     printf(GREEN "  add <file>        " RESET "Stage a file for commit\n");
     printf(GREEN "  commit \"message\"  " RESET "Save a snapshot\n");
-    printf(GREEN "  log               " RESET "Show commit history\n");
+    printf(GREEN "  log [branch]      " RESET "Show commit history (-n, --since, --until, --grep, --stat, --graph, -- path)\n");
     printf(GREEN "  status            " RESET "Show working tree status\n");
-    printf(GREEN "  diff <file>       " RESET "Show changes in a file\n");
-    printf(GREEN "  checkout <id>     " RESET "Restore a previous commit\n");
+    printf(GREEN "  diff [file]       " RESET "Show unstaged changes (--cached: staged ones, <c1> <c2>: between commits,\n"
+           "                    --diff-algorithm=patience|histogram)\n");
+    printf(GREEN "  checkout <id>     " RESET "View a previous commit (read-only)\n");
     printf(GREEN "  branch <name>     " RESET "Create a new branch\n");
     printf(GREEN "  branch            " RESET "List all branches\n");
+    printf(GREEN "  grep <text>       " RESET "Find text in the files of a branch (-i)\n");
+    printf(GREEN "  index-messages    " RESET "Index commit messages for fast log --grep\n");
+    printf(GREEN "  pack-refs         " RESET "Fold branch files into packed-refs\n");
+    printf(GREEN "  reflog [branch]   " RESET "Show where a branch has pointed (-n N)\n");
+    printf(GREEN "  count-objects     " RESET "Count objects reachable from a branch\n");
     printf(GREEN "  help              " RESET "Show this help message\n");
     printf("\n");
-}
\ No newline at end of file
+    printf("  log, status, branch and diff also take " YELLOW "--format=porcelain|json" RESET
+           " and " YELLOW "-z" RESET " (NUL-ended records) for scripts.\n");
+    printf("\n");
+}
+
+/*
+ * MAP A WHOLE FILE INTO MEMORY (read-only)
+ * Returns: 0 on success, -1 on error
+ * 
+ * Linux/Mac: mmap → nothing is copied, pages load on demand
+ * Windows:   no mmap here, so we read it into the heap instead
+ */
+int map_file(const char* path, MappedFile* mf) {
+    mf->data = NULL;
+    mf->size = 0;
+    mf->is_mapped = 0;
+
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return -1;
+    }
+
+    // mmap refuses zero-length files — hand back an empty view
+    if (st.st_size == 0) {
+        mf->data = "";
+        return 0;
+    }
+
+#ifdef _WIN32
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        return -1;
+    }
+
+    char* copy = malloc(st.st_size);
+    if (!copy) {
+        fclose(fp);
+        return -1;
+    }
+
+    size_t got = fread(copy, 1, st.st_size, fp);
+    fclose(fp);
+
+    mf->data = copy;
+    mf->size = got;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    void* addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);   // the mapping stays valid after close
+
+    if (addr == MAP_FAILED) {
+        return -1;
+    }
+
+    mf->data = addr;
+    mf->size = st.st_size;
+    mf->is_mapped = 1;
+#endif
+
+    return 0;
+}
+
+/*
+ * RELEASE A MAPPED FILE
+ */
+void unmap_file(MappedFile* mf) {
+    if (mf->size > 0) {
+#ifdef _WIN32
+        free((void*)mf->data);
+#else
+        if (mf->is_mapped) {
+            munmap((void*)mf->data, mf->size);
+        } else {
+            free((void*)mf->data);
+        }
+#endif
+    }
+
+    mf->data = NULL;
+    mf->size = 0;
+    mf->is_mapped = 0;
+}
@@ -0,0 +1,647 @@
+/*
+ * ============================================
+ *          MYGIT - Write-Ahead Log
+ *          Crash-safe commits
+ * ============================================
+ *
+ * PURPOSE:
+ *   A commit changes THREE files:
+ *     commits.dat  → new record appended
+ *     refs/<name>  → branch moved to the new id
+ *     staging.dat  → emptied
+ *   If the power goes out between them, the repository is left
+ *   half-committed (a commit no branch points to, or a branch
+ *   pointing at a commit that was never written).
+ *
+ * THE IDEA (same as every database):
+ *   1. Describe ALL the changes in ONE record
+ *   2. Append that record to .mygit/wal and fsync it ONCE
+ *   3. Only then touch the real files
+ *
+ *   Crash before 2 finished → the record is torn, we ignore it,
+ *                             nothing happened
+ *   Crash after 2           → the next mygit run sees a record
+ *                             not yet marked APPLIED and redoes it
+ *
+ * RECORD LAYOUT:
+ *   ┌──────┬────────┬──────────┬───────┐┌─────────────┐
+ *   │ MGW2 │ length │ checksum │ state ││ ops ...     │
+ *   └──────┴────────┴──────────┴───────┘└─────────────┘
+ *   op = type, path, data:
+ *     'A' append  → add the data to the end of <path>
+ *                   (data = size of <path> before, bytes)
+ *     'R' replace → make <path> contain exactly the data
+ *     'C' ref     → move branch <path> from one id to another
+ *                   (data = old id, new id) — only if it still
+ *                   says the old one
+ *
+ * ONE COMMIT AT A TIME:
+ *   The WAL lock is held from append to apply, so a PENDING
+ *   record seen under that lock is always a crashed one —
+ *   recovery just waits for the lock and redoes it.
+ *
+ *   A commit runs recovery itself, holding the commits.dat
+ *   lock, BEFORE it picks its id: a crashed commit's record is
+ *   back in commits.dat first, so no new commit can be handed
+ *   the same id. And a redone ref move whose branch has moved
+ *   on since is dropped, not forced over the newer commit.
+ *
+ *   Sharing one fsync between committers ("group commit") would
+ *   buy nothing here: commits in one repository are serialized
+ *   anyway — they share the staging area, and take their ids
+ *   from commits.dat under its lock — so there is never a second
+ *   committer waiting to ride along. Each commit pays exactly
+ *   one fsync of the log.
+ *
+ * WINDOWS:
+ *   No flock() there, so the WAL lock is a no-op; the commits.dat
+ *   and ref lock files (refs.c) still keep writers apart.
+ */
+
+#include "mygit.h"
+#include <stddef.h>          // offsetof()
+
+#ifndef _WIN32
+    #include <sys/file.h>    // flock()
+#endif
+
+#define WAL_FILE       ".mygit/wal"
+#define WAL_MAGIC      "MGW2"
+#define WAL_MAGIC_V1   "MGWR"      // appends without the size before — still redone
+#define WAL_SIZE_UNKNOWN UINT64_MAX
+#define WAL_PENDING    0
+#define WAL_APPLIED    1
+#define WAL_CHECKPOINT_BYTES (64 * 1024)   // truncate the log past this size
+
+typedef struct WalHeader {
+    char     magic[4];
+    uint32_t length;                 // bytes of ops after the header
+    uint32_t checksum;               // FNV-1a of the ops
+    uint32_t state;                  // WAL_PENDING / WAL_APPLIED
+} WalHeader;
+
+
+/* ─────────── SMALL PLATFORM HELPERS ─────────── */
+
+/* Open for read+write, creating it if needed — never truncating */
+static FILE* open_rw(const char* path) {
+#ifdef _WIN32
+    FILE* fp = fopen(path, "r+b");
+    return fp ? fp : fopen(path, "w+b");
+#else
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return NULL;
+
+    FILE* fp = fdopen(fd, "r+b");
+    if (!fp) close(fd);
+    return fp;
+#endif
+}
+
+static void lock_file(FILE* fp) {
+#ifndef _WIN32
+    flock(fileno(fp), LOCK_EX);
+#else
+    (void)fp;
+#endif
+}
+
+static void unlock_file(FILE* fp) {
+    fflush(fp);
+#ifndef _WIN32
+    flock(fileno(fp), LOCK_UN);
+#endif
+}
+
+/* Push everything written so far down to the disk */
+static int sync_file(FILE* fp) {
+    if (fflush(fp) != 0) return -1;
+#ifdef _WIN32
+    return _commit(_fileno(fp));
+#else
+    return fsync(fileno(fp));
+#endif
+}
+
+static int truncate_file(FILE* fp, long size) {
+    fflush(fp);
+#ifdef _WIN32
+    return _chsize(_fileno(fp), size);
+#else
+    return ftruncate(fileno(fp), size);
+#endif
+}
+
+static long file_end(FILE* fp) {
+    if (fseek(fp, 0, SEEK_END) != 0) return -1;
+    return ftell(fp);
+}
+
+static uint32_t wal_checksum(const char* data, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)data[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+
+/* ─────────── BUILDING A TRANSACTION ─────────── */
+
+void wal_txn_init(WalTxn* txn) {
+    txn->data = NULL;
+    txn->len = 0;
+    txn->cap = 0;
+    txn->append_offset = -1;
+}
+
+void wal_txn_free(WalTxn* txn) {
+    free(txn->data);
+    wal_txn_init(txn);
+}
+
+static int txn_put(WalTxn* txn, const void* bytes, size_t len) {
+    if (len == 0) return 0;
+    if (txn->len + len > txn->cap) {
+        size_t cap = txn->cap ? txn->cap * 2 : 1024;
+        while (cap < txn->len + len) cap *= 2;
+
+        char* grown = realloc(txn->data, cap);
+        if (!grown) return -1;
+        txn->data = grown;
+        txn->cap = cap;
+    }
+    memcpy(txn->data + txn->len, bytes, len);
+    txn->len += len;
+    return 0;
+}
+
+/* One op: type, path length, path, data length, data (= head + body) */
+static int txn_add(WalTxn* txn, char type, const char* path,
+                   const void* head, size_t head_len, const char* data, size_t len) {
+    size_t path_len = strlen(path);
+    if (path_len >= MAX_PATH) return -1;
+
+    uint16_t plen = (uint16_t)path_len;
+    uint32_t dlen = (uint32_t)(head_len + len);
+
+    if (txn_put(txn, &type, 1) != 0
+        || txn_put(txn, &plen, sizeof(plen)) != 0
+        || txn_put(txn, path, path_len) != 0
+        || txn_put(txn, &dlen, sizeof(dlen)) != 0
+        || txn_put(txn, head, head_len) != 0
+        || txn_put(txn, data, len) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static int next_op(const char* ops, size_t len, size_t* pos,
+                   char* type, char* path, const char** data, size_t* data_len);
+
+/*
+ * FUNCTION: wal_txn_append
+ * ────────────────────────
+ * "Append these bytes to <path>" — and remember how big <path>
+ * is right now, so a redo can cut a half-done append off first.
+ *
+ * The size is exact: the caller holds the lock that keeps other
+ * writers off <path> (commits.dat's, or the ref's for a reflog)
+ * until wal_commit is done, and recovery has already run.
+ * An earlier append to the same file in this transaction counts.
+ */
+int wal_txn_append(WalTxn* txn, const char* path, const char* data, size_t len) {
+    struct stat st;
+    uint64_t before = stat(path, &st) == 0 ? (uint64_t)st.st_size : 0;
+
+    size_t pos = 0;
+    char type;
+    char other[MAX_PATH];
+    const char* body;
+    size_t body_len;
+    while (next_op(txn->data, txn->len, &pos, &type, other, &body, &body_len) == 1) {
+        if (type == 'A' && strcmp(other, path) == 0) {
+            before += body_len - sizeof(uint64_t);
+        }
+    }
+
+    return txn_add(txn, 'A', path, &before, sizeof(before), data, len);
+}
+
+/* "Make <path> contain exactly these bytes" */
+int wal_txn_replace(WalTxn* txn, const char* path, const char* data, size_t len) {
+    return txn_add(txn, 'R', path, NULL, 0, data, len);
+}
+
+/* "Move branch <name> from old_id to new_id" (0 = no such branch yet) */
+int wal_txn_ref(WalTxn* txn, const char* name, int old_id, int new_id) {
+    int32_t ids[2] = { old_id, new_id };
+    return txn_add(txn, 'C', name, ids, sizeof(ids), NULL, 0);
+}
+
+
+/*
+ * FUNCTION: next_op
+ * ─────────────────
+ * Decodes the op at *pos inside a record's payload.
+ * RETURNS: 1 → got one, 0 → end of payload, -1 → malformed
+ */
+static int next_op(const char* ops, size_t len, size_t* pos,
+                   char* type, char* path, const char** data, size_t* data_len) {
+    if (*pos == len) return 0;
+
+    uint16_t plen;
+    uint32_t dlen;
+    size_t p = *pos;
+
+    if (len - p < 1 + sizeof(plen)) return -1;
+    *type = ops[p];
+    memcpy(&plen, ops + p + 1, sizeof(plen));
+    p += 1 + sizeof(plen);
+
+    if (plen >= MAX_PATH || len - p < plen + sizeof(dlen)) return -1;
+    memcpy(path, ops + p, plen);
+    path[plen] = '\0';
+    p += plen;
+
+    memcpy(&dlen, ops + p, sizeof(dlen));
+    p += sizeof(dlen);
+    if (len - p < dlen) return -1;
+
+    *data = ops + p;
+    *data_len = dlen;
+    *pos = p + dlen;
+    return 1;
+}
+
+
+/* ─────────── APPLYING A RECORD ─────────── */
+
+/* Does <path> already end with these bytes? (redo of an old-format record) */
+static int file_ends_with(const char* path, const char* data, size_t len) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return 0;
+
+    int match = 0;
+    if (fseek(fp, 0, SEEK_END) == 0 && ftell(fp) >= (long)len
+        && fseek(fp, -(long)len, SEEK_END) == 0) {
+        char* tail = malloc(len ? len : 1);
+        match = tail && fread(tail, 1, len, fp) == len && memcmp(tail, data, len) == 0;
+        free(tail);
+    }
+    fclose(fp);
+    return match;
+}
+
+/*
+ * FUNCTION: apply_append
+ * ──────────────────────
+ * `before` is the size <path> had when the op was logged.
+ *
+ * A crash can land in the middle of the append, or after it but
+ * before the record was marked applied. So a redo first cuts
+ * <path> back to `before` — dropping a torn or complete earlier
+ * try alike — and appends again. Nothing else can have been
+ * appended since: see wal_txn_append.
+ */
+static int apply_append(const char* path, uint64_t before, const char* data, size_t len,
+                        int redo, long* offset) {
+    if (redo && before == WAL_SIZE_UNKNOWN && file_ends_with(path, data, len)) {
+        return 0;
+    }
+
+    FILE* fp = open_rw(path);
+    if (!fp) return -1;
+
+    long at = file_end(fp);
+    if (redo && before != WAL_SIZE_UNKNOWN && at > (long)before) {
+        if (truncate_file(fp, (long)before) != 0) {
+            fclose(fp);
+            return -1;
+        }
+        at = file_end(fp);
+    }
+
+    int ok = at >= 0 && fwrite(data, 1, len, fp) == len;
+
+    if (fclose(fp) != 0 || !ok) return -1;
+    if (offset && *offset < 0) *offset = at;     // the FIRST append is the caller's
+    return 0;
+}
+
+/* An 'A' op's data: the size before, then the bytes (old records: just the bytes) */
+static int apply_append_op(const char* path, const char* data, size_t len,
+                           int legacy, int redo, long* offset) {
+    if (legacy) {
+        return apply_append(path, WAL_SIZE_UNKNOWN, data, len, redo, offset);
+    }
+
+    uint64_t before;
+    if (len < sizeof(before)) return -1;
+
+    memcpy(&before, data, sizeof(before));
+    return apply_append(path, before, data + sizeof(before), len - sizeof(before), redo, offset);
+}
+
+static int apply_replace(const char* path, const char* data, size_t len) {
+    return write_file_atomic(path, data, len);
+}
+
+static int apply_ref(const char* name, const char* data, size_t len, int check_only) {
+    int32_t ids[2];
+    if (len != sizeof(ids)) return -1;
+
+    memcpy(ids, data, sizeof(ids));
+    return ref_apply_logged(name, ids[0], ids[1], check_only);
+}
+
+/*
+ * FUNCTION: apply_ops
+ * ───────────────────
+ * Carries out every op of one record, in order.
+ * `offset` receives where the first append landed.
+ * `legacy` → a record from before appends logged their size.
+ *
+ * The ref moves are checked FIRST: if any branch no longer says
+ * what the record expects, nothing at all is applied.
+ *
+ * RETURNS: 0, REF_TXN_CONFLICT → a branch moved on, -1 → error
+ */
+static int apply_ops(const char* ops, size_t len, int legacy, int redo, long* offset) {
+    size_t pos = 0;
+    char type;
+    char path[MAX_PATH];
+    const char* data;
+    size_t data_len;
+    int rc;
+
+    /* Pass 1: do all the branches still say what we expect? */
+    while ((rc = next_op(ops, len, &pos, &type, path, &data, &data_len)) == 1) {
+        if (type == 'C') {
+            int check = apply_ref(path, data, data_len, 1);
+            if (check != 0) return check;
+        }
+    }
+    if (rc != 0) return rc;
+
+    /* Pass 2: apply */
+    pos = 0;
+    while ((rc = next_op(ops, len, &pos, &type, path, &data, &data_len)) == 1) {
+        int failed;
+        switch (type) {
+            case 'A': failed = apply_append_op(path, data, data_len, legacy, redo, offset); break;
+            case 'R': failed = apply_replace(path, data, data_len);                        break;
+            case 'C': failed = apply_ref(path, data, data_len, 0);                         break;
+            default:  failed = -1;                                                         break;
+        }
+        if (failed) return -1;
+    }
+    return rc;
+}
+
+
+/* ─────────── READING THE LOG ─────────── */
+
+/*
+ * FUNCTION: read_record
+ * ─────────────────────
+ * Reads the record at `offset`. `ops` is malloc'd (caller frees).
+ * RETURNS: 0 → ok, -1 → end of log or a torn/corrupt record
+ */
+static int read_record(FILE* fp, long offset, long end, WalHeader* header, char** ops) {
+    *ops = NULL;
+
+    if (end - offset < (long)sizeof(WalHeader)
+        || fseek(fp, offset, SEEK_SET) != 0
+        || fread(header, sizeof(WalHeader), 1, fp) != 1
+        || (memcmp(header->magic, WAL_MAGIC, 4) != 0 && memcmp(header->magic, WAL_MAGIC_V1, 4) != 0)
+        || header->length > (uint64_t)(end - offset - (long)sizeof(WalHeader))) {
+        return -1;
+    }
+
+    *ops = malloc(header->length ? header->length : 1);
+    if (!*ops || fread(*ops, 1, header->length, fp) != header->length
+        || wal_checksum(*ops, header->length) != header->checksum) {
+        free(*ops);
+        *ops = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+static void mark_applied(FILE* fp, long offset) {
+    uint32_t state = WAL_APPLIED;
+    fseek(fp, offset + (long)offsetof(WalHeader, state), SEEK_SET);
+    fwrite(&state, sizeof(state), 1, fp);
+    fflush(fp);
+}
+
+
+/*
+ * FUNCTION: checkpoint
+ * ────────────────────
+ * Empties the log once every record in it has been applied.
+ * Before throwing records away, the files they changed are
+ * fsync'd — from now on THEY are the durable copy.
+ *
+ * Called with the WAL lock held.
+ */
+static void checkpoint(FILE* fp, int force) {
+    long end = file_end(fp);
+    if (end <= 0 || (!force && end < WAL_CHECKPOINT_BYTES)) {
+        return;
+    }
+
+    /* Pass 1: anything still pending? Then not yet. */
+    long offset = 0;
+    WalHeader header;
+    char* ops;
+    while (offset < end && read_record(fp, offset, end, &header, &ops) == 0) {
+        free(ops);
+        if (header.state != WAL_APPLIED) return;
+        offset += sizeof(WalHeader) + header.length;
+    }
+
+    /* Pass 2: make the real files durable */
+    offset = 0;
+    while (offset < end && read_record(fp, offset, end, &header, &ops) == 0) {
+        size_t pos = 0;
+        char type;
+        char path[MAX_PATH];
+        const char* data;
+        size_t data_len;
+
+        while (next_op(ops, header.length, &pos, &type, path, &data, &data_len) == 1) {
+            if (type == 'A') {
+                sync_path(path);     // 'R' and 'C' went through write_file_atomic
+            }
+        }
+        free(ops);
+        offset += sizeof(WalHeader) + header.length;
+    }
+    sync_path(MYGIT_DIR);   // renames live in the directories
+    sync_path(REFS_DIR);
+
+    truncate_file(fp, 0);
+}
+
+
+/*
+ * ═══════════════════════════════════════════════
+ * FUNCTION: wal_commit
+ * ═══════════════════════════════════════════════
+ * Makes a transaction durable, then applies it — all under
+ * the WAL lock:
+ *
+ *   1. append the record
+ *   2. fsync the log (the ONE fsync of a commit)
+ *   3. apply the ops, mark the record APPLIED
+ *
+ * A branch that no longer says what the record expects means
+ * the record is given up (marked APPLIED with nothing done),
+ * so no later recovery redoes it either.
+ *
+ * RETURNS: 0 → committed, REF_TXN_CONFLICT → a branch moved on,
+ *          nothing happened, -1 → error
+ */
+int wal_commit(WalTxn* txn) {
+    FILE* fp = open_rw(WAL_FILE);
+    if (!fp) {
+        printf(RED "✗ Could not open the write-ahead log\n" RESET);
+        return -1;
+    }
+
+    WalHeader header;
+    memcpy(header.magic, WAL_MAGIC, 4);
+    header.length = (uint32_t)txn->len;
+    header.checksum = wal_checksum(txn->data, txn->len);
+    header.state = WAL_PENDING;
+
+    /* ── 1. append ── */
+    lock_file(fp);
+    long offset = file_end(fp);
+    int ok = offset >= 0
+             && fwrite(&header, sizeof(header), 1, fp) == 1
+             && fwrite(txn->data, 1, txn->len, fp) == txn->len
+             && fflush(fp) == 0;
+
+    if (!ok) {
+        truncate_file(fp, offset);   // leave no torn record behind
+        unlock_file(fp);
+        fclose(fp);
+        printf(RED "✗ Could not write to the write-ahead log\n" RESET);
+        return -1;
+    }
+
+    /* ── 2. durable ── */
+    if (offset == 0) {
+        sync_path(MYGIT_DIR);        // log just created: its name must survive too
+    }
+    if (sync_file(fp) != 0) {
+        /* Not durable — but the record IS in the log, so recovery
+         * would redo it. Apply it now rather than surprise later. */
+        printf(YELLOW "⚠ Could not fsync the write-ahead log\n" RESET);
+    }
+
+    /* ── 3. apply ── */
+    int rc = apply_ops(txn->data, txn->len, 0, 0, &txn->append_offset);
+    if (rc == 0 || rc == REF_TXN_CONFLICT) {
+        mark_applied(fp, offset);
+        checkpoint(fp, 0);
+    }
+
+    unlock_file(fp);
+    fclose(fp);
+
+    if (rc == -1) {
+        printf(RED "✗ Commit is logged but could not be applied — the next run retries it\n" RESET);
+    }
+    return rc;
+}
+
+
+/*
+ * FUNCTION: wal_recover
+ * ─────────────────────
+ * Run once at startup. Redoes every record that was made
+ * durable but never marked APPLIED, and cuts off a torn
+ * record at the end (a crash in the middle of step 1).
+ *
+ * The common case — an empty log — costs a single stat().
+ *
+ * Besides startup, every commit and branch update calls this
+ * just before it picks an id / locks its refs (see commit.c),
+ * so it never builds on top of a half-applied crash.
+ *
+ * A record whose branch has moved on since (someone committed
+ * in between) is dropped with a warning rather than redone
+ * over the newer commit.
+ *
+ * A commit that is running right now holds the WAL lock until
+ * its record is applied, so we wait for it rather than mistake
+ * its record for a crashed one. The message goes to stderr:
+ * stdout may be porcelain or JSON for a script.
+ */
+int wal_recover(void) {
+    struct stat st;
+    if (stat(WAL_FILE, &st) != 0 || st.st_size == 0) {
+        return 0;
+    }
+
+    FILE* fp = open_rw(WAL_FILE);
+    if (!fp) {
+        return -1;
+    }
+
+    lock_file(fp);
+
+    long end = file_end(fp);
+    long offset = 0;
+    int redone = 0;
+    int dropped = 0;
+    int rc = 0;
+
+    while (offset < end) {
+        WalHeader header;
+        char* ops;
+
+        if (read_record(fp, offset, end, &header, &ops) != 0) {
+            truncate_file(fp, offset);
+            break;
+        }
+
+        if (header.state == WAL_PENDING) {
+            int legacy = memcmp(header.magic, WAL_MAGIC_V1, 4) == 0;
+            int applied = apply_ops(ops, header.length, legacy, 1, NULL);
+            if (applied == -1) {
+                free(ops);
+                rc = -1;
+                break;
+            }
+            mark_applied(fp, offset);
+            if (applied == REF_TXN_CONFLICT) dropped++;
+            else                             redone++;
+        }
+
+        free(ops);
+        offset += sizeof(WalHeader) + header.length;
+    }
+
+    if (rc == 0) {
+        checkpoint(fp, redone + dropped > 0);
+    }
+
+    unlock_file(fp);
+    fclose(fp);
+
+    if (redone > 0) {
+        fprintf(stderr, YELLOW "⚠ Recovered %d interrupted commit%s\n" RESET,
+                redone, redone == 1 ? "" : "s");
+    }
+    if (dropped > 0) {
+        fprintf(stderr, YELLOW "⚠ Dropped %d interrupted commit%s: the branch has moved on since\n" RESET,
+                dropped, dropped == 1 ? "" : "s");
+    }
+    return rc;
+}